@@ -0,0 +1,177 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 08.03.2018.
+ * Copyright
+ *
+ * Benchmark of removal from xDynamicArray: RemoveSwap,
+ * RemoveIf and RemoveRange against the old Remove,
+ * which shifted the tail by one element in the loop,
+ * for arrays of 10k and 1M elements
+ *
+ * Build (from this folder, headers of engine dependencies are needed):
+ * g++ -std=c++11 -O2 -I../Oxygen DynamicArrayBench.cpp -o DynamicArrayBench
+ */
+
+#include "xEngine.h"
+
+struct xBenchElement
+{
+    long value;
+};
+
+// ----------------------------------------------------------------------
+// Old Remove of xDynamicArray: deletes element and shifts the tail
+// ----------------------------------------------------------------------
+static void ShiftingRemove(xBenchElement ** array, long * numOfElements, long index)
+{
+    SAFE_DELETE(array[index]);
+
+    for(long i = index; i < *numOfElements - 1; i += 1)
+    {
+        array[i] = array[i + 1];
+    }
+
+    *numOfElements -= 1;
+}
+
+// ----------------------------------------------------------------------
+// Predicate of RemoveIf: every 100th element
+// ----------------------------------------------------------------------
+struct xEveryHundredth
+{
+    bool operator()(xBenchElement * element)
+    {
+        return (element->value % 100) == 0;
+    }
+};
+
+static void Fill(xDynamicArray<xBenchElement> * array, long size)
+{
+    for(long i = 0; i < size; i++) {
+        xBenchElement * element = new xBenchElement;
+        element->value = i;
+        array->Add(element);
+    }
+}
+
+static void Fill(xBenchElement ** array, long size)
+{
+    for(long i = 0; i < size; i++) {
+        array[i] = new xBenchElement;
+        array[i]->value = i;
+    }
+}
+
+static void Release(xBenchElement ** array, long numOfElements)
+{
+    for(long i = 0; i < numOfElements; i++) {
+        SAFE_DELETE(array[i]);
+    }
+}
+
+static double Milliseconds(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+    return time.count();
+}
+
+static void Run(long size)
+{
+    long numOfRemoved = size / 100;
+    xBenchElement ** raw = new xBenchElement * [size];
+    long numOfElements;
+
+    // Positions of single removals are the same for all the variants
+    xValueArray<long> positions;
+    srand(1);
+    for(long i = 0; i < numOfRemoved; i++) {
+        positions.Add(rand() % (size - i));
+    }
+
+    printf("INFO: %ld elements, %ld removals \n", size, numOfRemoved);
+
+    // Single elements in random positions
+    {
+        Fill(raw, size);
+        numOfElements = size;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(long i = 0; i < numOfRemoved; i++) {
+            ShiftingRemove(raw, &numOfElements, positions[i]);
+        }
+        double shifting = Milliseconds(start);
+        Release(raw, numOfElements);
+
+        xDynamicArray<xBenchElement> array;
+        Fill(&array, size);
+        start = std::chrono::steady_clock::now();
+        for(long i = 0; i < numOfRemoved; i++) {
+            array.Remove(positions[i]);
+        }
+        double memmoved = Milliseconds(start);
+
+        xDynamicArray<xBenchElement> swapped;
+        Fill(&swapped, size);
+        start = std::chrono::steady_clock::now();
+        for(long i = 0; i < numOfRemoved; i++) {
+            swapped.RemoveSwap(positions[i]);
+        }
+        double swap = Milliseconds(start);
+
+        printf("  random:    shifting loop %10.3lf ms, Remove %10.3lf ms, RemoveSwap %10.3lf ms \n",
+               shifting, memmoved, swap);
+    }
+
+    // Every 100th element
+    {
+        Fill(raw, size);
+        numOfElements = size;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(long i = 0; i < numOfElements; ) {
+            if (raw[i]->value % 100 == 0) {
+                ShiftingRemove(raw, &numOfElements, i);
+            } else {
+                i++;
+            }
+        }
+        double shifting = Milliseconds(start);
+        Release(raw, numOfElements);
+
+        xDynamicArray<xBenchElement> array;
+        Fill(&array, size);
+        start = std::chrono::steady_clock::now();
+        array.RemoveIf(xEveryHundredth());
+        double removeIf = Milliseconds(start);
+
+        printf("  predicate: shifting loop %10.3lf ms, RemoveIf %10.3lf ms \n", shifting, removeIf);
+    }
+
+    // Range in the middle
+    {
+        Fill(raw, size);
+        numOfElements = size;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(long i = 0; i < numOfRemoved; i++) {
+            ShiftingRemove(raw, &numOfElements, size / 2);
+        }
+        double shifting = Milliseconds(start);
+        Release(raw, numOfElements);
+
+        xDynamicArray<xBenchElement> array;
+        Fill(&array, size);
+        start = std::chrono::steady_clock::now();
+        array.RemoveRange(size / 2, numOfRemoved);
+        double range = Milliseconds(start);
+
+        printf("  range:     shifting loop %10.3lf ms, RemoveRange %10.3lf ms \n", shifting, range);
+    }
+
+    delete[] raw;
+}
+
+int main(int argc, char ** argv)
+{
+    Run(10000);
+    Run(1000000);
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 08.03.2018.
+ * Copyright
+ *
+ * Benchmark of xFrustumCuller with 100k objects:
+ * batch Cull of sphere and box bounds against
+ * the test of each object by IsSphereInFrustum of
+ * the camera (as objects were culled before).
+ * SIMD path of the culler is chosen at compile
+ * time, so the command builds one binary with SSE
+ * and one with AVX. No GL context is needed
+ *
+ * Build (from this folder, engine dependencies are needed):
+ * for simd in sse2 avx; do g++ -std=c++11 -O2 -m$simd -I../Oxygen FrustumCullerBench.cpp ../Oxygen/xFrustumCuller.cpp ../Oxygen/xProfiler.cpp -o FrustumCullerBench_$simd -lGLEW -lGLU -lGL -lglfw -lfreeimage -lpthread; done
+ *
+ * Usage: FrustumCullerBench_avx [number of objects (100000)]
+ */
+
+#include "xEngine.h"
+
+#define BENCH_FRAMES 100            // Cull calls per measurement
+
+static double Milliseconds(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+    return time.count();
+}
+
+static float Random(float min, float max)
+{
+    return min + (max - min) * (rand() / (float)RAND_MAX);
+}
+
+int main(int argc, char ** argv)
+{
+    long count = (argc > 1 ? atol(argv[1]) : 100000);
+
+#if defined(__AVX__)
+    const char * path = "AVX (8 objects per pass)";
+#elif defined(__SSE__) || defined(_M_X64)
+    const char * path = "SSE (4 objects per pass)";
+#else
+    const char * path = "scalar";
+#endif
+
+    xVirtualCamera camera(60.0, 0.5, 200.0);
+    camera.SetPosition(0.0f, 0.0f, 0.0f);
+    camera.SetYaw(20.0f);
+    camera.UpdateMatrices(1280, 720);
+
+    // Objects around the camera, part of them is in the frustum
+    xFrustumCuller culler;
+    xValueArray<xVector3> centers;
+    xValueArray<float> radiuses;
+
+    srand(1);
+    for(long i = 0; i < count; i++) {
+        xVector3 center(Random(-250.0f, 250.0f), Random(-50.0f, 50.0f), Random(-250.0f, 250.0f));
+        xVector3 extents(Random(0.1f, 8.0f), Random(0.1f, 8.0f), Random(0.1f, 8.0f));
+        float radius = sqrtf(extents.x * extents.x + extents.y * extents.y + extents.z * extents.z);
+
+        culler.Add(&center, radius, &extents);
+        centers.Add(center);
+        radiuses.Add(radius);
+    }
+
+    // Warm up (and results for the check)
+    culler.Cull(&camera);
+    long spheres = 0;
+    long lost = 0;
+    for(long i = 0; i < count; i++) {
+        bool isInside = camera.IsSphereInFrustum(&centers[i], radiuses[i]);
+        spheres += isInside;
+        lost += (culler.IsVisible(i) && !isInside);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(int frame = 0; frame < BENCH_FRAMES; frame++) {
+        culler.Cull(&camera);
+    }
+    double batch = Milliseconds(start) / BENCH_FRAMES;
+
+    long visible = 0;
+    start = std::chrono::steady_clock::now();
+    for(int frame = 0; frame < BENCH_FRAMES; frame++) {
+        visible = 0;
+        for(long i = 0; i < count; i++) {
+            visible += camera.IsSphereInFrustum(&centers[i], radiuses[i]);
+        }
+    }
+    double single = Milliseconds(start) / BENCH_FRAMES;
+
+    xFrustumCullerStats stats = culler.GetStats();
+
+    printf("INFO: %ld objects, culler path %s \n", count, path);
+    printf("  batch Cull:             %8.3lf ms per frame, %7.1lf M objects/s, visible %lu \n",
+           batch, count / (batch * 1000.0), stats.visible);
+    printf("  IsSphereInFrustum loop: %8.3lf ms per frame, %7.1lf M objects/s, visible %ld \n",
+           single, count / (single * 1000.0), visible);
+    printf("  speedup %.2lfx (box test culls %ld more objects, %ld visible by culler only) \n",
+           single / batch, spheres - (long)stats.visible, lost);
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 08.03.2018.
+ * Copyright
+ *
+ * Benchmark of OBJ import: writes synthetic files of
+ * increasing size (objects of grids with positions,
+ * texture coordinates, normals and v/t/n faces) and
+ * imports them by xModelLoader without cache, order
+ * optimization and LODs. Prints throughput (MB/s) of
+ * parsing ("Parse OBJ" and "Merge OBJ" scopes of the
+ * profiler) and of the whole import (with indexing).
+ * Then sweeps number of threads of the loader (1..N)
+ * over the largest file
+ *
+ * Build (from this folder, engine dependencies are needed):
+ * g++ -std=c++11 -O2 -I../Oxygen ObjImportBench.cpp ../Oxygen/xModelLoader.cpp ../Oxygen/xMappedFile.cpp ../Oxygen/xMeshCache.cpp ../Oxygen/xMeshProcessor.cpp ../Oxygen/xAsyncLoader.cpp ../Oxygen/xProfiler.cpp -o ObjImportBench -lGLEW -lGLU -lGL -lglfw -lfreeimage -lpthread
+ *
+ * Usage: ObjImportBench [folder for files (./)] [max size in MB (256)] [max threads (all cores)]
+ */
+
+#include "xEngine.h"
+
+#define BENCH_GRID_SIZE     64      // Quads per side of the grid of one object
+
+// ----------------------------------------------------------------------
+// Writes objects, while file is smaller than size (in bytes). Returns
+// false, if file cannot be written
+// ----------------------------------------------------------------------
+static bool WriteObj(const char * filename, unsigned long size)
+{
+    FILE * file = fopen(filename, "wb");
+    if (file == NULL) {
+        printf("ERROR: Cannot write file %s \n", filename);
+        return false;
+    }
+
+    const int side = BENCH_GRID_SIZE + 1;
+    unsigned long written = 0;
+    long numOfObjects = 0;
+
+    while (written < size)
+    {
+        written += fprintf(file, "o grid_%ld\n", numOfObjects);
+
+        float offset = numOfObjects * (float)BENCH_GRID_SIZE;
+        for(int i = 0; i < side; i++) {
+            for(int j = 0; j < side; j++) {
+                float height = 0.25f * sinf(i * 0.37f + numOfObjects) * cosf(j * 0.21f);
+                written += fprintf(file, "v %.6f %.6f %.6f\n", offset + i * 1.0f, height, j * 1.0f);
+                written += fprintf(file, "vt %.6f %.6f\n", i / (float)BENCH_GRID_SIZE, j / (float)BENCH_GRID_SIZE);
+                written += fprintf(file, "vn %.6f %.6f %.6f\n", -height * 0.3f, 0.95f, height * 0.2f);
+            }
+        }
+
+        // Indices are relative to the start of the file
+        long base = numOfObjects * side * side + 1;
+        for(int i = 0; i < BENCH_GRID_SIZE; i++) {
+            for(int j = 0; j < BENCH_GRID_SIZE; j++) {
+                long a = base + i * side + j;
+                long b = a + 1;
+                long c = a + side;
+                long d = c + 1;
+                written += fprintf(file, "f %ld/%ld/%ld %ld/%ld/%ld %ld/%ld/%ld\n", a, a, a, c, c, c, b, b, b);
+                written += fprintf(file, "f %ld/%ld/%ld %ld/%ld/%ld %ld/%ld/%ld\n", b, b, b, c, c, c, d, d, d);
+            }
+        }
+
+        numOfObjects += 1;
+    }
+
+    fclose(file);
+    return true;
+}
+
+// ----------------------------------------------------------------------
+// Imports file by loader. Returns time (in seconds) of parsing and of
+// the whole import
+// ----------------------------------------------------------------------
+static void Import(xModelLoader * loader, char * filename, double * parse, double * total)
+{
+    xModel3d * model = new xModel3d();
+
+    g_profiler->BeginFrame();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    loader->ImportObj(model, filename);
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+    g_profiler->EndFrame();
+
+    xProfileStats parseStats, mergeStats;
+    *parse = 0.0;
+    if (g_profiler->GetStats("Parse OBJ", &parseStats)) {
+        *parse += parseStats.last / 1000.0;
+    }
+    if (g_profiler->GetStats("Merge OBJ", &mergeStats)) {
+        *parse += mergeStats.last / 1000.0;
+    }
+    *total = time.count();
+
+    SAFE_DELETE(model);
+}
+
+int main(int argc, char ** argv)
+{
+    const char * folder = (argc > 1 ? argv[1] : "./");
+    unsigned long maxSize = (argc > 2 ? strtoul(argv[2], NULL, 10) : 256);
+    unsigned long maxThreads = (argc > 3 ? strtoul(argv[3], NULL, 10) : std::thread::hardware_concurrency());
+    if (maxThreads == 0) {
+        maxThreads = 1;
+    }
+
+    g_profiler = new xProfiler(true);
+
+    xModelLoader loader;
+    loader.SetCacheEnabled(false);
+    loader.SetOptimizeEnabled(false);
+    loader.SetLodEnabled(false);
+
+    char filename[STRING_SIZE];
+    unsigned long largest = 0;
+
+    printf("INFO: Throughput by size of file (all cores) \n");
+
+    for(unsigned long size = 1; size <= maxSize; size *= 4)
+    {
+        sprintf(filename, "%sbench_%lumb.obj", folder, size);
+        if (!WriteObj(filename, size * 1024 * 1024)) {
+            return 1;
+        }
+
+        xMappedFile file;
+        file.Open(filename);
+        double megabytes = file.GetSize() / (1024.0 * 1024.0);
+        file.Close();
+
+        // The first import reads file in the page cache
+        double parse, total;
+        loader.SetNumOfThreads(0);
+        Import(&loader, filename, &parse, &total);
+        Import(&loader, filename, &parse, &total);
+
+        printf("RESULT: %8.2lf MB: parse %8.1lf MB/s, import %8.1lf MB/s \n",
+               megabytes, megabytes / parse, megabytes / total);
+
+        if (size * 4 <= maxSize) {
+            remove(filename);
+        } else {
+            largest = size;
+        }
+    }
+
+    // Chunks are not smaller than OBJ_MIN_CHUNK_SIZE, so small files do not
+    // use all the threads
+    if (largest != 0)
+    {
+        sprintf(filename, "%sbench_%lumb.obj", folder, largest);
+
+        xMappedFile file;
+        file.Open(filename);
+        double megabytes = file.GetSize() / (1024.0 * 1024.0);
+        file.Close();
+
+        printf("INFO: Throughput by number of threads (%.2lf MB) \n", megabytes);
+
+        for(unsigned long threads = 1; threads <= maxThreads; threads++)
+        {
+            double parse, total;
+            loader.SetNumOfThreads((unsigned int)threads);
+            Import(&loader, filename, &parse, &total);
+
+            printf("RESULT: %3lu threads: parse %8.1lf MB/s, import %8.1lf MB/s \n",
+                   threads, megabytes / parse, megabytes / total);
+        }
+
+        remove(filename);
+    }
+
+    SAFE_DELETE(g_profiler);
+    return 0;
+}
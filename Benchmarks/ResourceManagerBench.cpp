@@ -0,0 +1,160 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 08.03.2018.
+ * Copyright
+ *
+ * Benchmark of xResourceManager with 10k resources:
+ * adds, repeated adds (hits), lookups and removals
+ * through the hash index against the old manager,
+ * which walked the list with strcmp for each lookup.
+ * Resources are stubs without data (no files, no GL)
+ *
+ * Build (from this folder, headers of engine dependencies are needed):
+ * g++ -std=c++11 -O2 -I../Oxygen ResourceManagerBench.cpp ../Oxygen/xAsyncLoader.cpp ../Oxygen/xProfiler.cpp -o ResourceManagerBench -lpthread
+ */
+
+#include "xEngine.h"
+
+#define BENCH_RESOURCES 10000
+
+// ----------------------------------------------------------------------
+// Resource without data
+// ----------------------------------------------------------------------
+
+class xBenchResource : public xResource
+{
+public:
+
+    xBenchResource(char * name, char * path) : xResource(name, path)
+    {
+    }
+
+};
+
+// ----------------------------------------------------------------------
+// Old manager: list of resources, lookup compares names and paths of
+// all the resources
+// ----------------------------------------------------------------------
+
+class xLinearManager
+{
+public:
+
+    xBenchResource * Add(char * name, char * path)
+    {
+        xBenchResource * element = GetElement(name, path);
+        if (element != NULL) {
+            element->IncRef();
+            return element;
+        }
+
+        xBenchResource * resource = new xBenchResource(name, path);
+        m_list.Add(resource);
+        return resource;
+    }
+
+    void Remove(xBenchResource * resource)
+    {
+        if (resource->DecRef() == 0) {
+            m_list.Remove(resource);
+        }
+    }
+
+    xBenchResource * GetElement(char * name, char * path)
+    {
+        for(xBenchResource * resource : m_list) {
+            if (strcmp(resource->GetName(), name) == 0 && strcmp(resource->GetPath(), path) == 0) {
+                return resource;
+            }
+        }
+        return NULL;
+    }
+
+private:
+
+    xLinkedList<xBenchResource> m_list;
+
+};
+
+static double Milliseconds(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+    return time.count();
+}
+
+// ----------------------------------------------------------------------
+// Runs all the phases with manager and prints time of each phase
+// ----------------------------------------------------------------------
+template <class Manager> void Run(const char * title, Manager * manager, char (* names)[STRING_SIZE],
+                                  long * order)
+{
+    char path[] = "Textures/";
+    xBenchResource ** resources = new xBenchResource * [BENCH_RESOURCES];
+    double time[4];
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(long i = 0; i < BENCH_RESOURCES; i++) {
+        resources[i] = manager->Add(names[i], path);
+    }
+    time[0] = Milliseconds(start);
+
+    // Second reference to each resource
+    start = std::chrono::steady_clock::now();
+    for(long i = 0; i < BENCH_RESOURCES; i++) {
+        manager->Add(names[order[i]], path);
+    }
+    time[1] = Milliseconds(start);
+
+    long found = 0;
+    start = std::chrono::steady_clock::now();
+    for(long i = 0; i < BENCH_RESOURCES; i++) {
+        found += (manager->GetElement(names[order[i]], path) != NULL);
+    }
+    time[2] = Milliseconds(start);
+
+    // Both references are released in random order
+    start = std::chrono::steady_clock::now();
+    for(long i = 0; i < BENCH_RESOURCES; i++) {
+        manager->Remove(resources[order[i]]);
+        manager->Remove(resources[order[i]]);
+    }
+    time[3] = Milliseconds(start);
+
+    printf("  %-14s add %9.3lf ms, add again %9.3lf ms, lookup %9.3lf ms, remove %9.3lf ms, total %9.3lf ms (found %ld) \n",
+           title, time[0], time[1], time[2], time[3], time[0] + time[1] + time[2] + time[3], found);
+
+    delete[] resources;
+}
+
+int main(int argc, char ** argv)
+{
+    char (* names)[STRING_SIZE] = new char[BENCH_RESOURCES][STRING_SIZE];
+    long * order = new long[BENCH_RESOURCES];
+
+    // Names with the same prefix, as textures of models usually have
+    for(long i = 0; i < BENCH_RESOURCES; i++) {
+        sprintf(names[i], "model_diffuse_%05ld.bmp", i);
+        order[i] = i;
+    }
+
+    srand(1);
+    for(long i = BENCH_RESOURCES - 1; i > 0; i--) {
+        long j = rand() % (i + 1);
+        long temp = order[i];
+        order[i] = order[j];
+        order[j] = temp;
+    }
+
+    printf("INFO: %d resources \n", BENCH_RESOURCES);
+
+    xLinearManager linear;
+    Run("linear list:", &linear, names, order);
+
+    xResourceManager<xBenchResource> manager;
+    Run("hash index:", &manager, names, order);
+
+    delete[] names;
+    delete[] order;
+
+    return 0;
+}
@@ -0,0 +1,202 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 19.02.2018.
+ * Copyright
+ *
+ * Realisation of functions defined in the file
+ * xAsyncLoader.h. Go there to find more information
+ * and interface specifications
+ */
+
+#include "xEngine.h"
+
+xAsyncLoader::xAsyncLoader(unsigned int num_threads)
+{
+    if (num_threads == 0) {
+        num_threads = std::thread::hardware_concurrency();
+        num_threads = (num_threads > 1 ? num_threads - 1 : 1);
+    }
+
+    m_isDone = false;
+    m_numOfPending = 0;
+    m_numOfThreads = num_threads;
+
+    m_requests = new xLinkedList<xLoadRequest>;
+    m_decoded = new xLinkedList<xLoadRequest>;
+
+    m_current = new xLoadRequest * [m_numOfThreads];
+    m_threads = new std::thread * [m_numOfThreads];
+
+    for(unsigned int i = 0; i < m_numOfThreads; i++) {
+        m_current[i] = NULL;
+        m_threads[i] = new std::thread(&xAsyncLoader::WorkerMain, this, i);
+    }
+}
+
+xAsyncLoader::~xAsyncLoader()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_isDone = true;
+    }
+    m_requestAdded.notify_all();
+
+    for(unsigned int i = 0; i < m_numOfThreads; i++) {
+        m_threads[i]->join();
+        SAFE_DELETE(m_threads[i]);
+    }
+
+    SAFE_DELETE_ARRAY(m_threads);
+    SAFE_DELETE_ARRAY(m_current);
+    SAFE_DELETE(m_requests);
+    SAFE_DELETE(m_decoded);
+}
+
+void xAsyncLoader::Submit(xResource * resource, void * owner, void (* Loaded)(void * owner, xResource * resource))
+{
+    if (resource == NULL) {
+        return;
+    }
+
+    xLoadRequest * request = new xLoadRequest;
+    request->resource = resource;
+    request->owner = owner;
+    request->Loaded = Loaded;
+    request->decoded = false;
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_requests->Add(request);
+        m_numOfPending += 1;
+    }
+    m_requestAdded.notify_one();
+}
+
+void xAsyncLoader::Drain(double budget_ms)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    while (true)
+    {
+        xLoadRequest * request = NULL;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            request = m_decoded->GetFirst();
+            if (request == NULL) {
+                return;
+            }
+            m_decoded->ClearPointer(request);
+            m_numOfPending -= 1;
+        }
+
+        xResource * resource = request->resource;
+
+        if (request->decoded && resource->Upload()) {
+            resource->SetState(RESOURCE_STATE_READY);
+        } else {
+            printf("ERROR: Cannot load resource %s \n", resource->GetFilename());
+            resource->SetState(RESOURCE_STATE_FAILED);
+        }
+
+        // Owner counts size of the resource and deletes it, if nobody
+        // uses resource after loading (it was removed while loading)
+        if (request->Loaded != NULL) {
+            request->Loaded(request->owner, resource);
+        }
+
+        SAFE_DELETE(request);
+
+        // Always uploads one resource at least, therefore loading goes on
+        // even if budget is less than upload time of one resource
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() >= budget_ms) {
+            return;
+        }
+    }
+}
+
+void xAsyncLoader::Cancel(void * owner)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    RemoveOwnerRequests(m_requests, owner);
+
+    // Waits for workers, which decode resources of this owner
+    bool isBusy = true;
+    while (isBusy)
+    {
+        isBusy = false;
+        for(unsigned int i = 0; i < m_numOfThreads; i++) {
+            if (m_current[i] != NULL && m_current[i]->owner == owner) {
+                isBusy = true;
+            }
+        }
+
+        if (isBusy) {
+            m_requestDecoded.wait(lock);
+        }
+    }
+
+    RemoveOwnerRequests(m_decoded, owner);
+}
+
+unsigned long xAsyncLoader::GetNumOfPending()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_numOfPending;
+}
+
+void xAsyncLoader::WorkerMain(unsigned int index)
+{
+    if (g_profiler != NULL) {
+        char name[STRING_SIZE];
+        sprintf(name, "Loader %u", index);
+        g_profiler->SetThreadName(name);
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        while (!m_isDone && m_requests->GetFirst() == NULL) {
+            m_requestAdded.wait(lock);
+        }
+
+        if (m_isDone) {
+            return;
+        }
+
+        xLoadRequest * request = m_requests->GetFirst();
+        m_requests->ClearPointer(request);
+        m_current[index] = request;
+
+        // Decoding is done without lock (it is the longest part of loading)
+        lock.unlock();
+        {
+            X_PROFILE_SCOPE("Decode");
+            request->decoded = request->resource->Decode();
+        }
+        lock.lock();
+
+        m_current[index] = NULL;
+        m_decoded->Add(request);
+        m_requestDecoded.notify_all();
+    }
+}
+
+void xAsyncLoader::RemoveOwnerRequests(xLinkedList<xLoadRequest> * list, void * owner)
+{
+    xLinkedList<xLoadRequest>::Iterator i = list->Begin();
+
+    while (i != list->End())
+    {
+        xLoadRequest * request = *i;
+        ++i;
+
+        if (request->owner == owner) {
+            list->Remove(request);
+            m_numOfPending -= 1;
+        }
+    }
+}
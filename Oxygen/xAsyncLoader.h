@@ -0,0 +1,105 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 19.02.2018.
+ * Copyright
+ *
+ * xAsyncLoader releases pipeline for the
+ * background loading of resources. Decoding
+ * of the files (xResource::Decode) is done
+ * by the pool of worker threads, and then the
+ * decoded resources are returned to the main
+ * thread, where uploading of data to OpenGL
+ * or OpenAL (xResource::Upload) is done by
+ * Drain function in the limits of time budget
+ * for each frame
+ */
+
+#ifndef OXYGEN_XASYNCLOADER_H
+#define OXYGEN_XASYNCLOADER_H
+
+class xResource;
+
+// ----------------------------------------------------------------------
+// Request for loading of one resource
+// ----------------------------------------------------------------------
+
+struct xLoadRequest
+{
+    xResource * resource;                                   // Resource to decode and upload
+    void * owner;                                           // Manager of the resource
+    void (* Loaded)(void * owner, xResource * resource);    // Tells the owner, that loading is finished
+    bool decoded;                                           // Result of decoding on worker thread
+};
+
+// ----------------------------------------------------------------------
+// Asynchronous Loader Class
+// ----------------------------------------------------------------------
+
+class xAsyncLoader
+{
+public:
+
+    // ----------------------------------------------------------------------
+    // Creates loader with num_threads worker threads
+    // (0 - number of hardware threads minus one for the main thread)
+    // ----------------------------------------------------------------------
+    xAsyncLoader(unsigned int num_threads = 0);
+
+    // ----------------------------------------------------------------------
+    // Stops worker threads and deletes not processed requests
+    // ----------------------------------------------------------------------
+    ~xAsyncLoader();
+
+    // ----------------------------------------------------------------------
+    // Puts resource in the queue for decoding. Loaded function is
+    // called by Drain after uploading (or failure) of the resource
+    // ----------------------------------------------------------------------
+    void Submit(xResource * resource, void * owner, void (* Loaded)(void * owner, xResource * resource));
+
+    // ----------------------------------------------------------------------
+    // Uploads decoded resources on the main thread until budget
+    // (in milliseconds) is spent. Should be called for each frame
+    // ----------------------------------------------------------------------
+    void Drain(double budget_ms);
+
+    // ----------------------------------------------------------------------
+    // Forgets all the requests of the owner (waits for requests,
+    // which are decoded in this moment). Should be called by manager
+    // before deleting of its resources
+    // ----------------------------------------------------------------------
+    void Cancel(void * owner);
+
+    // ----------------------------------------------------------------------
+    // Returns number of requests, which are not uploaded yet
+    // ----------------------------------------------------------------------
+    unsigned long GetNumOfPending();
+
+private:
+
+    // ----------------------------------------------------------------------
+    // Main function of worker thread
+    // ----------------------------------------------------------------------
+    void WorkerMain(unsigned int index);
+
+    // ----------------------------------------------------------------------
+    // Removes all the requests of owner from list
+    // ----------------------------------------------------------------------
+    void RemoveOwnerRequests(xLinkedList<xLoadRequest> * list, void * owner);
+
+    bool m_isDone;                                  // Worker threads should leave
+    unsigned int m_numOfThreads;                    // Number of worker threads
+    std::thread ** m_threads;                       // Worker threads
+    xLoadRequest ** m_current;                      // Requests, which are decoded by workers in this moment
+
+    std::mutex m_mutex;                             // Guards queues and current requests
+    std::condition_variable m_requestAdded;         // Wakes up workers
+    std::condition_variable m_requestDecoded;       // Wakes up Cancel function
+
+    xLinkedList<xLoadRequest> * m_requests;         // Requests to decode
+    xLinkedList<xLoadRequest> * m_decoded;          // Decoded requests to upload
+    unsigned long m_numOfPending;                   // Requests in queues and on workers
+
+};
+
+
+#endif //OXYGEN_XASYNCLOADER_H
@@ -244,6 +244,172 @@ public:
     long normal[3];
 };
 
+// ----------------------------------------------------------------------
+// Interleaved vertex of indexed object (unique (v, vt, vn) triple)
+// ----------------------------------------------------------------------
+struct xVertex
+{
+public:
+    float position[3];
+    float normal[3];
+    float texcoord[2];
+};
+
+// ----------------------------------------------------------------------
+// Compressed vertex of indexed object (14 bytes instead of 32): position
+// is 16 bit fraction of the bounds of the object, normal is octahedral
+// (two 16 bit components), texture coordinates are half floats. It saves
+// CPU memory only: buffer objects keep decoded xVertex (32 bytes) for the
+// fixed pipeline
+// ----------------------------------------------------------------------
+struct xPackedVertex
+{
+public:
+    unsigned short position[3];
+    short normal[2];
+    unsigned short texcoord[2];
+
+    // ----------------------------------------------------------------------
+    // Compresses vertex (min - corner of bounds, scale - size of bounds
+    // divided by 65535 for each axis)
+    // ----------------------------------------------------------------------
+    void Pack(const xVertex & vertex, const float * min, const float * scale)
+    {
+        for(int i = 0; i < 3; i++) {
+            float value = (scale[i] > 0.0f ? (vertex.position[i] - min[i]) / scale[i] : 0.0f);
+            value = (value < 0.0f ? 0.0f : (value > 65535.0f ? 65535.0f : value));
+            position[i] = (unsigned short)(value + 0.5f);
+        }
+
+        // Normal is projected on octahedron, lower half is folded over
+        const float * n = vertex.normal;
+        float length = fabsf(n[0]) + fabsf(n[1]) + fabsf(n[2]);
+        float x = (length > 0.0f ? n[0] / length : 0.0f);
+        float y = (length > 0.0f ? n[1] / length : 0.0f);
+
+        if (n[2] < 0.0f) {
+            float fx = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            float fy = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = fx;
+            y = fy;
+        }
+
+        normal[0] = (short)floorf(x * 32767.0f + 0.5f);
+        normal[1] = (short)floorf(y * 32767.0f + 0.5f);
+
+        texcoord[0] = FloatToHalf(vertex.texcoord[0]);
+        texcoord[1] = FloatToHalf(vertex.texcoord[1]);
+    }
+
+    // ----------------------------------------------------------------------
+    // Decompresses vertex (with the same bounds as for Pack)
+    // ----------------------------------------------------------------------
+    void Unpack(const float * min, const float * scale, xVertex * vertex) const
+    {
+        for(int i = 0; i < 3; i++) {
+            vertex->position[i] = min[i] + position[i] * scale[i];
+        }
+
+        float x = normal[0] / 32767.0f;
+        float y = normal[1] / 32767.0f;
+        float z = 1.0f - fabsf(x) - fabsf(y);
+
+        if (z < 0.0f) {
+            float fx = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            float fy = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = fx;
+            y = fy;
+        }
+
+        float length = sqrtf(x * x + y * y + z * z);
+        vertex->normal[0] = x / length;
+        vertex->normal[1] = y / length;
+        vertex->normal[2] = z / length;
+
+        vertex->texcoord[0] = HalfToFloat(texcoord[0]);
+        vertex->texcoord[1] = HalfToFloat(texcoord[1]);
+    }
+
+    // ----------------------------------------------------------------------
+    // Converts float to half float (rounding to nearest even, values out
+    // of the range are clamped)
+    // ----------------------------------------------------------------------
+    static unsigned short FloatToHalf(float value)
+    {
+        unsigned int bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        unsigned int sign = (bits >> 16) & 0x8000;
+        unsigned int mantissa = bits & 0x7fffff;
+        int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+
+        // Infinity and NaN
+        if (((bits >> 23) & 0xff) == 0xff) {
+            return (unsigned short)(sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0));
+        }
+
+        if (exponent >= 31) {
+            return (unsigned short)(sign | 0x7bff);
+        }
+
+        // Subnormal half (or zero)
+        if (exponent <= 0) {
+            if (exponent < -10) {
+                return (unsigned short)sign;
+            }
+
+            mantissa |= 0x800000;
+            unsigned int shift = (unsigned int)(14 - exponent);
+            unsigned int half = mantissa >> shift;
+            unsigned int rest = mantissa & ((1u << shift) - 1);
+            unsigned int middle = 1u << (shift - 1);
+
+            if (rest > middle || (rest == middle && (half & 1))) {
+                half += 1;
+            }
+            return (unsigned short)(sign | half);
+        }
+
+        unsigned int half = ((unsigned int)exponent << 10) | (mantissa >> 13);
+        unsigned int rest = mantissa & 0x1fff;
+
+        if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) {
+            half += 1;
+        }
+        if (half >= 0x7c00) {
+            half = 0x7bff;
+        }
+
+        return (unsigned short)(sign | half);
+    }
+
+    // ----------------------------------------------------------------------
+    // Converts half float to float
+    // ----------------------------------------------------------------------
+    static float HalfToFloat(unsigned short half)
+    {
+        unsigned int sign = (unsigned int)(half & 0x8000) << 16;
+        unsigned int exponent = (half >> 10) & 0x1f;
+        unsigned int mantissa = half & 0x3ff;
+        unsigned int bits;
+
+        if (exponent == 0) {
+            float value = mantissa * 5.9604644775390625e-8f;
+            return (sign != 0 ? -value : value);
+        }
+
+        if (exponent == 31) {
+            bits = sign | 0x7f800000 | (mantissa << 13);
+        } else {
+            bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+        }
+
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+};
+
 // ----------------------------------------------------------------------
 // Comfortable converting properties structures
 // ----------------------------------------------------------------------
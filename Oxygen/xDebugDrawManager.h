@@ -141,9 +141,7 @@ public:
     // ----------------------------------------------------------------------
     void Update()
     {
-        m_lines->Iterate(true);
-        while(m_lines->Iterate()) {
-            xLine * line = m_lines->GetCurrent();
+        for(xLine * line : *m_lines) {
             m_font->Print(line->m_x, line->m_y, line->m_text);
         }
     }
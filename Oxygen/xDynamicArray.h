@@ -90,13 +90,81 @@ public:
         {
             SAFE_DELETE(m_array[index]);
 
-            for(long i = index; i < m_numOfElements - 1; i += 1)
-            {
-                m_array[i] = m_array[i + 1];
-            }
+            memmove(&m_array[index], &m_array[index + 1], sizeof(Type *) * (m_numOfElements - index - 1));
+
+            m_numOfElements -= 1;
+        }
+    }
+
+    // ----------------------------------------------------------------------
+    // Deletes the element with that index from the array (if it exist) and
+    // puts the last element on its place (O(1), order is not saved)
+    // ----------------------------------------------------------------------
+    void RemoveSwap(long index)
+    {
+        if (index >= m_numOfElements || index < 0)
+        {
+            return;
+        }
+        else
+        {
+            SAFE_DELETE(m_array[index]);
 
             m_numOfElements -= 1;
+            m_array[index] = m_array[m_numOfElements];
+            m_array[m_numOfElements] = NULL;
+        }
+    }
+
+    // ----------------------------------------------------------------------
+    // Deletes count elements starting from index (elements out of the array
+    // are ignored) and moves the rest elements to the left by one pass
+    // ----------------------------------------------------------------------
+    void RemoveRange(long index, long count)
+    {
+        if (index < 0) {
+            count += index;
+            index = 0;
+        }
+        if (index + count > m_numOfElements) {
+            count = m_numOfElements - index;
         }
+        if (count <= 0) {
+            return;
+        }
+
+        for(long i = index; i < index + count; i += 1) {
+            SAFE_DELETE(m_array[i]);
+        }
+
+        memmove(&m_array[index], &m_array[index + count], sizeof(Type *) * (m_numOfElements - index - count));
+
+        m_numOfElements -= count;
+    }
+
+    // ----------------------------------------------------------------------
+    // Deletes all the elements, for which predicate(element) returns true,
+    // saves order of the rest elements (one pass). Returns number of
+    // deleted elements
+    // ----------------------------------------------------------------------
+    template <class Predicate> long RemoveIf(Predicate predicate)
+    {
+        long count = 0;
+
+        for(long i = 0; i < m_numOfElements; i += 1)
+        {
+            if (predicate(m_array[i])) {
+                SAFE_DELETE(m_array[i]);
+            } else {
+                m_array[count] = m_array[i];
+                count += 1;
+            }
+        }
+
+        long removed = m_numOfElements - count;
+        m_numOfElements = count;
+
+        return removed;
     }
 
     // ----------------------------------------------------------------------
@@ -105,12 +173,10 @@ public:
     // ----------------------------------------------------------------------
     void EmptyMass()
     {
-        if (m_numOfElements > 0) {
-            for(long i = 0; i < m_numOfElements; i += 1) {
-                SAFE_DELETE(m_array[i]);
-            }
-            SAFE_DELETE_ARRAY(m_array);
+        for(long i = 0; i < m_numOfElements; i += 1) {
+            SAFE_DELETE(m_array[i]);
         }
+        free(m_array);
 
         m_size = 0;
         m_numOfElements = 0;
@@ -122,13 +188,11 @@ public:
     // ----------------------------------------------------------------------
     void Clear()
     {
-        if (m_numOfElements > 0) {
-            SAFE_DELETE(m_array);
+        free(m_array);
 
-            m_size = 0;
-            m_numOfElements = 0;
-            m_array = NULL;
-        }
+        m_size = 0;
+        m_numOfElements = 0;
+        m_array = NULL;
     }
 
     // ----------------------------------------------------------------------
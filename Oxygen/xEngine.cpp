@@ -34,47 +34,73 @@ xEngine::xEngine(xEngineSetup * setup)
     m_camera = setup->camera;
     m_loaded = true;
     m_active = true;
+    m_headless = setup->headless;
+    m_window = NULL;
 
-    // OpenGL, GLFW initialization
-    int isInitialized = glfwInit();
-    if (!isInitialized) {
-        printf("ERROR: cannot initialize GLFW \n");
-        glfwTerminate();
-        exit(1);
-    }
+    // Profiler is created first, therefore all the systems can be measured
+    m_profiler = new xProfiler(setup->profiling);
+    m_profiler->SetThreadName("Main");
+    g_profiler = m_profiler;
+
+    if (!m_headless)
+    {
+        // OpenGL, GLFW initialization
+        int isInitialized = glfwInit();
+        if (!isInitialized) {
+            printf("ERROR: cannot initialize GLFW \n");
+            glfwTerminate();
+            exit(1);
+        }
+
+        // Create window, save its descriptor and make context current
+        if (m_setup->full_screen) {
+            printf("%i \n", m_setup->full_screen);
+            m_window = glfwCreateWindow(setup->size_x, setup->size_y, setup->name, glfwGetPrimaryMonitor(), NULL);
+        }else {
+            m_window = glfwCreateWindow(setup->size_x, setup->size_y, setup->name, NULL, NULL);
+        }
+        glfwMakeContextCurrent(m_window);
 
-    // Create window, save its descriptor and make context current
-    if (m_setup->full_screen) {
-        printf("%i \n", m_setup->full_screen);
-        m_window = glfwCreateWindow(setup->size_x, setup->size_y, setup->name, glfwGetPrimaryMonitor(), NULL);
-    }else {
-        m_window = glfwCreateWindow(setup->size_x, setup->size_y, setup->name, NULL, NULL);
+        // Without GLEW extensions are not used (models are drawn from client memory)
+        if (glewInit() != GLEW_OK) {
+            printf("WARNING: Cannot initialize GLEW \n");
+        }
+
+        // Print info about renderer and OpenGL
+        const GLubyte * renderer = glGetString(GL_RENDERER);
+        const GLubyte * vendor = glGetString(GL_VENDOR);
+        const GLubyte * version = glGetString(GL_VERSION);
+        const GLubyte * glslVersion = glGetString(GL_SHADING_LANGUAGE_VERSION);
+
+        printf("GL Vendor    : %s\n", vendor);
+        printf("GL Renderer  : %s\n", renderer);
+        printf("GL Version   : %s\n", version);
+        printf("GLSL Version : %s\n", glslVersion);
+        printf("\n");
+    }
+    else
+    {
+        printf("INFO: Headless mode (null render and audio backends) \n");
+        printf("\n");
     }
-    glfwMakeContextCurrent(m_window);
-
-    // Print info about renderer and OpenGL
-    const GLubyte * renderer = glGetString(GL_RENDERER);
-    const GLubyte * vendor = glGetString(GL_VENDOR);
-    const GLubyte * version = glGetString(GL_VERSION);
-    const GLubyte * glslVersion = glGetString(GL_SHADING_LANGUAGE_VERSION);
-
-    printf("GL Vendor    : %s\n", vendor);
-    printf("GL Renderer  : %s\n", renderer);
-    printf("GL Version   : %s\n", version);
-    printf("GLSL Version : %s\n", glslVersion);
-    printf("\n");
 
     srand(time(NULL));
 
-    m_soundSystem = new xSoundSystem;                       printf("INFO: Initialized Sound System \n");
+    m_asyncLoader = new xAsyncLoader(setup->loader_threads); printf("INFO: Initialized Async Loader \n");
+    m_soundSystem = new xSoundSystem(m_headless);           printf("INFO: Initialized Sound System \n");
     m_renderSystem = new xRenderSystem(m_window, m_camera); printf("INFO: Initialized Render System \n");
     m_scriptManager = new xResourceManager<xScript>;        printf("INFO: Initialized Script Manager \n");
     m_stateManager = new xStateManager;                     printf("INFO: Initialized State Manager \n");
     m_input = new xInput(m_window);                         printf("INFO: Initialized Input Manager \n");
-    m_debugDraw = new xDebugDrawManager(setup->debug_font); printf("INFO: Initialized Debug Draw Manager \n");
+    m_debugDraw = NULL;
+    if (!m_headless) {
+        m_debugDraw = new xDebugDrawManager(setup->debug_font); printf("INFO: Initialized Debug Draw Manager \n");
+    }
     FreeImage_Initialise();                                 printf("INFO: Initialized FreeImage loading System \n");
     m_camera->Load();
-    m_camera->Init();
+    if (!m_headless) {
+        m_camera->Init();
+    }
     g_engine = this;
 
     if (setup->StateSetup != NULL) {
@@ -108,8 +134,17 @@ xEngine::~xEngine()
         SAFE_DELETE(m_debugDraw);
         printf("INFO: Debug Draw Manager has been deleted \n");
 
-        glfwTerminate();
-        printf("INFO: GLFW has been de-initialized \n");
+        SAFE_DELETE(m_asyncLoader);
+        printf("INFO: Async Loader has been deleted \n");
+
+        g_profiler = NULL;
+        SAFE_DELETE(m_profiler);
+        printf("INFO: Frame Profiler has been deleted \n");
+
+        if (!m_headless) {
+            glfwTerminate();
+            printf("INFO: GLFW has been de-initialized \n");
+        }
 
         FreeImage_DeInitialise();
         printf("INFO: FreeImage loading System has been de-initialized \n");
@@ -129,10 +164,11 @@ void xEngine::RunMainLoop()
 {
     m_isDone = false;
 
-    double startTime = glfwGetTime();
-    double lastTime = glfwGetTime();
+    double startTime = GetTime();
+    double lastTime = GetTime();
     double currentTime = 0.0;
     double ellapsedTime = 0.0;
+    unsigned long frames = 0;
 
     // ----------------------------------------------------------------------
     // Order of Main loop operations
@@ -162,33 +198,31 @@ void xEngine::RunMainLoop()
     char tmp[STRING_SIZE];
     char counter_to_update = 0;
 
-    double input_t;
-    double redering_t;
-    double state_t;
-    double glfw_t;
-
-    sprintf(tmp, "Core Info:");
-    m_debugDraw->ConvertCharToWChar(engine_info, tmp);
-    sprintf(tmp, "Camera Info:");
-    m_debugDraw->ConvertCharToWChar(cam_info, tmp);
-
-    frame_rate[0] = '\0';
-    input_time[0] = '\0';
-    rendering_time[0] = '\0';
-    state_time[0] = '\0';
-    glfw_time[0] = '\0';
-    cam_position[0] = '\0';
-    cam_direction[0] = '\0';
-
-    m_debugDraw->AddLine(engine_info);
-    m_debugDraw->AddLine(frame_rate, true);
-    m_debugDraw->AddLine(input_time, true);
-    m_debugDraw->AddLine(rendering_time, true);
-    m_debugDraw->AddLine(state_time, true);
-    m_debugDraw->AddLine(glfw_time, true);
-    m_debugDraw->AddLine(cam_info);
-    m_debugDraw->AddLine(cam_position, true);
-    m_debugDraw->AddLine(cam_direction, true);
+    if (m_debugDraw != NULL)
+    {
+        sprintf(tmp, "Core Info:");
+        m_debugDraw->ConvertCharToWChar(engine_info, tmp);
+        sprintf(tmp, "Camera Info:");
+        m_debugDraw->ConvertCharToWChar(cam_info, tmp);
+
+        frame_rate[0] = '\0';
+        input_time[0] = '\0';
+        rendering_time[0] = '\0';
+        state_time[0] = '\0';
+        glfw_time[0] = '\0';
+        cam_position[0] = '\0';
+        cam_direction[0] = '\0';
+
+        m_debugDraw->AddLine(engine_info);
+        m_debugDraw->AddLine(frame_rate, true);
+        m_debugDraw->AddLine(input_time, true);
+        m_debugDraw->AddLine(rendering_time, true);
+        m_debugDraw->AddLine(state_time, true);
+        m_debugDraw->AddLine(glfw_time, true);
+        m_debugDraw->AddLine(cam_info);
+        m_debugDraw->AddLine(cam_position, true);
+        m_debugDraw->AddLine(cam_direction, true);
+    }
 
     while (!m_isDone)
     {
@@ -197,26 +231,30 @@ void xEngine::RunMainLoop()
             /* Some code */
 
             // Get elapsed time for our cycle
-            currentTime = glfwGetTime();
+            currentTime = GetTime();
             ellapsedTime = (currentTime - lastTime);
             lastTime = currentTime;
             // Elapsed - time, which is used to count previous loop cycle
 
-            if (counter_to_update > 5) {
-                sprintf(tmp, "FPS: %lf", 1.0 / ellapsedTime);
-                m_debugDraw->ConvertCharToWChar(frame_rate, tmp);
-
-                sprintf(tmp, "Input processing: %lf %%", (input_t) / ellapsedTime * 100.0);
-                m_debugDraw->ConvertCharToWChar(input_time, tmp);
+            // Deterministic clock: each frame takes the same time
+            if (m_setup->fixed_step > 0.0) {
+                ellapsedTime = m_setup->fixed_step;
+            }
 
-                sprintf(tmp, "Rendering processing: %lf %%", (redering_t) / ellapsedTime * 100.0);
-                m_debugDraw->ConvertCharToWChar(rendering_time, tmp);
+            // Previous frame is ended here, because state changing
+            // skips the end of the loop
+            m_profiler->BeginFrame();
 
-                sprintf(tmp, "State processing: %lf %%", (state_t) / ellapsedTime * 100.0);
-                m_debugDraw->ConvertCharToWChar(state_time, tmp);
+            if (m_debugDraw == NULL) {
+                // Headless mode (there is no debug info)
+            } else if (counter_to_update > 5) {
+                sprintf(tmp, "FPS: %lf", 1.0 / ellapsedTime);
+                m_debugDraw->ConvertCharToWChar(frame_rate, tmp);
 
-                sprintf(tmp, "GLFW processing: %lf %%", (glfw_t) / ellapsedTime * 100.0);
-                m_debugDraw->ConvertCharToWChar(glfw_time, tmp);
+                PrintProfileStats(input_time, "Input processing", "Input");
+                PrintProfileStats(rendering_time, "Rendering processing", "Rendering");
+                PrintProfileStats(state_time, "State processing", "State");
+                PrintProfileStats(glfw_time, "GLFW processing", "GLFW");
 
                 sprintf(tmp, "Position: x = %f y = %f z = %f", m_camera->m_position->x, m_camera->m_position->y, m_camera->m_position->z);
                 m_debugDraw->ConvertCharToWChar(cam_position, tmp);
@@ -231,7 +269,15 @@ void xEngine::RunMainLoop()
 
 
             // Should we close window (if user press red button on window)
-            m_isDone = (bool)glfwWindowShouldClose(m_window);
+            if (!m_headless) {
+                m_isDone = (bool)glfwWindowShouldClose(m_window);
+            }
+
+            // Leave main loop after the last frame (the frame is processed)
+            frames += 1;
+            if (m_setup->max_frames > 0 && frames >= m_setup->max_frames) {
+                m_isDone = true;
+            }
 
             // Sets all settings to default for this iteration
             // (Flag is_State_Changed to false)
@@ -240,62 +286,107 @@ void xEngine::RunMainLoop()
             // Asks for current state (if it exists)
             m_currentState = m_stateManager->GetCurrentState();
 
-            state_t = glfwGetTime();
             // Update state and set up viewer
             if (m_currentState != NULL) {
+                X_PROFILE_SCOPE("State");
                 m_currentState->Update(ellapsedTime);
                 m_currentState->RequestViewer(m_camera);
             }
-            state_t = glfwGetTime() - state_t;
+
+            // Upload resources loaded in the background
+            {
+                X_PROFILE_SCOPE("Upload");
+                m_asyncLoader->Drain(m_setup->upload_budget);
+            }
 
 
             // Update Camera before main rendering
             m_camera->SetElapsedTime(ellapsedTime);
             m_camera->Update();
 
-            redering_t = glfwGetTime();
-            // Update and apply settings for render system
-            m_renderSystem->UpdateSettings(m_camera);
-            m_renderSystem->ApplySettings();
+            // Null render backend (headless mode) draws nothing
+            if (!m_headless)
+            {
+                X_PROFILE_SCOPE("Rendering");
 
-            // Separately do 3d rendering
-            m_renderSystem->PrepareRendering3D();
-            m_renderSystem->Rendering3D();
+                // Update and apply settings for render system
+                m_renderSystem->UpdateSettings(m_camera);
+                m_renderSystem->ApplySettings();
 
-            // Separately do 2d rendering
-            m_renderSystem->PrepareRendering2D();
-            m_renderSystem->Rendering2D();
-            m_debugDraw->Update();
-            redering_t = glfwGetTime() - redering_t;
+                // Separately do 3d rendering
+                m_renderSystem->PrepareRendering3D();
+                m_renderSystem->Rendering3D();
+
+                // Separately do 2d rendering
+                m_renderSystem->PrepareRendering2D();
+                m_renderSystem->Rendering2D();
+
+                X_PROFILE_SCOPE("Debug Draw");
+                m_debugDraw->Update();
+            }
 
             // Continue loop or render scene, if current
             // state was not changed
             if (m_stateManager->IsStateChanged()) {
                 continue;
-            } else if (m_currentState != NULL) {
+            } else if (m_currentState != NULL && !m_headless) {
                 m_currentState->Render();
             }
 
-            input_t = glfwGetTime();
             // Update input (to default) before next process polling
-            m_input->Update();
-            input_t = glfwGetTime() - input_t;
+            {
+                X_PROFILE_SCOPE("Input");
+                m_input->Update();
+            }
+
+            if (!m_headless)
+            {
+                X_PROFILE_SCOPE("GLFW");
 
-            glfw_t = glfwGetTime();
-            // For some time
-            glfwSwapBuffers(m_window);
+                // For some time
+                glfwSwapBuffers(m_window);
 
-            // Update window system
-            glfwPollEvents();
-            glfw_t = glfwGetTime() - glfw_t;
+                // Update window system
+                glfwPollEvents();
+            }
+
+            m_profiler->EndFrame();
         }
     }
 
-    printf("\nINFO: working time (total): %lf \n", glfwGetTime() - startTime);
+    m_profiler->EndFrame();
+
+    double workingTime = GetTime() - startTime;
+    printf("\nINFO: working time (total): %lf \n", workingTime);
+    printf("INFO: frames: %lu (%lf frames per second) \n", frames, (workingTime > 0.0 ? frames / workingTime : 0.0));
 
     SAFE_DELETE(g_engine);
 }
 
+void xEngine::PrintProfileStats(wchar_t * line, const char * label, const char * scope)
+{
+    char tmp[STRING_SIZE];
+    xProfileStats stats;
+
+    if (m_profiler->GetStats(scope, &stats)) {
+        sprintf(tmp, "%s: avg %.3lf ms, p99 %.3lf ms", label, stats.avg, stats.p99);
+    } else {
+        sprintf(tmp, "%s: -", label);
+    }
+
+    m_debugDraw->ConvertCharToWChar(line, tmp);
+}
+
+double xEngine::GetTime()
+{
+    if (!m_headless) {
+        return glfwGetTime();
+    }
+
+    std::chrono::duration<double> time = std::chrono::steady_clock::now().time_since_epoch();
+    return time.count();
+}
+
 void xEngine::LeaveMainLoop(bool should_leave)
 {
     m_isDone = should_leave;
@@ -334,4 +425,14 @@ xVirtualCamera* xEngine::GetVirtualCamera()
 xDebugDrawManager* xEngine::GetDebugDrawManager()
 {
     return m_debugDraw;
+}
+
+xAsyncLoader* xEngine::GetAsyncLoader()
+{
+    return m_asyncLoader;
+}
+
+xProfiler* xEngine::GetProfiler()
+{
+    return m_profiler;
 }
\ No newline at end of file
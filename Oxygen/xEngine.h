@@ -21,6 +21,14 @@
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#include <algorithm>
+#include <new>
+#include <utility>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 // ----------------------------------------------------------------------
 // Project specific includes
@@ -50,7 +58,11 @@
 #include "xVirtualObject.h"
 #include "xLinkedList.h"
 #include "xDynamicArray.h"
+#include "xValueArray.h"
+#include "xProfiler.h"
+#include "xMappedFile.h"
 #include "xBaseGeometry.h"
+#include "xAsyncLoader.h"
 #include "xResourceManager.h"
 #include "xTexture.h"
 #include "xVariable.h"
@@ -62,11 +74,17 @@
 #include "xFont.h"
 #include "xDebugDrawManager.h"
 #include "xLight.h"
+#include "xVirtualCamera.h"
+#include "xFreeCamera.h"
 #include "xMaterial.h"
+#include "xRenderQueue.h"
+#include "xFrustumCuller.h"
 #include "xModel3d.h"
+#include "xInstanceBatch.h"
+#include "xStaticGeometry.h"
+#include "xMeshCache.h"
+#include "xMeshProcessor.h"
 #include "xModelLoader.h"
-#include "xVirtualCamera.h"
-#include "xFreeCamera.h"
 #include "CLoadObj.h"
 #include "xRenderSystem.h"
 #include "xState.h"
@@ -85,6 +103,12 @@ struct xEngineSetup
     int size_x, size_y;             // Window size
     bool full_screen;               // Is it in full screen mode
     unsigned int debug_font;        // Font size for debug drawing manager
+    unsigned int loader_threads;    // Number of worker threads of async loader (0 - auto)
+    double upload_budget;           // Time (ms) for uploading of async loaded resources per frame
+    bool profiling;                 // Is frame profiler enabled
+    bool headless;                  // Run without window and audio device (null backends)
+    double fixed_step;              // Elapsed time (s) for each frame (0 - real time)
+    unsigned long max_frames;       // Number of frames before leaving main loop (0 - no limit)
 
     void (* StateSetup)();          // State Setup Function
     xVirtualCamera * camera;        // Virtual Game Camera (can be redefined)
@@ -103,6 +127,12 @@ struct xEngineSetup
         StateSetup = NULL;
         strcpy(name, "Application");
         debug_font = 25;
+        loader_threads = 0;
+        upload_budget = 2.0;
+        profiling = true;
+        headless = false;
+        fixed_step = 0.0;
+        max_frames = 0;
     }
 
     // ----------------------------------------------------------------------
@@ -167,6 +197,54 @@ struct xEngineSetup
         debug_font = size;
     }
 
+    // ----------------------------------------------------------------------
+    // Sets number of loading threads and time (ms) for uploading of
+    // loaded resources on the main thread for each frame
+    // ----------------------------------------------------------------------
+    void SetAsyncLoading(unsigned int threads, double budget_ms)
+    {
+        loader_threads = threads;
+        upload_budget = budget_ms;
+    }
+
+    // ----------------------------------------------------------------------
+    // Turns on (or off) frame profiler
+    // ----------------------------------------------------------------------
+    void SetProfiling(bool isProfiling = true)
+    {
+        profiling = isProfiling;
+    }
+
+    // ----------------------------------------------------------------------
+    // Turns on (or off) headless mode: engine runs states and resources
+    // without window, rendering, input and audio device
+    // ----------------------------------------------------------------------
+    void SetHeadless(bool isHeadless = true)
+    {
+        headless = isHeadless;
+    }
+
+    // ----------------------------------------------------------------------
+    // Sets fixed elapsed time (in seconds) for each frame, therefore
+    // update of states is deterministic (0 - real time is used)
+    // ----------------------------------------------------------------------
+    void SetFixedTimeStep(double step)
+    {
+        if (step >= 0.0) {
+            fixed_step = step;
+        } else {
+            printf("WARNING: Time step has wrong format \n");
+        }
+    }
+
+    // ----------------------------------------------------------------------
+    // Sets number of frames, after which main loop is left (0 - no limit)
+    // ----------------------------------------------------------------------
+    void SetMaxFrames(unsigned long frames)
+    {
+        max_frames = frames;
+    }
+
 };
 
 // ----------------------------------------------------------------------
@@ -228,13 +306,34 @@ public:
     xVirtualCamera * GetVirtualCamera();
 
     // ----------------------------------------------------------------------
-    // Returns Engine's Debug Draw Manager
+    // Returns Engine's Debug Draw Manager (NULL in headless mode)
     // ----------------------------------------------------------------------
     xDebugDrawManager * GetDebugDrawManager();
 
+    // ----------------------------------------------------------------------
+    // Returns Engine's Async Loader (for xResourceManager::AddAsync)
+    // ----------------------------------------------------------------------
+    xAsyncLoader * GetAsyncLoader();
+
+    // ----------------------------------------------------------------------
+    // Returns Engine's Frame Profiler
+    // ----------------------------------------------------------------------
+    xProfiler * GetProfiler();
+
 private:
 
-    GLFWwindow * m_window;              // Application's window's descriptorxs
+    // ----------------------------------------------------------------------
+    // Prints profiler statistics of scope in the debug line
+    // ----------------------------------------------------------------------
+    void PrintProfileStats(wchar_t * line, const char * label, const char * scope);
+
+    // ----------------------------------------------------------------------
+    // Returns current real time in seconds (works in headless mode too)
+    // ----------------------------------------------------------------------
+    double GetTime();
+
+    GLFWwindow * m_window;              // Application's window's descriptorxs (NULL in headless mode)
+    bool m_headless;                    // Is Engine working without window and audio device
     bool m_loaded;                      // Is Engine loaded (created and ready to be use)
     bool m_active;                      // Is Application Window active
     bool m_isDone;                      // Is main loop should be closed
@@ -248,6 +347,8 @@ private:
     xStateManager * m_stateManager;                 // State Manager
     xRenderSystem * m_renderSystem;                 // Rendering System
     xDebugDrawManager * m_debugDraw;                // Debug Draw Manager (only for development)
+    xAsyncLoader * m_asyncLoader;                   // Background loader of resources
+    xProfiler * m_profiler;                         // Frame Profiler
 
 };
 
@@ -0,0 +1,241 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 27.02.2018.
+ * Copyright
+ *
+ * Realisation of functions defined in the file
+ * xFrustumCuller.h. Go there to find more information
+ * and interface specifications
+ */
+
+#include "xEngine.h"
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64)
+    #include <xmmintrin.h>
+#endif
+
+// ----------------------------------------------------------------------
+// Returns number of set bits of the word
+// ----------------------------------------------------------------------
+static inline long CountBits(unsigned int word)
+{
+    long count = 0;
+    while (word != 0) {
+        word &= word - 1;
+        count += 1;
+    }
+    return count;
+}
+
+xFrustumCuller::xFrustumCuller()
+{
+    m_stats.tested = 0;
+    m_stats.visible = 0;
+}
+
+void xFrustumCuller::Clear()
+{
+    m_x.Clear();
+    m_y.Clear();
+    m_z.Clear();
+    m_radius.Clear();
+    m_extentX.Clear();
+    m_extentY.Clear();
+    m_extentZ.Clear();
+    m_mask.Clear();
+    m_stats.tested = 0;
+    m_stats.visible = 0;
+}
+
+long xFrustumCuller::Add(xVector3 * center, float radius, xVector3 * extents, const float * transform)
+{
+    xVector3 c = *center;
+    xVector3 e = *extents;
+    if (transform != NULL) {
+        TransformBounds(transform, &c, &radius, &e);
+    }
+
+    m_x.Add(c.x);
+    m_y.Add(c.y);
+    m_z.Add(c.z);
+    m_radius.Add(radius);
+    m_extentX.Add(e.x);
+    m_extentY.Add(e.y);
+    m_extentZ.Add(e.z);
+
+    return m_x.GetNumOfElements() - 1;
+}
+
+void xFrustumCuller::Cull(xVirtualCamera * camera)
+{
+    X_PROFILE_SCOPE("Frustum Culling");
+
+    float planes[6][4];
+    camera->GetFrustumPlanes(planes);
+
+    long count = m_x.GetNumOfElements();
+    m_mask.Resize((count + CULL_MASK_BITS - 1) / CULL_MASK_BITS);
+
+    long visible = CullBounds(planes, m_x.Data(), m_y.Data(), m_z.Data(), m_radius.Data(),
+                              m_extentX.Data(), m_extentY.Data(), m_extentZ.Data(), count, m_mask.Data());
+
+    m_stats.tested = (unsigned long)count;
+    m_stats.visible = (unsigned long)visible;
+}
+
+bool xFrustumCuller::IsVisible(long index)
+{
+    // Mask has bits of the bounds of the last Cull only
+    if (index < 0 || index >= (long)m_stats.tested) {
+        return true;
+    }
+
+    return (m_mask[index / CULL_MASK_BITS] >> (index % CULL_MASK_BITS)) & 1;
+}
+
+const unsigned int * xFrustumCuller::GetMask()
+{
+    return m_mask.Data();
+}
+
+long xFrustumCuller::GetNumOfBounds()
+{
+    return m_x.GetNumOfElements();
+}
+
+xFrustumCullerStats xFrustumCuller::GetStats()
+{
+    return m_stats;
+}
+
+void xFrustumCuller::TransformBounds(const float * transform, xVector3 * center, float * radius, xVector3 * extents)
+{
+    const float * m = transform;
+    float c[3] = {center->x, center->y, center->z};
+    float e[3] = {extents->x, extents->y, extents->z};
+    float result[3];
+    float scale = 0.0f;
+
+    for(int row = 0; row < 3; row++) {
+        result[row] = m[row] * c[0] + m[4 + row] * c[1] + m[8 + row] * c[2] + m[12 + row];
+    }
+    center->Set(result[0], result[1], result[2]);
+
+    for(int row = 0; row < 3; row++) {
+        result[row] = fabsf(m[row]) * e[0] + fabsf(m[4 + row]) * e[1] + fabsf(m[8 + row]) * e[2];
+    }
+    extents->Set(result[0], result[1], result[2]);
+
+    // Length of the longest transformed axis
+    for(int column = 0; column < 3; column++) {
+        const float * axis = m + column * 4;
+        float length = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+        scale = (length > scale ? length : scale);
+    }
+    *radius *= scale;
+}
+
+long xFrustumCuller::CullBounds(const float planes[6][4], const float * x, const float * y, const float * z,
+                                const float * radius, const float * extentX, const float * extentY,
+                                const float * extentZ, long count, unsigned int * mask)
+{
+    memset(mask, 0, sizeof(unsigned int) * ((count + CULL_MASK_BITS - 1) / CULL_MASK_BITS));
+
+    // Absolute values of normals project half sizes of box on the normal
+    float normals[6][3];
+    for(int p = 0; p < 6; p++) {
+        for(int k = 0; k < 3; k++) {
+            normals[p][k] = fabsf(planes[p][k]);
+        }
+    }
+
+    long i = 0;
+
+#if defined(__AVX__)
+
+    // Groups of 8 never cross the word of the mask
+    __m256 zero = _mm256_setzero_ps();
+    for(; i + 8 <= count; i += 8)
+    {
+        __m256 cx = _mm256_loadu_ps(x + i);
+        __m256 cy = _mm256_loadu_ps(y + i);
+        __m256 cz = _mm256_loadu_ps(z + i);
+        __m256 r = _mm256_loadu_ps(radius + i);
+        __m256 ex = _mm256_loadu_ps(extentX + i);
+        __m256 ey = _mm256_loadu_ps(extentY + i);
+        __m256 ez = _mm256_loadu_ps(extentZ + i);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+        for(int p = 0; p < 6; p++) {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes[p][0]), cx),
+                                                          _mm256_mul_ps(_mm256_set1_ps(planes[p][1]), cy)),
+                                            _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes[p][2]), cz),
+                                                          _mm256_set1_ps(planes[p][3])));
+            __m256 size = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(normals[p][0]), ex),
+                                                      _mm256_mul_ps(_mm256_set1_ps(normals[p][1]), ey)),
+                                        _mm256_mul_ps(_mm256_set1_ps(normals[p][2]), ez));
+            size = _mm256_min_ps(r, size);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, size), zero, _CMP_GT_OQ));
+        }
+
+        mask[i / CULL_MASK_BITS] |= (unsigned int)_mm256_movemask_ps(inside) << (i % CULL_MASK_BITS);
+    }
+
+#elif defined(__SSE__) || defined(_M_X64)
+
+    // Groups of 4 never cross the word of the mask
+    __m128 zero = _mm_setzero_ps();
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 cx = _mm_loadu_ps(x + i);
+        __m128 cy = _mm_loadu_ps(y + i);
+        __m128 cz = _mm_loadu_ps(z + i);
+        __m128 r = _mm_loadu_ps(radius + i);
+        __m128 ex = _mm_loadu_ps(extentX + i);
+        __m128 ey = _mm_loadu_ps(extentY + i);
+        __m128 ez = _mm_loadu_ps(extentZ + i);
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+
+        for(int p = 0; p < 6; p++) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p][0]), cx),
+                                                    _mm_mul_ps(_mm_set1_ps(planes[p][1]), cy)),
+                                         _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p][2]), cz),
+                                                    _mm_set1_ps(planes[p][3])));
+            __m128 size = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(normals[p][0]), ex),
+                                                _mm_mul_ps(_mm_set1_ps(normals[p][1]), ey)),
+                                     _mm_mul_ps(_mm_set1_ps(normals[p][2]), ez));
+            size = _mm_min_ps(r, size);
+            inside = _mm_and_ps(inside, _mm_cmpgt_ps(_mm_add_ps(distance, size), zero));
+        }
+
+        mask[i / CULL_MASK_BITS] |= (unsigned int)_mm_movemask_ps(inside) << (i % CULL_MASK_BITS);
+    }
+
+#endif
+
+    // The rest of bounds (or all of them without SIMD) by the same test
+    for(; i < count; i++)
+    {
+        bool isInside = true;
+
+        for(int p = 0; p < 6 && isInside; p++) {
+            float distance = (planes[p][0] * x[i] + planes[p][1] * y[i]) + (planes[p][2] * z[i] + planes[p][3]);
+            float size = (normals[p][0] * extentX[i] + normals[p][1] * extentY[i]) + normals[p][2] * extentZ[i];
+            size = (radius[i] < size ? radius[i] : size);
+            isInside = (distance + size > 0.0f);
+        }
+
+        if (isInside) {
+            mask[i / CULL_MASK_BITS] |= 1u << (i % CULL_MASK_BITS);
+        }
+    }
+
+    long visible = 0;
+    for(long w = 0; w < (count + CULL_MASK_BITS - 1) / CULL_MASK_BITS; w++) {
+        visible += CountBits(mask[w]);
+    }
+
+    return visible;
+}
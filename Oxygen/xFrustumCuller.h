@@ -0,0 +1,118 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 27.02.2018.
+ * Copyright
+ *
+ * xFrustumCuller tests bounds of many objects
+ * against 6 planes of the camera frustum by one
+ * batch. Bounds are kept as arrays of components
+ * (centers, radiuses and half sizes of boxes),
+ * so 4 (SSE) or 8 (AVX) objects are tested by
+ * one pass over the planes. Result is the bit
+ * mask of visible objects (bit i of word i / 32)
+ */
+
+#ifndef OXYGEN_XFRUSTUMCULLER_H
+#define OXYGEN_XFRUSTUMCULLER_H
+
+#define CULL_MASK_BITS  32      // Objects per word of visibility mask
+
+// ----------------------------------------------------------------------
+// Counters of the last Cull
+// ----------------------------------------------------------------------
+
+struct xFrustumCullerStats
+{
+    unsigned long tested;       // Bounds tested against frustum
+    unsigned long visible;      // Bounds, which are in frustum
+};
+
+// ----------------------------------------------------------------------
+// Frustum Culler Class
+// ----------------------------------------------------------------------
+
+class xFrustumCuller
+{
+public:
+
+    // ----------------------------------------------------------------------
+    // Creates culler without bounds
+    // ----------------------------------------------------------------------
+    xFrustumCuller();
+
+    // ----------------------------------------------------------------------
+    // Removes bounds and visibility mask of the previous frame
+    // ----------------------------------------------------------------------
+    void Clear();
+
+    // ----------------------------------------------------------------------
+    // Adds bounds of object: sphere and box with the same center (extents
+    // are half sizes of the box), which are moved by model matrix of the
+    // object (NULL - bounds are in world space). Returns index of the
+    // bounds in the mask
+    // ----------------------------------------------------------------------
+    long Add(xVector3 * center, float radius, xVector3 * extents, const float * transform = NULL);
+
+    // ----------------------------------------------------------------------
+    // Tests all the bounds against the current frustum of the camera
+    // (call after SetPerspective or UpdateMatrices of the camera)
+    // ----------------------------------------------------------------------
+    void Cull(xVirtualCamera * camera);
+
+    // ----------------------------------------------------------------------
+    // Returns true, if bounds with the index are visible after Cull (bounds,
+    // which were not tested by the last Cull, are visible)
+    // ----------------------------------------------------------------------
+    bool IsVisible(long index);
+
+    // ----------------------------------------------------------------------
+    // Returns visibility mask of the last Cull
+    // ----------------------------------------------------------------------
+    const unsigned int * GetMask();
+
+    // ----------------------------------------------------------------------
+    // Returns number of added bounds
+    // ----------------------------------------------------------------------
+    long GetNumOfBounds();
+
+    // ----------------------------------------------------------------------
+    // Returns counters of the last Cull
+    // ----------------------------------------------------------------------
+    xFrustumCullerStats GetStats();
+
+    // ----------------------------------------------------------------------
+    // Moves bounds by model matrix (16 floats of column-major matrix, as for
+    // glMultMatrixf, of translation, rotation and scale without shear):
+    // center is transformed, radius is scaled by the largest scale of axes
+    // and half sizes of box are projected by absolute values of the matrix
+    // (box contains transformed box)
+    // ----------------------------------------------------------------------
+    static void TransformBounds(const float * transform, xVector3 * center, float * radius, xVector3 * extents);
+
+    // ----------------------------------------------------------------------
+    // Sets bits of mask (count bits) for bounds, which are in frustum of
+    // 6 planes (a, b, c, d with normals to the inside). Object is out, if
+    // center is behind one plane further than the smaller of radius and
+    // projected size of box. Returns number of visible bounds
+    // ----------------------------------------------------------------------
+    static long CullBounds(const float planes[6][4], const float * x, const float * y, const float * z,
+                           const float * radius, const float * extentX, const float * extentY,
+                           const float * extentZ, long count, unsigned int * mask);
+
+private:
+
+    xValueArray<float> m_x;             // Centers of bounds
+    xValueArray<float> m_y;             //
+    xValueArray<float> m_z;             //
+    xValueArray<float> m_radius;        // Radiuses of bounding spheres
+    xValueArray<float> m_extentX;       // Half sizes of bounding boxes
+    xValueArray<float> m_extentY;       //
+    xValueArray<float> m_extentZ;       //
+
+    xValueArray<unsigned int> m_mask;   // Visibility bits of the last Cull
+    xFrustumCullerStats m_stats;        // Counters of the last Cull
+
+};
+
+
+#endif //OXYGEN_XFRUSTUMCULLER_H
@@ -86,6 +86,10 @@ xInput::xInput(GLFWwindow * window_descriptor)
     m_isGamePadAvailable = false;
     m_inaccuracy = 0.0;
 
+    if (m_window == NULL) {
+        return;
+    }
+
     // Set necessary modes (sticky to prevent lose of info in cycles)
     glfwSetInputMode(m_window, GLFW_STICKY_KEYS, GLFW_TRUE);
     glfwSetInputMode(m_window, GLFW_STICKY_MOUSE_BUTTONS, GLFW_TRUE);
@@ -187,11 +191,19 @@ double xInput::GetScrollY()
 
 void xInput::HideCursor()
 {
+    if (m_window == NULL) {
+        return;
+    }
+
     glfwSetInputMode(m_window, GLFW_CURSOR, GLFW_CURSOR_HIDDEN);
 }
 
 void xInput::ShowCursor()
 {
+    if (m_window == NULL) {
+        return;
+    }
+
     glfwSetInputMode(m_window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
 }
 
@@ -296,6 +308,10 @@ void xInput::Update()
     keyboard_key = -1;
     keyboard_key_action = -1;
 
+    if (m_window == NULL) {
+        return;
+    }
+
     m_isGamePadAvailable = glfwJoystickPresent(GLFW_JOYSTICK_1);
     if (m_isGamePadAvailable)
     {
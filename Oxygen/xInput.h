@@ -77,7 +77,8 @@ class xInput
 public:
 
     // ----------------------------------------------------------------------
-    // Class Constructor from window descriptor
+    // Class Constructor from window descriptor (NULL - headless mode,
+    // there are no input events)
     // ----------------------------------------------------------------------
     xInput(GLFWwindow * window_descriptor);
 
@@ -0,0 +1,372 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 25.02.2018.
+ * Copyright
+ *
+ * Realisation of functions defined in the file
+ * xInstanceBatch.h. Go there to find more information
+ * and interface specifications
+ */
+
+#include "xEngine.h"
+
+// Vertex of the copy is moved by instance matrix, then it is lit by
+// the light 0 as in fixed pipeline (without attenuation and spot, with
+// local viewer and normalized normals). Base of pow is not 0, because
+// pow(0, 0) is not defined in GLSL
+static const char * s_vertexShader =
+    "#version 120\n"
+    "attribute mat4 instanceMatrix;\n"
+    "varying vec4 color;\n"
+    "void main()\n"
+    "{\n"
+    "    vec4 position = gl_ModelViewMatrix * (instanceMatrix * gl_Vertex);\n"
+    "    vec3 normal = normalize(gl_NormalMatrix * (mat3(instanceMatrix) * gl_Normal));\n"
+    "    vec3 light = normalize(gl_LightSource[0].position.xyz - position.xyz * gl_LightSource[0].position.w);\n"
+    "    vec3 halfway = normalize(light + normalize(-position.xyz));\n"
+    "    float diffuse = max(dot(normal, light), 0.0);\n"
+    "    float specular = (diffuse > 0.0 ? pow(max(dot(normal, halfway), 1e-6), gl_FrontMaterial.shininess) : 0.0);\n"
+    "    color = gl_FrontLightModelProduct.sceneColor + gl_FrontLightProduct[0].ambient +\n"
+    "            gl_FrontLightProduct[0].diffuse * diffuse + gl_FrontLightProduct[0].specular * specular;\n"
+    "    color.a = gl_FrontMaterial.diffuse.a;\n"
+    "    gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+    "    gl_Position = gl_ProjectionMatrix * position;\n"
+    "}\n";
+
+static const char * s_fragmentShader =
+    "#version 120\n"
+    "uniform sampler2D diffuseTexture;\n"
+    "uniform float useTexture;\n"
+    "varying vec4 color;\n"
+    "void main()\n"
+    "{\n"
+    "    vec4 texel = texture2D(diffuseTexture, gl_TexCoord[0].st);\n"
+    "    gl_FragColor = color * mix(vec4(1.0), texel, useTexture);\n"
+    "}\n";
+
+// ----------------------------------------------------------------------
+// Compiles shader. Returns 0 and prints log, if it cannot be compiled
+// ----------------------------------------------------------------------
+static GLuint CompileShader(GLenum type, const char * source)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+
+    GLint isCompiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
+
+    if (isCompiled != GL_TRUE) {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        printf("WARNING: Cannot compile instancing shader: %s \n", log);
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    return shader;
+}
+
+// ----------------------------------------------------------------------
+// Multiplies column-major 4x4 matrices (result = a * b)
+// ----------------------------------------------------------------------
+static inline void MultiplyMatrices(const float * a, const float * b, float * result)
+{
+    for(int column = 0; column < 4; column++) {
+        for(int row = 0; row < 4; row++) {
+            result[column * 4 + row] = a[row] * b[column * 4] + a[4 + row] * b[column * 4 + 1] +
+                                       a[8 + row] * b[column * 4 + 2] + a[12 + row] * b[column * 4 + 3];
+        }
+    }
+}
+
+xInstanceBatch::xInstanceBatch()
+{
+    m_stats.drawCalls = 0;
+    m_stats.instances = 0;
+    m_stats.isInstanced = false;
+
+    m_useInstancing = true;
+    m_isCreated = false;
+    m_isSupported = false;
+    m_program = 0;
+    m_buffer = 0;
+    m_bufferSize = 0;
+    m_matrixLocation = -1;
+    m_textureLocation = -1;
+    m_useTextureLocation = -1;
+}
+
+xInstanceBatch::~xInstanceBatch()
+{
+    if (m_program != 0) {
+        glDeleteProgram(m_program);
+    }
+    if (m_buffer != 0) {
+        glDeleteBuffers(1, &m_buffer);
+    }
+}
+
+void xInstanceBatch::SetInstancingEnabled(bool enabled)
+{
+    m_useInstancing = enabled;
+}
+
+void xInstanceBatch::Clear()
+{
+    m_ranges.Clear();
+    m_transforms.Clear();
+}
+
+void xInstanceBatch::Submit(xModel3d * model, const float * transforms, long num_instances)
+{
+    if (model == NULL || transforms == NULL || num_instances <= 0) {
+        return;
+    }
+
+    // Copies of the model submitted one after another share the range
+    long first = m_transforms.GetNumOfElements() / INSTANCE_MATRIX_SIZE;
+    long numOfRanges = m_ranges.GetNumOfElements();
+
+    if (numOfRanges > 0 && m_ranges[numOfRanges - 1].model == model) {
+        m_ranges[numOfRanges - 1].count += num_instances;
+    } else {
+        xInstanceRange * range = m_ranges.EmplaceBack();
+        range->model = model;
+        range->first = first;
+        range->count = num_instances;
+    }
+
+    m_transforms.Resize((first + num_instances) * INSTANCE_MATRIX_SIZE);
+    memcpy(m_transforms.Data() + first * INSTANCE_MATRIX_SIZE, transforms,
+           sizeof(float) * INSTANCE_MATRIX_SIZE * num_instances);
+}
+
+void xInstanceBatch::Execute(const float * view)
+{
+    X_PROFILE_SCOPE("Instances");
+
+    m_stats.drawCalls = 0;
+    m_stats.instances = 0;
+    m_stats.isInstanced = false;
+
+    if (m_ranges.GetNumOfElements() == 0) {
+        return;
+    }
+
+    if (!m_isCreated) {
+        m_isSupported = CreateProgram();
+    }
+
+    // Model view matrix of the caller is restored after the copies
+    glPushMatrix();
+    glLoadMatrixf(view);
+
+    if (m_isSupported && m_useInstancing) {
+        ExecuteInstanced(view);
+    } else {
+        ExecuteLoop(view);
+    }
+
+    glPopMatrix();
+}
+
+xInstanceBatchStats xInstanceBatch::GetStats()
+{
+    return m_stats;
+}
+
+bool xInstanceBatch::CreateProgram()
+{
+    m_isCreated = true;
+
+    if (!GLEW_VERSION_2_0 || !GLEW_ARB_instanced_arrays) {
+        printf("INFO: Hardware instancing is not supported (copies are drawn by CPU loop) \n");
+        return false;
+    }
+
+    GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, s_vertexShader);
+    GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, s_fragmentShader);
+
+    if (vertexShader == 0 || fragmentShader == 0) {
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        return false;
+    }
+
+    m_program = glCreateProgram();
+    glAttachShader(m_program, vertexShader);
+    glAttachShader(m_program, fragmentShader);
+    glLinkProgram(m_program);
+
+    // Shaders are deleted with the program
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint isLinked = GL_FALSE;
+    glGetProgramiv(m_program, GL_LINK_STATUS, &isLinked);
+
+    m_matrixLocation = glGetAttribLocation(m_program, "instanceMatrix");
+    m_textureLocation = glGetUniformLocation(m_program, "diffuseTexture");
+    m_useTextureLocation = glGetUniformLocation(m_program, "useTexture");
+
+    if (isLinked != GL_TRUE || m_matrixLocation < 0) {
+        char log[1024];
+        glGetProgramInfoLog(m_program, sizeof(log), NULL, log);
+        printf("WARNING: Cannot link instancing shader: %s \n", log);
+
+        glDeleteProgram(m_program);
+        m_program = 0;
+        return false;
+    }
+
+    glGenBuffers(1, &m_buffer);
+    return true;
+}
+
+void xInstanceBatch::ExecuteInstanced(const float * view)
+{
+    // Buffer is orphaned each frame (driver gives new memory, if the
+    // previous data is still used)
+    long size = sizeof(float) * m_transforms.GetNumOfElements();
+    m_bufferSize = (size > m_bufferSize ? size : m_bufferSize);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+    glBufferData(GL_ARRAY_BUFFER, m_bufferSize, NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, m_transforms.Data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glUseProgram(m_program);
+    glUniform1i(m_textureLocation, 0);
+
+    for(long i = 0; i < m_ranges.GetNumOfElements(); i++)
+    {
+        xInstanceRange & range = m_ranges[i];
+        xModel3d * model = range.model;
+
+        for(long j = 0; j < model->num_objects; j++)
+        {
+            xObject3d * object = model->m_objects->GetElement(j);
+            if (!object->is_active) {
+                continue;
+            }
+
+            GLuint texture = ApplyState(model, object);
+
+            // Objects without arrays (not indexed or compressed without
+            // buffers) are drawn by the loop as without instancing
+            if (!object->BindArrays()) {
+                glUseProgram(0);
+                DrawLoop(range, object, view);
+                glLoadMatrixf(view);
+                glUseProgram(m_program);
+                continue;
+            }
+
+            glUniform1f(m_useTextureLocation, (texture != 0 ? 1.0f : 0.0f));
+
+            // Columns of instance matrix are the next attributes, they are
+            // changed once per copy (attributes are set in the bound vertex
+            // array and are turned off after drawing)
+            glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+            for(int k = 0; k < 4; k++) {
+                GLuint location = (GLuint)(m_matrixLocation + k);
+                unsigned long offset = sizeof(float) * (range.first * INSTANCE_MATRIX_SIZE + 4 * k);
+
+                glEnableVertexAttribArray(location);
+                glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(float) * INSTANCE_MATRIX_SIZE,
+                                      (const GLvoid *)offset);
+                glVertexAttribDivisorARB(location, 1);
+            }
+
+            object->DrawBound((GLsizei)range.count);
+
+            for(int k = 0; k < 4; k++) {
+                glVertexAttribDivisorARB((GLuint)(m_matrixLocation + k), 0);
+                glDisableVertexAttribArray((GLuint)(m_matrixLocation + k));
+            }
+
+            object->UnbindArrays();
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+            m_stats.drawCalls += 1;
+        }
+
+        m_stats.instances += range.count;
+    }
+
+    glUseProgram(0);
+    m_stats.isInstanced = true;
+}
+
+void xInstanceBatch::ExecuteLoop(const float * view)
+{
+    for(long i = 0; i < m_ranges.GetNumOfElements(); i++)
+    {
+        xInstanceRange & range = m_ranges[i];
+        xModel3d * model = range.model;
+
+        for(long j = 0; j < model->num_objects; j++)
+        {
+            xObject3d * object = model->m_objects->GetElement(j);
+            if (!object->is_active) {
+                continue;
+            }
+
+            ApplyState(model, object);
+            DrawLoop(range, object, view);
+        }
+
+        m_stats.instances += range.count;
+    }
+}
+
+void xInstanceBatch::DrawLoop(xInstanceRange & range, xObject3d * object, const float * view)
+{
+    // Matrix of each copy is counted on CPU and loaded instead of
+    // push, multiply and pop
+    float matrix[INSTANCE_MATRIX_SIZE];
+    const float * transforms = m_transforms.Data() + range.first * INSTANCE_MATRIX_SIZE;
+
+    // Object without arrays is drawn by its own path
+    bool isBound = object->BindArrays();
+
+    for(long k = 0; k < range.count; k++) {
+        MultiplyMatrices(view, transforms + k * INSTANCE_MATRIX_SIZE, matrix);
+        glLoadMatrixf(matrix);
+
+        if (isBound) {
+            object->DrawBound(0);
+        } else {
+            object->Draw();
+        }
+    }
+
+    if (isBound) {
+        object->UnbindArrays();
+    }
+
+    m_stats.drawCalls += range.count;
+}
+
+GLuint xInstanceBatch::ApplyState(xModel3d * model, xObject3d * object)
+{
+    xMaterial * material = model->m_materials->GetElement(object->m_MaterialId);
+    xTexture * texture = object->m_texture;
+
+    if (material != NULL) {
+        material->ApplyColors();
+        texture = (texture != NULL ? texture : material->GetTexture());
+    }
+
+    GLuint textureID = (texture != NULL ? texture->GetTextureID() : 0);
+
+    if (textureID != 0) {
+        glEnable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+    } else {
+        glDisable(GL_TEXTURE_2D);
+    }
+
+    return textureID;
+}
@@ -0,0 +1,144 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 25.02.2018.
+ * Copyright
+ *
+ * xInstanceBatch draws many copies of the same
+ * models. Transforms of the copies are submitted
+ * during the frame, uploaded in one instance
+ * buffer and each object of the model is drawn
+ * by one instanced draw call (GLSL 1.20 shader
+ * with ARB_instanced_arrays, lighting by the
+ * light 0 and diffuse texture). Without these
+ * extensions (and for objects, which cannot be
+ * drawn from arrays) copies are drawn by the
+ * loop, where arrays and material are set once
+ * per object and each copy costs matrix load
+ * and draw call
+ */
+
+#ifndef OXYGEN_XINSTANCEBATCH_H
+#define OXYGEN_XINSTANCEBATCH_H
+
+#define INSTANCE_MATRIX_SIZE    16      // Floats of one transform (column-major 4x4 matrix)
+
+// ----------------------------------------------------------------------
+// Copies of one model (range of transforms of the batch)
+// ----------------------------------------------------------------------
+
+struct xInstanceRange
+{
+    xModel3d * model;
+    long first;                 // First transform of the range
+    long count;                 // Number of transforms
+};
+
+// ----------------------------------------------------------------------
+// Counters of the last executed frame
+// ----------------------------------------------------------------------
+
+struct xInstanceBatchStats
+{
+    unsigned long drawCalls;    // Draw calls of all the copies
+    unsigned long instances;    // Drawn copies of models
+    bool isInstanced;           // Copies were drawn by hardware instancing
+};
+
+// ----------------------------------------------------------------------
+// Instance Batch Class
+// ----------------------------------------------------------------------
+
+class xInstanceBatch
+{
+public:
+
+    // ----------------------------------------------------------------------
+    // Creates empty batch (GL objects are created by the first Execute)
+    // ----------------------------------------------------------------------
+    xInstanceBatch();
+
+    // ----------------------------------------------------------------------
+    // Deletes instance buffer and shader program
+    // ----------------------------------------------------------------------
+    ~xInstanceBatch();
+
+    // ----------------------------------------------------------------------
+    // Turns on (or off) hardware instancing (on by default, it is
+    // used only if it is supported)
+    // ----------------------------------------------------------------------
+    void SetInstancingEnabled(bool enabled);
+
+    // ----------------------------------------------------------------------
+    // Removes copies of the previous frame
+    // ----------------------------------------------------------------------
+    void Clear();
+
+    // ----------------------------------------------------------------------
+    // Adds copies of the model (transforms are copied, 16 floats of
+    // column-major matrix for each copy, as for glMultMatrixf). Copies
+    // are drawn with the current levels of objects of the model
+    // ----------------------------------------------------------------------
+    void Submit(xModel3d * model, const float * transforms, long num_instances);
+
+    // ----------------------------------------------------------------------
+    // Draws all the copies with the view matrix (16 floats of column-major
+    // matrix: view of the camera multiplied by model transform of the
+    // caller). Model view matrix of GL is not changed (needs current
+    // context)
+    // ----------------------------------------------------------------------
+    void Execute(const float * view);
+
+    // ----------------------------------------------------------------------
+    // Returns counters of the last Execute
+    // ----------------------------------------------------------------------
+    xInstanceBatchStats GetStats();
+
+private:
+
+    // ----------------------------------------------------------------------
+    // Checks extensions and creates instance buffer and shader program.
+    // Returns false, if hardware instancing cannot be used
+    // ----------------------------------------------------------------------
+    bool CreateProgram();
+
+    // ----------------------------------------------------------------------
+    // Draws copies by hardware instancing (objects, which cannot be drawn
+    // from arrays, are drawn by DrawLoop)
+    // ----------------------------------------------------------------------
+    void ExecuteInstanced(const float * view);
+
+    // ----------------------------------------------------------------------
+    // Draws copies by the loop on CPU
+    // ----------------------------------------------------------------------
+    void ExecuteLoop(const float * view);
+
+    // ----------------------------------------------------------------------
+    // Draws copies of the object of the range one by one with matrices
+    // counted on CPU (state of the object is applied before)
+    // ----------------------------------------------------------------------
+    void DrawLoop(xInstanceRange & range, xObject3d * object, const float * view);
+
+    // ----------------------------------------------------------------------
+    // Applies material and texture of the object. Returns GL name of
+    // the texture (0 - object is not textured)
+    // ----------------------------------------------------------------------
+    GLuint ApplyState(xModel3d * model, xObject3d * object);
+
+    xValueArray<xInstanceRange> m_ranges;   // Copies of models in the order of submitting
+    xValueArray<float> m_transforms;        // Transforms of all the copies
+    xInstanceBatchStats m_stats;            // Counters of the last Execute
+
+    bool m_useInstancing;                   // Hardware instancing is allowed
+    bool m_isCreated;                       // Creation of GL objects was tried
+    bool m_isSupported;                     // Program and buffer are created
+    GLuint m_program;                       // Shader program with instance matrix
+    GLuint m_buffer;                        // Instance buffer (transforms of the frame)
+    long m_bufferSize;                      // Allocated size of instance buffer (in bytes)
+    GLint m_matrixLocation;                 // First attribute of instance matrix (4 columns)
+    GLint m_textureLocation;                // Uniform of diffuse texture
+    GLint m_useTextureLocation;             // Uniform: 1.0 - texture is used, 0.0 - it is not
+
+};
+
+
+#endif //OXYGEN_XINSTANCEBATCH_H
@@ -6,6 +6,12 @@
  * xLinkedList provides functionality for engine
  * modules by usage of Double-Connected Linked List
  * structure (uses in xResourceManager.h ...)
+ *
+ * Elements of the list are allocated from its own
+ * pool of nodes (slabs of memory), therefore adding
+ * and removing of elements does not call malloc for
+ * nodes. The list can be walked by any number of
+ * independent iterators (also in range-for loop)
  */
 
 #ifndef OXYGEN_XLINKEDLIST_H
@@ -53,13 +59,78 @@ public:
         }
     };
 
+    // ----------------------------------------------------------------------
+    // Iterator of the list (does not change the state of the list,
+    // therefore the list can be walked by a lot of iterators at once)
+    // ----------------------------------------------------------------------
+    class Iterator
+    {
+    public:
+
+        Iterator(Element * element = NULL)
+        {
+            m_element = element;
+        }
+
+        // ----------------------------------------------------------------------
+        // Returns data of the current element
+        // ----------------------------------------------------------------------
+        Type * operator * () const
+        {
+            return m_element->data;
+        }
+
+        // ----------------------------------------------------------------------
+        // Moves iterator to the next element
+        // ----------------------------------------------------------------------
+        Iterator & operator ++ ()
+        {
+            m_element = m_element->next;
+            return *this;
+        }
+
+        bool operator == (const Iterator & other) const
+        {
+            return m_element == other.m_element;
+        }
+
+        bool operator != (const Iterator & other) const
+        {
+            return m_element != other.m_element;
+        }
+
+        // ----------------------------------------------------------------------
+        // Returns true if iterator points to the element of the list
+        // ----------------------------------------------------------------------
+        bool IsValid() const
+        {
+            return m_element != NULL;
+        }
+
+        // ----------------------------------------------------------------------
+        // Returns completed element (with next and prev pointers)
+        // ----------------------------------------------------------------------
+        Element * GetElement() const
+        {
+            return m_element;
+        }
+
+    private:
+
+        Element * m_element;    // Current element of iteration
+    };
+
     // ----------------------------------------------------------------------
     // The linked list class constructor
     // ----------------------------------------------------------------------
     xLinkedList()
     {
-        m_first = m_last = m_iterate = m_temp = NULL;
+        m_first = m_last = m_iterate = NULL;
         m_totalElements = 0;
+
+        m_freeNodes = NULL;
+        m_slabs = NULL;
+        m_slabSize = 16;
     }
 
     // ----------------------------------------------------------------------
@@ -68,6 +139,13 @@ public:
     ~xLinkedList()
     {
         Empty();
+
+        while (m_slabs != NULL)
+        {
+            Slab * slab = m_slabs;
+            m_slabs = m_slabs->next;
+            free(slab);
+        }
     }
 
     // ----------------------------------------------------------------------
@@ -80,12 +158,12 @@ public:
 
         if (m_first == NULL)
         {
-            m_first = new Element(element);
+            m_first = NewElement(element);
             m_last = m_first;
         }
         else
         {
-            m_last->next = new Element(element);
+            m_last->next = NewElement(element);
             m_last->next->prev = m_last;
             m_last = m_last->next;
         }
@@ -100,13 +178,13 @@ public:
     // ----------------------------------------------------------------------
     Type * InsertBefore(Type * element, Element * nextElement)
     {
-        m_temp = nextElement->prev;
+        Element * prev = nextElement->prev;
 
         m_totalElements += 1;
 
-        if (m_temp == NULL)
+        if (prev == NULL)
         {
-            m_first = new Element(element);
+            m_first = NewElement(element);
             m_first->next = nextElement;
             nextElement->prev = m_first;
 
@@ -114,12 +192,12 @@ public:
         }
         else
         {
-            m_temp->next = new Element(element);
-            m_temp->next->prev = m_temp;
-            m_temp->next->next = nextElement;
-            nextElement->prev = m_temp->next;
+            prev->next = NewElement(element);
+            prev->next->prev = prev;
+            prev->next->next = nextElement;
+            nextElement->prev = prev->next;
 
-            return m_temp->next->data;
+            return prev->next->data;
         }
     }
 
@@ -128,25 +206,25 @@ public:
     // ----------------------------------------------------------------------
     void Remove(Type * element)
     {
-        m_temp = m_first;
-        while (m_temp != NULL)
+        Element * temp = m_first;
+        while (temp != NULL)
         {
-            if (m_temp->data == element)
+            if (temp->data == element)
             {
-                if (m_temp == m_first)
+                if (temp == m_first)
                 {
                     m_first = m_first->next;
                     if (m_first)
                         m_first->prev = NULL;
                 }
-                if (m_temp == m_last)
+                if (temp == m_last)
                 {
                     m_last = m_last->prev;
                     if (m_last)
                         m_last->next = NULL;
                 }
 
-                SAFE_DELETE(m_temp);
+                DeleteElement(temp);
 
                 element = NULL;
 
@@ -155,7 +233,7 @@ public:
                 return;
             }
 
-            m_temp = m_temp->next;
+            temp = temp->next;
         }
     }
 
@@ -166,11 +244,11 @@ public:
     {
         while (m_last != NULL)
         {
-            m_temp = m_last;
+            Element * temp = m_last;
             m_last = m_last->prev;
-            SAFE_DELETE(m_temp);
+            DeleteElement(temp);
         }
-        m_first = m_last = m_iterate = m_temp = NULL;
+        m_first = m_last = m_iterate = NULL;
         m_totalElements = 0;
     }
 
@@ -182,12 +260,12 @@ public:
     {
         while (m_last != NULL)
         {
-            m_temp = m_last;
-            m_temp->data = NULL;
+            Element * temp = m_last;
+            temp->data = NULL;
             m_last = m_last->prev;
-            SAFE_DELETE(m_temp);
+            DeleteElement(temp);
         }
-        m_first = m_last = m_iterate = m_temp = NULL;
+        m_first = m_last = m_iterate = NULL;
         m_totalElements = 0;
     }
 
@@ -197,27 +275,27 @@ public:
     // ----------------------------------------------------------------------
     void ClearPointer(Type * element)
     {
-        m_temp = m_first;
-        while (m_temp != NULL)
+        Element * temp = m_first;
+        while (temp != NULL)
         {
-            if (m_temp->data == element)
+            if (temp->data == element)
             {
-                if (m_temp == m_first)
+                if (temp == m_first)
                 {
                     m_first = m_first->next;
                     if (m_first)
                         m_first->prev = NULL;
                 }
-                if (m_temp == m_last)
+                if (temp == m_last)
                 {
                     m_last = m_last->prev;
                     if (m_last)
                         m_last->next = NULL;
                 }
 
-                m_temp->data = NULL;
+                temp->data = NULL;
 
-                SAFE_DELETE( m_temp );
+                DeleteElement(temp);
 
                 element = NULL;
 
@@ -226,12 +304,43 @@ public:
                 return;
             }
 
-            m_temp = m_temp->next;
+            temp = temp->next;
         }
     }
 
+    // ----------------------------------------------------------------------
+    // Returns iterator on the first element of the list
+    // ----------------------------------------------------------------------
+    Iterator Begin()
+    {
+        return Iterator(m_first);
+    }
+
+    // ----------------------------------------------------------------------
+    // Returns iterator after the last element of the list
+    // ----------------------------------------------------------------------
+    Iterator End()
+    {
+        return Iterator(NULL);
+    }
+
+    // ----------------------------------------------------------------------
+    // Functions for range-for loop: for(Type * element : list)
+    // ----------------------------------------------------------------------
+    Iterator begin()
+    {
+        return Begin();
+    }
+
+    Iterator end()
+    {
+        return End();
+    }
+
     // ----------------------------------------------------------------------
     // Iteration of the each element in the list
+    // Warning: it uses one cursor of the list, therefore it cannot be
+    // used in nested loops (use Iterator for that)
     // ----------------------------------------------------------------------
     Type * Iterate(bool restart = false)
     {
@@ -289,18 +398,18 @@ public:
     // ----------------------------------------------------------------------
     Type * GetNext(Type * element)
     {
-        m_temp = m_first;
-        while (m_temp != NULL)
+        Element * temp = m_first;
+        while (temp != NULL)
         {
-            if (m_temp->data == element)
+            if (temp->data == element)
             {
-                if (m_temp->next == NULL)
+                if (temp->next == NULL)
                     return NULL;
                 else
-                    return m_temp->next->data;
+                    return temp->next->data;
             }
 
-            m_temp = m_temp->next;
+            temp = temp->next;
         }
 
         return NULL;
@@ -318,12 +427,12 @@ public:
 
         unsigned long element = rand() * m_totalElements / RAND_MAX;
 
-        m_temp = m_first;
+        Element * temp = m_first;
         for(unsigned long e = 0; e < element; e++) {
-            m_temp = m_temp->next;
+            temp = temp->next;
         }
 
-        return m_temp->data;
+        return temp->data;
     }
 
     // ----------------------------------------------------------------------
@@ -332,13 +441,13 @@ public:
     // ----------------------------------------------------------------------
     Element * GetCompleteElement(Type * element)
     {
-        m_temp = m_first;
-        while (m_temp != NULL)
+        Element * temp = m_first;
+        while (temp != NULL)
         {
-            if (m_temp->data == element)
-                return m_temp;
+            if (temp->data == element)
+                return temp;
 
-            m_temp = m_temp->next;
+            temp = temp->next;
         }
 
         return NULL;
@@ -354,12 +463,80 @@ public:
 
 private:
 
+    // ----------------------------------------------------------------------
+    // Header of the block of memory for nodes
+    // ----------------------------------------------------------------------
+    struct Slab
+    {
+        Slab * next;    // Next allocated slab
+    };
+
+    // ----------------------------------------------------------------------
+    // Free node of the pool (it uses memory of the deleted element)
+    // ----------------------------------------------------------------------
+    struct FreeNode
+    {
+        FreeNode * next;    // Next free node
+    };
+
+    // ----------------------------------------------------------------------
+    // Creates element from the pool of nodes (allocates new slab of
+    // nodes if there is no free one)
+    // ----------------------------------------------------------------------
+    Element * NewElement(Type * element)
+    {
+        if (m_freeNodes == NULL)
+        {
+            Slab * slab = (Slab *)malloc(sizeof(Slab) + sizeof(Element) * m_slabSize);
+
+            if (slab == NULL) {
+                printf("ERROR: cannot allocate memory for list nodes \n");
+                exit(1);
+            }
+
+            slab->next = m_slabs;
+            m_slabs = slab;
+
+            // Pushes all the nodes of slab in the free list
+            Element * nodes = (Element *)(slab + 1);
+            for(unsigned long i = 0; i < m_slabSize; i++) {
+                FreeNode * node = (FreeNode *)&nodes[i];
+                node->next = m_freeNodes;
+                m_freeNodes = node;
+            }
+
+            if (m_slabSize < 1024) {
+                m_slabSize *= 2;
+            }
+        }
+
+        void * memory = m_freeNodes;
+        m_freeNodes = m_freeNodes->next;
+
+        return new (memory) Element(element);
+    }
+
+    // ----------------------------------------------------------------------
+    // Deletes element (with its data) and returns node in the pool
+    // ----------------------------------------------------------------------
+    void DeleteElement(Element * element)
+    {
+        element->~Element();
+
+        FreeNode * node = (FreeNode *)element;
+        node->next = m_freeNodes;
+        m_freeNodes = node;
+    }
+
     Element * m_first;                  // First element in the linked list
     Element * m_last;                   // Last element in the linked list
     Element * m_iterate;                // Used for iterating the linked list
-    Element * m_temp;                   // Used for temporary storage in various operations
 
     unsigned long m_totalElements;      // Total number of elements in the linked list
+
+    FreeNode * m_freeNodes;             // Free nodes of the pool
+    Slab * m_slabs;                     // Allocated blocks of nodes
+    unsigned long m_slabSize;           // Number of nodes in the next slab
 };
 
 
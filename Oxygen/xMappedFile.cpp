@@ -0,0 +1,137 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 21.02.2018.
+ * Copyright
+ *
+ * Realisation of functions defined in the file
+ * xMappedFile.h. Go there to find more information
+ * and interface specifications
+ */
+
+#include "xEngine.h"
+
+#ifndef _WIN32
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+xMappedFile::xMappedFile()
+{
+    m_data = NULL;
+    m_size = 0;
+    m_isMapped = false;
+    m_isWritable = false;
+}
+
+xMappedFile::~xMappedFile()
+{
+    Close();
+}
+
+bool xMappedFile::Open(const char * filename, bool copy_on_write)
+{
+    Close();
+
+    if (filename == NULL) {
+        return false;
+    }
+
+#ifndef _WIN32
+    int file = open(filename, O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(file, &info) != 0) {
+        close(file);
+        return false;
+    }
+
+    m_size = (unsigned long)info.st_size;
+
+    // Empty file cannot be mapped, but it is opened
+    if (m_size > 0)
+    {
+        int protection = (copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ);
+        void * data = mmap(NULL, m_size, protection, MAP_PRIVATE, file, 0);
+        if (data == MAP_FAILED) {
+            close(file);
+            m_size = 0;
+            return false;
+        }
+
+        // File is read from the start to the end
+        madvise(data, m_size, MADV_SEQUENTIAL);
+
+        m_data = (char *)data;
+    }
+
+    close(file);
+#else
+    // Without mmap the whole file is read in the memory
+    FILE * file = fopen(filename, "rb");
+    if (file == NULL) {
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    m_size = (unsigned long)ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if (m_size > 0)
+    {
+        m_data = (char *)malloc(m_size);
+        if (m_data == NULL || fread(m_data, 1, m_size, file) != m_size) {
+            free(m_data);
+            m_data = NULL;
+            m_size = 0;
+            fclose(file);
+            return false;
+        }
+    }
+
+    fclose(file);
+#endif
+
+    m_isMapped = true;
+    m_isWritable = copy_on_write;
+    return true;
+}
+
+void xMappedFile::Close()
+{
+    if (!m_isMapped) {
+        return;
+    }
+
+#ifndef _WIN32
+    if (m_data != NULL) {
+        munmap(m_data, m_size);
+    }
+#else
+    free(m_data);
+#endif
+
+    m_data = NULL;
+    m_size = 0;
+    m_isMapped = false;
+    m_isWritable = false;
+}
+
+const char * xMappedFile::GetData()
+{
+    return m_data;
+}
+
+char * xMappedFile::GetWritableData()
+{
+    return (m_isWritable ? m_data : NULL);
+}
+
+unsigned long xMappedFile::GetSize()
+{
+    return m_size;
+}
@@ -0,0 +1,78 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 21.02.2018.
+ * Copyright
+ *
+ * xMappedFile maps the whole file in the memory
+ * for reading (mmap), therefore file data can be
+ * parsed directly from the memory without copying
+ * in the buffers and without stdio calls. Pages
+ * are loaded by OS only when they are touched
+ */
+
+#ifndef OXYGEN_XMAPPEDFILE_H
+#define OXYGEN_XMAPPEDFILE_H
+
+#include "xEngine.h"
+
+// ----------------------------------------------------------------------
+// Memory Mapped File Class
+// ----------------------------------------------------------------------
+
+class xMappedFile
+{
+public:
+
+    // ----------------------------------------------------------------------
+    // Creates closed file
+    // ----------------------------------------------------------------------
+    xMappedFile();
+
+    // ----------------------------------------------------------------------
+    // Unmaps file (if it is opened)
+    // ----------------------------------------------------------------------
+    ~xMappedFile();
+
+    // ----------------------------------------------------------------------
+    // Maps the file for reading. If copy_on_write is true, mapped data can
+    // be changed by the process (changes are not written in the file).
+    // Returns false if file cannot be opened
+    // ----------------------------------------------------------------------
+    bool Open(const char * filename, bool copy_on_write = false);
+
+    // ----------------------------------------------------------------------
+    // Unmaps the file
+    // ----------------------------------------------------------------------
+    void Close();
+
+    // ----------------------------------------------------------------------
+    // Returns data of the file (NULL if file is closed or empty)
+    // ----------------------------------------------------------------------
+    const char * GetData();
+
+    // ----------------------------------------------------------------------
+    // Returns data of the file, which can be changed (only for the file
+    // opened with copy_on_write, otherwise NULL)
+    // ----------------------------------------------------------------------
+    char * GetWritableData();
+
+    // ----------------------------------------------------------------------
+    // Returns size of the file (in bytes)
+    // ----------------------------------------------------------------------
+    unsigned long GetSize();
+
+private:
+
+    // Mapped file cannot be copied
+    xMappedFile(const xMappedFile & other);
+    xMappedFile & operator = (const xMappedFile & other);
+
+    char * m_data;              // Mapped memory with data of file
+    unsigned long m_size;       // Size of the file
+    bool m_isMapped;            // Memory is mapped (or allocated, if mmap is not available)
+    bool m_isWritable;          // Pages are copied on write
+
+};
+
+
+#endif //OXYGEN_XMAPPEDFILE_H
@@ -3,7 +3,10 @@
  * Created by Egor Orachyov on 07.02.2018.
  * Copyright
  *
- *
+ * xMaterial keeps lighting parameters of the
+ * material (from .mtl library) and its diffuse
+ * texture, which is shared through the texture
+ * manager (each image is loaded only one time)
  */
 
 #ifndef OXYGEN_XMATERIAL_H
@@ -14,9 +17,18 @@ struct xMaterial
 public:
 
     friend class xModelLoader;
+    friend class xMeshCache;
 
     xMaterial()
     {
+        materialName[0] = '\0';
+        textureName[0] = '\0';
+        texturePath[0] = '\0';
+        m_shininess = 0;
+        m_texture = NULL;
+        m_textureManager = NULL;
+        m_sortId = NextSortId();
+
         m_ambient = new xArray3;
         m_diffuse = new xArray3;
         m_specular = new xArray3;
@@ -25,6 +37,8 @@ public:
 
     ~xMaterial()
     {
+        ReleaseTexture();
+
         SAFE_DELETE(m_ambient);
         SAFE_DELETE(m_diffuse);
         SAFE_DELETE(m_specular);
@@ -32,6 +46,21 @@ public:
     }
 
     void ApplyMaterial()
+    {
+        ApplyColors();
+
+        if (m_texture != NULL && m_texture->GetTextureID() != 0) {
+            glEnable(GL_TEXTURE_2D);
+            glBindTexture(GL_TEXTURE_2D, m_texture->GetTextureID());
+        } else {
+            glDisable(GL_TEXTURE_2D);
+        }
+    }
+
+    // ----------------------------------------------------------------------
+    // Sets lighting parameters of the material (without texture)
+    // ----------------------------------------------------------------------
+    void ApplyColors()
     {
         glMaterialfv(GL_FRONT, GL_AMBIENT, m_ambient->values);
         glMaterialfv(GL_FRONT, GL_DIFFUSE, m_diffuse->values);
@@ -40,6 +69,71 @@ public:
         glMaterialf(GL_FRONT, GL_SHININESS, m_shininess);
     }
 
+    // ----------------------------------------------------------------------
+    // Returns diffuse texture (or NULL, if it is not loaded)
+    // ----------------------------------------------------------------------
+    xTexture * GetTexture()
+    {
+        return m_texture;
+    }
+
+    // ----------------------------------------------------------------------
+    // Returns small unique number of the material for sort keys
+    // ----------------------------------------------------------------------
+    unsigned int GetSortId()
+    {
+        return m_sortId;
+    }
+
+    // ----------------------------------------------------------------------
+    // Sets name and path of diffuse texture (it is loaded by LoadTexture)
+    // ----------------------------------------------------------------------
+    void SetTextureName(const char * name, const char * path)
+    {
+        snprintf(textureName, STRING_SIZE, "%s", name);
+        snprintf(texturePath, STRING_SIZE, "%s", path);
+    }
+
+    // ----------------------------------------------------------------------
+    // Gets diffuse texture from the manager (the same image is shared by
+    // all the materials). Missing file is reported and skipped
+    // ----------------------------------------------------------------------
+    bool LoadTexture(xResourceManager<xTexture> * manager)
+    {
+        if (manager == NULL || textureName[0] == '\0' || m_texture != NULL) {
+            return m_texture != NULL;
+        }
+
+        char filename[2 * STRING_SIZE];
+        snprintf(filename, sizeof(filename), "%s%s", texturePath, textureName);
+
+        // Texture exits the program, if it cannot load the file
+        FILE * file = fopen(filename, "rb");
+        if (file == NULL) {
+            printf("WARNING: Cannot find texture %s of material %s \n", filename, materialName);
+            return false;
+        }
+        fclose(file);
+
+        m_texture = manager->Add(textureName, texturePath);
+        m_textureManager = (m_texture != NULL ? manager : NULL);
+
+        return m_texture != NULL;
+    }
+
+    // ----------------------------------------------------------------------
+    // Returns texture to the manager
+    // ----------------------------------------------------------------------
+    void ReleaseTexture()
+    {
+        if (m_textureManager != NULL) {
+            m_textureManager->Remove(m_texture);
+        }
+
+        m_texture = NULL;
+        m_textureManager = NULL;
+    }
+
     void SetAmbient(float x, float y, float z)
     {
         m_ambient->values[0] = x;
@@ -77,13 +171,28 @@ public:
 
 private:
 
+    // ----------------------------------------------------------------------
+    // Returns the next number of created material
+    // ----------------------------------------------------------------------
+    static unsigned int NextSortId()
+    {
+        static std::atomic<unsigned int> counter(0);
+        return ++counter;
+    }
+
     char materialName[STRING_SIZE];    // Full material name and path
+    char textureName[STRING_SIZE];     // File name of diffuse texture (map_Kd)
+    char texturePath[STRING_SIZE];     // Directory of diffuse texture
     int m_shininess;                   // Material shininess 0..128
     xArray3 * m_ambient;               // Ambient component
     xArray3 * m_diffuse;               // Diffuse component
     xArray3 * m_specular;              // Specular component
     xArray3 * m_emission;              // Emission component
 
+    xTexture * m_texture;                               // Diffuse texture (or NULL)
+    xResourceManager<xTexture> * m_textureManager;      // Owner of the texture
+    unsigned int m_sortId;                              // Number of the material for sort keys
+
 };
 
 #endif //OXYGEN_XMATERIAL_H
@@ -0,0 +1,373 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 22.02.2018.
+ * Copyright
+ *
+ * Realisation of functions defined in the file
+ * xMeshCache.h. Go there to find more information
+ * and interface specifications
+ */
+
+#include "xEngine.h"
+#include <sys/stat.h>
+
+// ----------------------------------------------------------------------
+// Rounds offset up to the alignment of the tables
+// ----------------------------------------------------------------------
+static inline unsigned long long AlignOffset(unsigned long long offset)
+{
+    return (offset + MESH_CACHE_ALIGNMENT - 1) / MESH_CACHE_ALIGNMENT * MESH_CACHE_ALIGNMENT;
+}
+
+// ----------------------------------------------------------------------
+// Writes zero bytes in the file up to the offset
+// ----------------------------------------------------------------------
+static inline bool WritePadding(FILE * file, unsigned long long written, unsigned long long offset)
+{
+    static const char zeros[MESH_CACHE_ALIGNMENT] = {0};
+    return (offset - written == 0 || fwrite(zeros, 1, offset - written, file) == offset - written);
+}
+
+bool xMeshCache::Load(xModel3d * pModel, const char * source, unsigned int flags)
+{
+    unsigned long long size;
+    long long time;
+
+    if (!GetSourceInfo(source, &size, &time)) {
+        return false;
+    }
+
+    char name[STRING_SIZE];
+    GetCacheName(source, name, STRING_SIZE);
+
+    // Objects change their data only after copying, therefore
+    // pages of the file are mapped as copy on write
+    xMappedFile * cache = new xMappedFile;
+    if (!cache->Open(name, true) || cache->GetSize() < sizeof(xMeshCacheHeader)) {
+        SAFE_DELETE(cache);
+        return false;
+    }
+
+    char * data = cache->GetWritableData();
+    xMeshCacheHeader * header = (xMeshCacheHeader *)data;
+
+    unsigned long long offsets[7];
+    GetLayout(*header, offsets);
+
+    bool isValid = (memcmp(header->magic, "OXMC", 4) == 0 &&
+                    header->version == MESH_CACHE_VERSION &&
+                    header->lodSize == sizeof(xObjectLod) &&
+                    header->flags == flags &&
+                    header->sourceSize == size &&
+                    offsets[6] == cache->GetSize());
+
+    // Source was saved again (or copied): its data is compared by hash
+    if (isValid && header->sourceTime != time)
+    {
+        xMappedFile file;
+        isValid = (file.Open(source) && Hash(file.GetData(), file.GetSize()) == header->sourceHash);
+
+        if (isValid) {
+            FILE * update = fopen(name, "r+b");
+            if (update != NULL) {
+                fseek(update, (long)offsetof(xMeshCacheHeader, sourceTime), SEEK_SET);
+                fwrite(&time, sizeof(time), 1, update);
+                fclose(update);
+            }
+        }
+    }
+
+    if (!isValid) {
+        SAFE_DELETE(cache);
+        return false;
+    }
+
+    xMeshCacheObject * objects = (xMeshCacheObject *)(data + offsets[0]);
+    xMeshCacheMaterial * materials = (xMeshCacheMaterial *)(data + offsets[1]);
+    xVertex * unique = (xVertex *)(data + offsets[2]);
+    unsigned char * indices = (unsigned char *)(data + offsets[3]);
+    xObjectLod * lods = (xObjectLod *)(data + offsets[4]);
+    unsigned char * lodIndices = (unsigned char *)(data + offsets[5]);
+
+    // Ranges of objects should be inside the tables
+    for(unsigned int i = 0; i < header->numOfObjects; i++)
+    {
+        xMeshCacheObject & object = objects[i];
+
+        if (object.firstUnique + object.numOfUnique > header->numOfUnique ||
+            (object.indexSize != 0 && object.indexSize != 2 && object.indexSize != 4) ||
+            object.firstIndexByte + object.numOfIndices * object.indexSize > header->numOfIndexBytes ||
+            object.firstLod + object.numOfLods > header->numOfLods ||
+            object.firstLodIndexByte + object.numOfLodIndexBytes > header->numOfLodIndexBytes ||
+            object.materialId >= (long long)header->numOfMaterials) {
+            SAFE_DELETE(cache);
+            return false;
+        }
+
+        // Levels should use indices of the object only
+        for(unsigned long long j = object.firstLod; j < object.firstLod + object.numOfLods; j++) {
+            if (object.indexSize == 0 || lods[j].firstIndex < 0 || lods[j].numOfIndices < 0 ||
+                (unsigned long long)(lods[j].firstIndex + lods[j].numOfIndices) * object.indexSize >
+                object.numOfLodIndexBytes) {
+                SAFE_DELETE(cache);
+                return false;
+            }
+        }
+    }
+
+    long firstMaterial = pModel->num_materials;
+
+    for(unsigned int i = 0; i < header->numOfMaterials; i++)
+    {
+        xMeshCacheMaterial & material = materials[i];
+
+        xMaterial * pMaterial = new xMaterial;
+        pModel->m_materials->Add(pMaterial);
+        pModel->num_materials += 1;
+
+        strncpy(pMaterial->materialName, material.name, STRING_SIZE - 1);
+        pMaterial->materialName[STRING_SIZE - 1] = '\0';
+        material.textureName[STRING_SIZE - 1] = '\0';
+        material.texturePath[STRING_SIZE - 1] = '\0';
+        pMaterial->SetTextureName(material.textureName, material.texturePath);
+        pMaterial->m_shininess = material.shininess;
+        pMaterial->SetAmbient(material.ambient[0], material.ambient[1], material.ambient[2]);
+        pMaterial->SetDiffuse(material.diffuse[0], material.diffuse[1], material.diffuse[2]);
+        pMaterial->SetSpecular(material.specular[0], material.specular[1], material.specular[2]);
+        pMaterial->SetEmission(material.emission[0], material.emission[1], material.emission[2]);
+    }
+
+    for(unsigned int i = 0; i < header->numOfObjects; i++)
+    {
+        xMeshCacheObject & object = objects[i];
+
+        xObject3d * pObject = new xObject3d;
+        pModel->m_objects->Add(pObject);
+        pModel->num_objects += 1;
+
+        pObject->has_normals = (object.hasNormals != 0);
+        pObject->has_texcoords = (object.hasTexcoords != 0);
+        pObject->num_unique = (long)object.numOfUnique;
+        pObject->num_indices = (long)object.numOfIndices;
+        pObject->index_size = (int)object.indexSize;
+        pObject->acmr_before = object.acmrBefore;
+        pObject->acmr_after = object.acmrAfter;
+
+        // Object uses mapped data without copying
+        pObject->m_vertices->Attach(unique + object.firstUnique, pObject->num_unique);
+        pObject->m_indices->Attach(indices + object.firstIndexByte, pObject->num_indices * pObject->index_size);
+
+        pObject->m_center = xVector3(object.center[0], object.center[1], object.center[2]);
+        pObject->m_radius = object.radius;
+        pObject->m_extents = xVector3(object.extents[0], object.extents[1], object.extents[2]);
+        pObject->num_lods = (long)object.numOfLods;
+
+        pObject->m_lods->Attach(lods + object.firstLod, pObject->num_lods);
+        pObject->m_lodIndices->Attach(lodIndices + object.firstLodIndexByte, (long)object.numOfLodIndexBytes);
+
+        pObject->m_MaterialId = (object.materialId >= 0 ? firstMaterial + (long)object.materialId : -1);
+
+        strncpy(pObject->m_name, object.name, STRING_SIZE - 1);
+        pObject->m_name[STRING_SIZE - 1] = '\0';
+    }
+
+    // Model keeps the file mapped while objects exist
+    pModel->m_caches->Add(cache);
+
+    return true;
+}
+
+bool xMeshCache::Save(xModel3d * pModel, long firstObject, long firstMaterial, unsigned int flags,
+                      const char * source, const char * data, unsigned long size)
+{
+    xMeshCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "OXMC", 4);
+
+    header.version = MESH_CACHE_VERSION;
+    header.lodSize = sizeof(xObjectLod);
+    header.flags = flags;
+    header.numOfObjects = (unsigned int)(pModel->num_objects - firstObject);
+    header.numOfMaterials = (unsigned int)(pModel->num_materials - firstMaterial);
+    header.sourceSize = size;
+    header.sourceHash = Hash(data, size);
+
+    unsigned long long sourceSize;
+    if (!GetSourceInfo(source, &sourceSize, &header.sourceTime)) {
+        return false;
+    }
+
+    xValueArray<xMeshCacheObject> objects(header.numOfObjects);
+
+    for(long i = firstObject; i < pModel->num_objects; i++)
+    {
+        xObject3d * pObject = pModel->m_objects->GetElement(i);
+        xMeshCacheObject * object = objects.EmplaceBack();
+
+        object->firstUnique = header.numOfUnique;
+        object->numOfUnique = (unsigned long long)pObject->num_unique;
+        object->firstIndexByte = header.numOfIndexBytes;
+        object->numOfIndices = (unsigned long long)pObject->num_indices;
+        object->indexSize = pObject->index_size;
+        object->hasNormals = (pObject->has_normals ? 1 : 0);
+        object->hasTexcoords = (pObject->has_texcoords ? 1 : 0);
+        object->acmrBefore = pObject->acmr_before;
+        object->acmrAfter = pObject->acmr_after;
+        object->center[0] = pObject->m_center.x;
+        object->center[1] = pObject->m_center.y;
+        object->center[2] = pObject->m_center.z;
+        object->radius = pObject->m_radius;
+        object->extents[0] = pObject->m_extents.x;
+        object->extents[1] = pObject->m_extents.y;
+        object->extents[2] = pObject->m_extents.z;
+        object->firstLod = header.numOfLods;
+        object->numOfLods = (unsigned long long)pObject->num_lods;
+        object->firstLodIndexByte = header.numOfLodIndexBytes;
+        object->numOfLodIndexBytes = (unsigned long long)pObject->m_lodIndices->GetNumOfElements();
+        object->materialId = (pObject->m_MaterialId >= firstMaterial ? pObject->m_MaterialId - firstMaterial : -1);
+        strncpy(object->name, pObject->m_name, STRING_SIZE);
+
+        header.numOfUnique += object->numOfUnique;
+        header.numOfIndexBytes += object->numOfIndices * object->indexSize;
+        header.numOfLods += object->numOfLods;
+        header.numOfLodIndexBytes += object->numOfLodIndexBytes;
+    }
+
+    xValueArray<xMeshCacheMaterial> materials(header.numOfMaterials);
+
+    for(long i = firstMaterial; i < pModel->num_materials; i++)
+    {
+        xMaterial * pMaterial = pModel->m_materials->GetElement(i);
+        xMeshCacheMaterial * material = materials.EmplaceBack();
+
+        strncpy(material->name, pMaterial->materialName, STRING_SIZE);
+        strncpy(material->textureName, pMaterial->textureName, STRING_SIZE);
+        strncpy(material->texturePath, pMaterial->texturePath, STRING_SIZE);
+        material->shininess = pMaterial->m_shininess;
+        memcpy(material->ambient, pMaterial->m_ambient->values, sizeof(material->ambient));
+        memcpy(material->diffuse, pMaterial->m_diffuse->values, sizeof(material->diffuse));
+        memcpy(material->specular, pMaterial->m_specular->values, sizeof(material->specular));
+        memcpy(material->emission, pMaterial->m_emission->values, sizeof(material->emission));
+    }
+
+    unsigned long long offsets[7];
+    GetLayout(header, offsets);
+
+    // File is written under temporary name and renamed after that,
+    // therefore other process never reads half-written cache
+    char name[STRING_SIZE];
+    char temp[STRING_SIZE + 4];
+    GetCacheName(source, name, STRING_SIZE);
+    sprintf(temp, "%s.tmp", name);
+
+    FILE * file = fopen(temp, "wb");
+    if (file == NULL) {
+        printf("WARNING: Cannot write mesh cache %s \n", name);
+        return false;
+    }
+
+    bool isWritten = (fwrite(&header, sizeof(header), 1, file) == 1);
+    unsigned long long written = sizeof(header);
+
+    isWritten = isWritten && WritePadding(file, written, offsets[0]);
+    isWritten = isWritten && fwrite(objects.Data(), sizeof(xMeshCacheObject), header.numOfObjects, file) == header.numOfObjects;
+    written = offsets[0] + sizeof(xMeshCacheObject) * header.numOfObjects;
+
+    isWritten = isWritten && WritePadding(file, written, offsets[1]);
+    isWritten = isWritten && (header.numOfMaterials == 0 ||
+                              fwrite(materials.Data(), sizeof(xMeshCacheMaterial), header.numOfMaterials, file) == header.numOfMaterials);
+    written = offsets[1] + sizeof(xMeshCacheMaterial) * header.numOfMaterials;
+
+    // Data of objects is written one after another (flat tables)
+    for(int table = 0; table < 4; table++)
+    {
+        isWritten = isWritten && WritePadding(file, written, offsets[2 + table]);
+        written = offsets[2 + table];
+
+        for(long i = firstObject; isWritten && i < pModel->num_objects; i++)
+        {
+            xObject3d * pObject = pModel->m_objects->GetElement(i);
+            const void * elements = NULL;
+            unsigned long long count = 0, bytes = 0;
+
+            switch (table)
+            {
+                case 0:
+                    elements = pObject->m_vertices->Data();
+                    count = pObject->num_unique;
+                    bytes = sizeof(xVertex);
+                    break;
+                case 1:
+                    elements = pObject->m_indices->Data();
+                    count = pObject->num_indices * pObject->index_size;
+                    bytes = 1;
+                    break;
+                case 2:
+                    elements = pObject->m_lods->Data();
+                    count = pObject->num_lods;
+                    bytes = sizeof(xObjectLod);
+                    break;
+                default:
+                    elements = pObject->m_lodIndices->Data();
+                    count = pObject->m_lodIndices->GetNumOfElements();
+                    bytes = 1;
+                    break;
+            }
+
+            isWritten = (count == 0 || fwrite(elements, bytes, count, file) == count);
+            written += count * bytes;
+        }
+    }
+
+    isWritten = (fclose(file) == 0) && isWritten;
+
+    if (!isWritten || rename(temp, name) != 0) {
+        printf("WARNING: Cannot write mesh cache %s \n", name);
+        remove(temp);
+        return false;
+    }
+
+    return true;
+}
+
+unsigned long long xMeshCache::Hash(const char * data, unsigned long size)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+
+    for(unsigned long i = 0; i < size; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+bool xMeshCache::GetSourceInfo(const char * source, unsigned long long * size, long long * time)
+{
+    struct stat info;
+
+    if (source == NULL || stat(source, &info) != 0) {
+        return false;
+    }
+
+    *size = (unsigned long long)info.st_size;
+    *time = (long long)info.st_mtime;
+
+    return true;
+}
+
+void xMeshCache::GetCacheName(const char * source, char * name, unsigned long length)
+{
+    snprintf(name, length, "%s%s", source, MESH_CACHE_EXTENSION);
+}
+
+void xMeshCache::GetLayout(const xMeshCacheHeader & header, unsigned long long offsets[7])
+{
+    offsets[0] = AlignOffset(sizeof(xMeshCacheHeader));
+    offsets[1] = AlignOffset(offsets[0] + sizeof(xMeshCacheObject) * (unsigned long long)header.numOfObjects);
+    offsets[2] = AlignOffset(offsets[1] + sizeof(xMeshCacheMaterial) * (unsigned long long)header.numOfMaterials);
+    offsets[3] = AlignOffset(offsets[2] + sizeof(xVertex) * header.numOfUnique);
+    offsets[4] = AlignOffset(offsets[3] + header.numOfIndexBytes);
+    offsets[5] = AlignOffset(offsets[4] + sizeof(xObjectLod) * header.numOfLods);
+    offsets[6] = offsets[5] + header.numOfLodIndexBytes;
+}
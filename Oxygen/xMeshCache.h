@@ -0,0 +1,143 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 22.02.2018.
+ * Copyright
+ *
+ * xMeshCache saves imported model in the binary
+ * file next to the source file (source name +
+ * ".xmc"). File stores flat tables of objects,
+ * materials, interleaved unique vertices, indices
+ * and simplified levels (LOD) of objects with their
+ * indices, which are mapped in the memory and given
+ * to the model without parsing or copying (faces
+ * of the file are not stored, they are released
+ * after indexing). Cache is valid while size and time
+ * of the source are not changed (if only time is
+ * changed, hash of the source is compared)
+ */
+
+#ifndef OXYGEN_XMESHCACHE_H
+#define OXYGEN_XMESHCACHE_H
+
+#include "xEngine.h"
+
+#define MESH_CACHE_VERSION      7       // Increased after each change of the format
+#define MESH_CACHE_EXTENSION    ".xmc"  // Added to the name of the source file
+#define MESH_CACHE_ALIGNMENT    16      // Alignment of the data tables in the file
+
+#define MESH_CACHE_OPTIMIZED    0x1     // Flag: order of triangles is optimized
+#define MESH_CACHE_LODS         0x2     // Flag: simplified levels of objects are built
+
+// ----------------------------------------------------------------------
+// Header in the start of cache file
+// ----------------------------------------------------------------------
+
+struct xMeshCacheHeader
+{
+    char magic[4];                      // "OXMC"
+    unsigned int version;               // MESH_CACHE_VERSION
+    unsigned int lodSize;               // Size of xObjectLod (format depends on size of long)
+    unsigned int numOfObjects;          // Objects in the table
+    unsigned int numOfMaterials;        // Materials in the table
+    unsigned int flags;                 // Import options (MESH_CACHE_OPTIMIZED, MESH_CACHE_LODS)
+    unsigned long long sourceSize;      // Size of the source file
+    long long sourceTime;               // Modification time of the source file
+    unsigned long long sourceHash;      // FNV-1a hash of the source file
+    unsigned long long numOfUnique;     // Unique vertices of all the objects
+    unsigned long long numOfIndexBytes; // Size of index buffers of all the objects
+    unsigned long long numOfLods;       // Simplified levels of all the objects
+    unsigned long long numOfLodIndexBytes;  // Size of index buffers of all the levels
+};
+
+// ----------------------------------------------------------------------
+// Object in the cache (ranges in the flat tables)
+// ----------------------------------------------------------------------
+
+struct xMeshCacheObject
+{
+    unsigned long long firstUnique;
+    unsigned long long numOfUnique;
+    unsigned long long firstIndexByte;
+    unsigned long long numOfIndices;
+    long long indexSize;                // Size of one index (0 - object is not indexed)
+    int hasNormals;                     // Unique vertices have normals
+    int hasTexcoords;                   // Unique vertices have texture coordinates
+    float acmrBefore;                   // ACMR of the file order of triangles
+    float acmrAfter;                    // ACMR of the optimized order of triangles
+    float center[3];                    // Center of bounding sphere
+    float radius;                       // Radius of bounding sphere
+    float extents[3];                   // Half sizes of bounding box (with center of sphere)
+    unsigned long long firstLod;
+    unsigned long long numOfLods;
+    unsigned long long firstLodIndexByte;
+    unsigned long long numOfLodIndexBytes;
+    long long materialId;               // Index in the material table (or -1)
+    char name[STRING_SIZE];             // Object name
+};
+
+// ----------------------------------------------------------------------
+// Material in the cache
+// ----------------------------------------------------------------------
+
+struct xMeshCacheMaterial
+{
+    char name[STRING_SIZE];
+    char textureName[STRING_SIZE];      // Diffuse texture (loaded after the cache)
+    char texturePath[STRING_SIZE];
+    int shininess;
+    float ambient[3];
+    float diffuse[3];
+    float specular[3];
+    float emission[3];
+};
+
+// ----------------------------------------------------------------------
+// Binary Mesh Cache Class
+// ----------------------------------------------------------------------
+
+class xMeshCache
+{
+public:
+
+    // ----------------------------------------------------------------------
+    // Loads objects and materials of the source file from its cache and adds
+    // them in the model. Returns false, if cache does not exist, is not valid
+    // or was saved with other import flags
+    // ----------------------------------------------------------------------
+    bool Load(xModel3d * pModel, const char * source, unsigned int flags);
+
+    // ----------------------------------------------------------------------
+    // Saves objects and materials of the model (starting from first ones)
+    // in the cache of the source file with given data
+    // ----------------------------------------------------------------------
+    bool Save(xModel3d * pModel, long firstObject, long firstMaterial, unsigned int flags,
+              const char * source, const char * data, unsigned long size);
+
+    // ----------------------------------------------------------------------
+    // Returns FNV-1a hash of the data
+    // ----------------------------------------------------------------------
+    static unsigned long long Hash(const char * data, unsigned long size);
+
+private:
+
+    // ----------------------------------------------------------------------
+    // Returns size and modification time of the file
+    // ----------------------------------------------------------------------
+    bool GetSourceInfo(const char * source, unsigned long long * size, long long * time);
+
+    // ----------------------------------------------------------------------
+    // Writes cache name for the source in the buffer
+    // ----------------------------------------------------------------------
+    void GetCacheName(const char * source, char * name, unsigned long length);
+
+    // ----------------------------------------------------------------------
+    // Returns offsets of the tables in the file with such header
+    // (0 - objects, 1 - materials, 2 - unique vertices, 3 - indices,
+    // 4 - levels, 5 - indices of levels, 6 - end of file)
+    // ----------------------------------------------------------------------
+    void GetLayout(const xMeshCacheHeader & header, unsigned long long offsets[7]);
+
+};
+
+
+#endif //OXYGEN_XMESHCACHE_H
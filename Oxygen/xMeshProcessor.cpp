@@ -0,0 +1,1247 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 23.02.2018.
+ * Copyright
+ *
+ * Realisation of functions defined in the file
+ * xMeshProcessor.h. Go there to find more information
+ * and interface specifications
+ */
+
+#include "xEngine.h"
+
+// Empty slot of the table of unique vertices
+#define MESH_EMPTY_SLOT 0xffffffff
+
+// ----------------------------------------------------------------------
+// Cluster of triangles with its key for sorting
+// ----------------------------------------------------------------------
+struct xMeshCluster
+{
+    float key;                  // Cluster with bigger key is drawn earlier
+    unsigned int start;         // First triangle of the cluster
+    unsigned int end;           // Triangle after the last one
+};
+
+// ----------------------------------------------------------------------
+// Compares clusters for sorting (bigger key first)
+// ----------------------------------------------------------------------
+static bool CompareClusters(const xMeshCluster & a, const xMeshCluster & b)
+{
+    return a.key > b.key;
+}
+
+// ----------------------------------------------------------------------
+// Edge collapse (vertex from is moved in vertex to) with its error
+// ----------------------------------------------------------------------
+struct xMeshCollapse
+{
+    double cost;                // Error of the quadrics in the new position
+    unsigned int from;          // Removed position
+    unsigned int to;            // Kept position
+};
+
+// ----------------------------------------------------------------------
+// Compares collapses for sorting (smaller error first)
+// ----------------------------------------------------------------------
+static bool CompareCollapses(const xMeshCollapse & a, const xMeshCollapse & b)
+{
+    return a.cost < b.cost;
+}
+
+// ----------------------------------------------------------------------
+// Adds plane (n - unit normal, d - offset) with weight in the quadric
+// ----------------------------------------------------------------------
+static void AddPlane(xQuadric & q, double nx, double ny, double nz, double d, double weight)
+{
+    q.a00 += weight * nx * nx;
+    q.a01 += weight * nx * ny;
+    q.a02 += weight * nx * nz;
+    q.a11 += weight * ny * ny;
+    q.a12 += weight * ny * nz;
+    q.a22 += weight * nz * nz;
+    q.b0 += weight * nx * d;
+    q.b1 += weight * ny * d;
+    q.b2 += weight * nz * d;
+    q.c += weight * d * d;
+}
+
+// ----------------------------------------------------------------------
+// Returns sum of squared distances from the point to planes of quadrics
+// ----------------------------------------------------------------------
+static double QuadricError(const xQuadric & a, const xQuadric & b, const float * p)
+{
+    double x = p[0], y = p[1], z = p[2];
+
+    double a00 = a.a00 + b.a00, a01 = a.a01 + b.a01, a02 = a.a02 + b.a02;
+    double a11 = a.a11 + b.a11, a12 = a.a12 + b.a12, a22 = a.a22 + b.a22;
+
+    double error = x * (a00 * x + a01 * y + a02 * z) +
+                   y * (a01 * x + a11 * y + a12 * z) +
+                   z * (a02 * x + a12 * y + a22 * z) +
+                   2.0 * (x * (a.b0 + b.b0) + y * (a.b1 + b.b1) + z * (a.b2 + b.b2)) +
+                   a.c + b.c;
+
+    return (error > 0.0 ? error : 0.0);
+}
+
+// ----------------------------------------------------------------------
+// Returns not normalized normal of triangle
+// ----------------------------------------------------------------------
+static inline xVector3 TriangleNormal(const float * p0, const float * p1, const float * p2)
+{
+    xVector3 e1(p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]);
+    xVector3 e2(p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]);
+
+    return xVector3(e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x);
+}
+
+// ----------------------------------------------------------------------
+// Score of vertex for Forsyth ordering by its position in LRU cache
+// (-1 - not in cache) and by number of not emitted triangles
+// ----------------------------------------------------------------------
+static inline float ForsythScore(int cachePosition, unsigned int numOfLive)
+{
+    if (numOfLive == 0) {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+
+    // Vertices of the last triangle have fixed score (triangle
+    // with them would not be better than other cached ones)
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            score = 0.75f;
+        } else {
+            float scale = 1.0f / (MESH_FORSYTH_CACHE_SIZE - 3);
+            score = powf(1.0f - (cachePosition - 3) * scale, 1.5f);
+        }
+    }
+
+    // Vertices with few triangles left are finished first
+    score += 2.0f * powf((float)numOfLive, -0.5f);
+
+    return score;
+}
+
+xMeshProcessor::xMeshProcessor()
+{
+    m_numOfCorners = 0;
+    m_numOfUnique = 0;
+    m_numOfTriangles = 0;
+    m_missesBefore = 0.0;
+    m_missesAfter = 0.0;
+    memset(&m_compression, 0, sizeof(m_compression));
+    m_nextFace = 0;
+}
+
+void xMeshProcessor::BuildIndexed(xObject3d * pObject)
+{
+    BeginIndexed(pObject);
+    IndexFaces(pObject, pObject->num_faces);
+}
+
+void xMeshProcessor::BeginIndexed(xObject3d * pObject)
+{
+    long numOfCorners = pObject->num_faces * 3;
+
+    // Table is at most half full (size is power of 2)
+    unsigned long numOfSlots = 16;
+    while (numOfSlots < (unsigned long)numOfCorners * 2) {
+        numOfSlots *= 2;
+    }
+
+    m_table.Resize(numOfSlots);
+    memset(m_table.Data(), 0xff, sizeof(unsigned int) * numOfSlots);
+
+    m_keys.Clear();
+    m_indices.Clear();
+    m_indices.Reserve(numOfCorners);
+    m_nextFace = 0;
+
+    pObject->m_vertices->Clear();
+}
+
+bool xMeshProcessor::IndexFaces(xObject3d * pObject, long numOfFaces)
+{
+    long lastFace = (numOfFaces < pObject->num_faces - m_nextFace ? m_nextFace + numOfFaces : pObject->num_faces);
+
+    xFace * faces = pObject->m_faces->Data();
+    unsigned int * table = m_table.Data();
+    unsigned long mask = m_table.GetNumOfElements() - 1;
+
+    for(long i = m_nextFace; i < lastFace; i++)
+    {
+        for(int j = 0; j < 3; j++)
+        {
+            long v = faces[i].vertex[j];
+            long t = faces[i].texture[j];
+            long n = faces[i].normal[j];
+
+            unsigned long slot = (unsigned long)HashTriple(v, t, n) & mask;
+            unsigned int unique = table[slot];
+
+            while (unique != MESH_EMPTY_SLOT)
+            {
+                long * key = &m_keys[3 * (long)unique];
+                if (key[0] == v && key[1] == t && key[2] == n) {
+                    break;
+                }
+
+                slot = (slot + 1) & mask;
+                unique = table[slot];
+            }
+
+            if (unique == MESH_EMPTY_SLOT)
+            {
+                unique = (unsigned int)pObject->m_vertices->GetNumOfElements();
+                table[slot] = unique;
+
+                m_keys.Add(v);
+                m_keys.Add(t);
+                m_keys.Add(n);
+
+                // Missing attributes (object without texture coordinates
+                // or normals) are zero
+                xVertex * vertex = pObject->m_vertices->EmplaceBack();
+
+                if (v >= 0 && v < pObject->num_vertexes) {
+                    xPoint3 & p = (*pObject->m_vertexes)[v];
+                    vertex->position[0] = p.x;
+                    vertex->position[1] = p.y;
+                    vertex->position[2] = p.z;
+                }
+
+                if (n >= 0 && n < pObject->num_normals) {
+                    xPoint3 & p = (*pObject->m_normals)[n];
+                    vertex->normal[0] = p.x;
+                    vertex->normal[1] = p.y;
+                    vertex->normal[2] = p.z;
+                }
+
+                if (t >= 0 && t < pObject->num_textcords) {
+                    xPoint2 & p = (*pObject->m_textcords)[t];
+                    vertex->texcoord[0] = p.x;
+                    vertex->texcoord[1] = p.y;
+                }
+            }
+
+            m_indices.Add(unique);
+        }
+    }
+
+    m_nextFace = lastFace;
+    if (m_nextFace < pObject->num_faces) {
+        return false;
+    }
+
+    long numOfCorners = pObject->num_faces * 3;
+
+    pObject->num_unique = pObject->m_vertices->GetNumOfElements();
+    pObject->num_indices = numOfCorners;
+    pObject->index_size = (pObject->num_unique <= 0x10000 ? 2 : 4);
+
+    // Indices are packed in the buffer of needed size
+    pObject->m_indices->Resize(numOfCorners * pObject->index_size);
+
+    if (pObject->index_size == 2) {
+        unsigned short * indices = (unsigned short *)pObject->m_indices->Data();
+        for(long i = 0; i < numOfCorners; i++) {
+            indices[i] = (unsigned short)m_indices[i];
+        }
+    } else {
+        memcpy(pObject->m_indices->Data(), m_indices.Data(), sizeof(unsigned int) * numOfCorners);
+    }
+
+    pObject->acmr_before = (float)GetACMR(pObject);
+    pObject->acmr_after = pObject->acmr_before;
+
+    BuildBounds(pObject);
+
+    // Object is drawn only by indices, therefore faces and float
+    // vertices are not needed after that
+    pObject->has_normals = (pObject->num_normals > 0);
+    pObject->has_texcoords = (pObject->num_textcords > 0);
+
+    pObject->m_vertexes->EmptyMass();
+    pObject->m_textcords->EmptyMass();
+    pObject->m_normals->EmptyMass();
+    pObject->m_faces->EmptyMass();
+
+    pObject->num_vertexes = 0;
+    pObject->num_textcords = 0;
+    pObject->num_normals = 0;
+    pObject->num_faces = 0;
+
+    m_numOfCorners += numOfCorners;
+    m_numOfUnique += pObject->num_unique;
+
+    return true;
+}
+
+void xMeshProcessor::OptimizeOrder(xObject3d * pObject)
+{
+    long numOfTriangles = pObject->num_indices / 3;
+    if (pObject->index_size == 0 || numOfTriangles == 0) {
+        return;
+    }
+
+    m_indices.Resize(pObject->num_indices);
+    for(long i = 0; i < pObject->num_indices; i++) {
+        m_indices[i] = pObject->GetIndex(i);
+    }
+
+    unsigned long before = SimulateCache(pObject->num_unique, NULL);
+
+    // Vertex cache order, then clusters of it are sorted
+    OrderForsyth(pObject->num_unique);
+
+    m_table.Resize(pObject->num_indices);
+    for(long i = 0; i < numOfTriangles; i++) {
+        for(int j = 0; j < 3; j++) {
+            m_table[3 * i + j] = m_indices[3 * (long)m_order[i] + j];
+        }
+    }
+    m_indices.Swap(m_table);
+
+    SortClusters(pObject);
+
+    unsigned long after = SimulateCache(pObject->num_unique, NULL);
+
+    if (pObject->index_size == 2) {
+        unsigned short * indices = (unsigned short *)pObject->m_indices->Data();
+        for(long i = 0; i < pObject->num_indices; i++) {
+            indices[i] = (unsigned short)m_indices[i];
+        }
+    } else {
+        memcpy(pObject->m_indices->Data(), m_indices.Data(), sizeof(unsigned int) * pObject->num_indices);
+    }
+
+    pObject->acmr_before = (float)before / numOfTriangles;
+    pObject->acmr_after = (float)after / numOfTriangles;
+
+    m_numOfTriangles += numOfTriangles;
+    m_missesBefore += before;
+    m_missesAfter += after;
+}
+
+double xMeshProcessor::GetACMR(xObject3d * pObject)
+{
+    long numOfTriangles = pObject->num_indices / 3;
+    if (pObject->index_size == 0 || numOfTriangles == 0) {
+        return 0.0;
+    }
+
+    m_indices.Resize(pObject->num_indices);
+    for(long i = 0; i < pObject->num_indices; i++) {
+        m_indices[i] = pObject->GetIndex(i);
+    }
+
+    return (double)SimulateCache(pObject->num_unique, NULL) / numOfTriangles;
+}
+
+void xMeshProcessor::BuildLods(xObject3d * pObject)
+{
+    pObject->num_lods = 0;
+    pObject->m_lods->Clear();
+    pObject->m_lodIndices->Clear();
+
+    long numOfTriangles = pObject->num_indices / 3;
+    if (pObject->index_size == 0 || numOfTriangles == 0) {
+        return;
+    }
+
+    xVertex * vertices = pObject->m_vertices->Data();
+    long numOfUnique = pObject->num_unique;
+
+    // Vertices with the same position (but other normal or texture
+    // coordinates) are welded: edges are collapsed between positions
+    unsigned long numOfSlots = 16;
+    while (numOfSlots < (unsigned long)numOfUnique * 2) {
+        numOfSlots *= 2;
+    }
+
+    m_table.Resize(numOfSlots);
+    memset(m_table.Data(), 0xff, sizeof(unsigned int) * numOfSlots);
+
+    unsigned int * table = m_table.Data();
+    unsigned long mask = numOfSlots - 1;
+
+    xValueArray<unsigned int> firstWedges;
+    m_positions.Resize(numOfUnique);
+
+    for(long i = 0; i < numOfUnique; i++)
+    {
+        float * p = vertices[i].position;
+        unsigned int bits[3];
+        memcpy(bits, p, sizeof(bits));
+
+        unsigned long slot = (unsigned long)HashTriple(bits[0], bits[1], bits[2]) & mask;
+        unsigned int position = table[slot];
+
+        while (position != MESH_EMPTY_SLOT)
+        {
+            if (memcmp(vertices[firstWedges[position]].position, p, sizeof(float) * 3) == 0) {
+                break;
+            }
+
+            slot = (slot + 1) & mask;
+            position = table[slot];
+        }
+
+        if (position == MESH_EMPTY_SLOT) {
+            position = (unsigned int)firstWedges.GetNumOfElements();
+            table[slot] = position;
+            firstWedges.Add((unsigned int)i);
+        }
+
+        m_positions[i] = position;
+    }
+
+    long numOfPositions = firstWedges.GetNumOfElements();
+
+    m_wedgeOffsets.Clear();
+    m_wedgeOffsets.Resize(numOfPositions + 1);
+    m_wedges.Resize(numOfUnique);
+
+    for(long i = 0; i < numOfUnique; i++) {
+        m_wedgeOffsets[m_positions[i] + 1] += 1;
+    }
+    for(long p = 0; p < numOfPositions; p++) {
+        m_wedgeOffsets[p + 1] += m_wedgeOffsets[p];
+    }
+
+    firstWedges.Clear();
+    firstWedges.Resize(numOfPositions);
+    for(long i = 0; i < numOfUnique; i++) {
+        unsigned int p = m_positions[i];
+        m_wedges[m_wedgeOffsets[p] + firstWedges[p]] = (unsigned int)i;
+        firstWedges[p] += 1;
+    }
+
+    m_indices.Resize(pObject->num_indices);
+    for(long i = 0; i < pObject->num_indices; i++) {
+        m_indices[i] = pObject->GetIndex(i);
+    }
+
+    // Quadric of each position is the sum of planes of its triangles and
+    // of planes through the border edges (perpendicular to the triangles)
+    m_quadrics.Clear();
+    m_quadrics.Resize(numOfPositions);
+
+    xValueArray<unsigned long long> edges(numOfTriangles * 3);
+
+    for(long i = 0; i < numOfTriangles; i++)
+    {
+        float * p0 = vertices[m_indices[3 * i]].position;
+        float * p1 = vertices[m_indices[3 * i + 1]].position;
+        float * p2 = vertices[m_indices[3 * i + 2]].position;
+
+        xVector3 n = TriangleNormal(p0, p1, p2);
+        double length = sqrt((double)n.x * n.x + (double)n.y * n.y + (double)n.z * n.z);
+        if (length == 0.0) {
+            continue;
+        }
+
+        double nx = n.x / length, ny = n.y / length, nz = n.z / length;
+        double d = -(nx * p0[0] + ny * p0[1] + nz * p0[2]);
+
+        for(int j = 0; j < 3; j++) {
+            unsigned int a = m_positions[m_indices[3 * i + j]];
+            unsigned int b = m_positions[m_indices[3 * i + (j + 1) % 3]];
+
+            AddPlane(m_quadrics[a], nx, ny, nz, d, 1.0);
+            edges.Add(a < b ? ((unsigned long long)a << 32) | b : ((unsigned long long)b << 32) | a);
+        }
+    }
+
+    std::sort(edges.Data(), edges.Data() + edges.GetNumOfElements());
+
+    for(long i = 0; i < numOfTriangles; i++)
+    {
+        float * p[3] = { vertices[m_indices[3 * i]].position, vertices[m_indices[3 * i + 1]].position,
+                         vertices[m_indices[3 * i + 2]].position };
+
+        xVector3 n = TriangleNormal(p[0], p[1], p[2]);
+
+        for(int j = 0; j < 3; j++)
+        {
+            unsigned int a = m_positions[m_indices[3 * i + j]];
+            unsigned int b = m_positions[m_indices[3 * i + (j + 1) % 3]];
+            unsigned long long key = (a < b ? ((unsigned long long)a << 32) | b : ((unsigned long long)b << 32) | a);
+
+            // Border edge is used by one triangle only
+            unsigned long long * edge = std::lower_bound(edges.Data(), edges.Data() + edges.GetNumOfElements(), key);
+            bool isBorder = ((edge + 1 == edges.Data() + edges.GetNumOfElements() || edge[1] != key) &&
+                             (edge == edges.Data() || edge[-1] != key));
+            if (!isBorder) {
+                continue;
+            }
+
+            float * p0 = p[j];
+            float * p1 = p[(j + 1) % 3];
+            xVector3 e(p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]);
+            xVector3 b3(e.y * n.z - e.z * n.y, e.z * n.x - e.x * n.z, e.x * n.y - e.y * n.x);
+
+            double length = sqrt((double)b3.x * b3.x + (double)b3.y * b3.y + (double)b3.z * b3.z);
+            if (length == 0.0) {
+                continue;
+            }
+
+            double nx = b3.x / length, ny = b3.y / length, nz = b3.z / length;
+            double d = -(nx * p0[0] + ny * p0[1] + nz * p0[2]);
+
+            AddPlane(m_quadrics[a], nx, ny, nz, d, MESH_BORDER_WEIGHT);
+            AddPlane(m_quadrics[b], nx, ny, nz, d, MESH_BORDER_WEIGHT);
+        }
+    }
+
+    // Each level is simplified from the previous one
+    long lastTriangles = numOfTriangles;
+    double error = 0.0;
+
+    for(long level = 0; level < MESH_MAX_LODS; level++)
+    {
+        long target = (long)(lastTriangles * MESH_LOD_REDUCTION);
+        double levelError = Simplify(pObject, target);
+        long levelTriangles = m_indices.GetNumOfElements() / 3;
+
+        // Level, which is almost the same as the previous one, is not useful
+        if (levelTriangles == 0 || levelTriangles > lastTriangles * 0.9) {
+            break;
+        }
+
+        error = (levelError > error ? levelError : error);
+
+        // Order of triangles of level is optimized for vertex cache too
+        OrderForsyth(numOfUnique);
+
+        xObjectLod * lod = pObject->m_lods->EmplaceBack();
+        lod->firstIndex = pObject->m_lodIndices->GetNumOfElements() / pObject->index_size;
+        lod->numOfIndices = levelTriangles * 3;
+        lod->error = (float)error;
+
+        pObject->m_lodIndices->Resize((lod->firstIndex + lod->numOfIndices) * pObject->index_size);
+
+        if (pObject->index_size == 2) {
+            unsigned short * indices = (unsigned short *)pObject->m_lodIndices->Data() + lod->firstIndex;
+            for(long i = 0; i < levelTriangles; i++) {
+                for(int j = 0; j < 3; j++) {
+                    indices[3 * i + j] = (unsigned short)m_indices[3 * (long)m_order[i] + j];
+                }
+            }
+        } else {
+            unsigned int * indices = (unsigned int *)pObject->m_lodIndices->Data() + lod->firstIndex;
+            for(long i = 0; i < levelTriangles; i++) {
+                for(int j = 0; j < 3; j++) {
+                    indices[3 * i + j] = m_indices[3 * (long)m_order[i] + j];
+                }
+            }
+        }
+
+        pObject->num_lods += 1;
+        lastTriangles = levelTriangles;
+    }
+}
+
+void xMeshProcessor::Compress(xObject3d * pObject)
+{
+    if (pObject->is_compressed || pObject->index_size == 0) {
+        return;
+    }
+
+    long numOfUnique = pObject->num_unique;
+    xVertex * vertices = pObject->m_vertices->Data();
+
+    // Positions are fractions of the bounding box
+    float min[3] = {0.0f, 0.0f, 0.0f};
+    float max[3] = {0.0f, 0.0f, 0.0f};
+
+    for(long i = 0; i < numOfUnique; i++) {
+        for(int k = 0; k < 3; k++) {
+            float value = vertices[i].position[k];
+            min[k] = (i == 0 || value < min[k] ? value : min[k]);
+            max[k] = (i == 0 || value > max[k] ? value : max[k]);
+        }
+    }
+
+    for(int k = 0; k < 3; k++) {
+        pObject->m_boundsMin[k] = min[k];
+        pObject->m_boundsScale[k] = (max[k] - min[k]) / 65535.0f;
+    }
+
+    pObject->m_packed->Resize(numOfUnique);
+    xPackedVertex * packed = pObject->m_packed->Data();
+
+    for(long i = 0; i < numOfUnique; i++)
+    {
+        packed[i].Pack(vertices[i], pObject->m_boundsMin, pObject->m_boundsScale);
+
+        // Errors are measured by decompressed vertex
+        xVertex result;
+        packed[i].Unpack(pObject->m_boundsMin, pObject->m_boundsScale, &result);
+
+        for(int k = 0; k < 3; k++) {
+            float error = fabsf(result.position[k] - vertices[i].position[k]);
+            m_compression.positionError = (error > m_compression.positionError ? error : m_compression.positionError);
+        }
+
+        for(int k = 0; k < 2; k++) {
+            float error = fabsf(result.texcoord[k] - vertices[i].texcoord[k]);
+            m_compression.texcoordError = (error > m_compression.texcoordError ? error : m_compression.texcoordError);
+        }
+
+        float * n = vertices[i].normal;
+        float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+        if (length > 0.0f) {
+            float cosine = (n[0] * result.normal[0] + n[1] * result.normal[1] + n[2] * result.normal[2]) / length;
+            cosine = (cosine > 1.0f ? 1.0f : cosine);
+
+            float error = acosf(cosine) * (float)(180.0 / 3.14159265358979);
+            m_compression.normalError = (error > m_compression.normalError ? error : m_compression.normalError);
+        }
+    }
+
+    // Object keeps only compressed vertices and indices (indices are
+    // copied from the mapped cache, therefore it can be closed)
+    pObject->m_vertices->EmptyMass();
+
+    pObject->m_indices->Detach();
+    pObject->m_lods->Detach();
+    pObject->m_lodIndices->Detach();
+
+    pObject->is_compressed = true;
+
+    // Indexed data is compared (faces and float vertices of the file
+    // are released by indexing)
+    unsigned long indices = pObject->m_indices->GetNumOfElements() + pObject->m_lodIndices->GetNumOfElements();
+    m_compression.bytesBefore += sizeof(xVertex) * numOfUnique + indices;
+    m_compression.bytesAfter += sizeof(xPackedVertex) * numOfUnique + indices;
+}
+
+xCompressionReport xMeshProcessor::GetCompressionReport()
+{
+    return m_compression;
+}
+
+unsigned long xMeshProcessor::GetNumOfCorners()
+{
+    return m_numOfCorners;
+}
+
+unsigned long xMeshProcessor::GetNumOfUnique()
+{
+    return m_numOfUnique;
+}
+
+double xMeshProcessor::GetDedupRatio()
+{
+    return (m_numOfUnique > 0 ? (double)m_numOfCorners / m_numOfUnique : 1.0);
+}
+
+double xMeshProcessor::GetACMRBefore()
+{
+    return (m_numOfTriangles > 0 ? m_missesBefore / m_numOfTriangles : 0.0);
+}
+
+double xMeshProcessor::GetACMRAfter()
+{
+    return (m_numOfTriangles > 0 ? m_missesAfter / m_numOfTriangles : 0.0);
+}
+
+void xMeshProcessor::ResetStats()
+{
+    m_numOfCorners = 0;
+    m_numOfUnique = 0;
+    m_numOfTriangles = 0;
+    m_missesBefore = 0.0;
+    m_missesAfter = 0.0;
+    memset(&m_compression, 0, sizeof(m_compression));
+}
+
+unsigned long long xMeshProcessor::HashTriple(long v, long t, long n)
+{
+    unsigned long long hash = (unsigned long long)v * 0x9E3779B97F4A7C15ULL;
+    hash ^= (unsigned long long)t * 0xC2B2AE3D27D4EB4FULL;
+    hash ^= (unsigned long long)n * 0x165667B19E3779F9ULL;
+
+    return hash ^ (hash >> 29);
+}
+
+unsigned long xMeshProcessor::SimulateCache(long numOfUnique, unsigned char * misses)
+{
+    // Vertex is in the cache, if less than cache size vertices
+    // were added in the cache after it
+    xValueArray<unsigned long> stamps;
+    stamps.Resize(numOfUnique);
+
+    unsigned long time = MESH_FIFO_CACHE_SIZE + 1;
+    unsigned long numOfMisses = 0;
+    long numOfTriangles = m_indices.GetNumOfElements() / 3;
+
+    for(long i = 0; i < numOfTriangles; i++)
+    {
+        unsigned char triangleMisses = 0;
+
+        for(int j = 0; j < 3; j++) {
+            unsigned int v = m_indices[3 * i + j];
+
+            if (time - stamps[v] > MESH_FIFO_CACHE_SIZE) {
+                stamps[v] = time;
+                time += 1;
+                triangleMisses += 1;
+            }
+        }
+
+        if (misses != NULL) {
+            misses[i] = triangleMisses;
+        }
+
+        numOfMisses += triangleMisses;
+    }
+
+    return numOfMisses;
+}
+
+void xMeshProcessor::OrderForsyth(long numOfUnique)
+{
+    long numOfTriangles = m_indices.GetNumOfElements() / 3;
+    unsigned int * indices = m_indices.Data();
+
+    // Not emitted triangles of each vertex (in one array)
+    xValueArray<unsigned int> numOfLive;
+    xValueArray<unsigned int> offsets;
+    xValueArray<unsigned int> triangles;
+
+    numOfLive.Resize(numOfUnique);
+    offsets.Resize(numOfUnique + 1);
+    triangles.Resize(numOfTriangles * 3);
+
+    for(long i = 0; i < numOfTriangles * 3; i++) {
+        numOfLive[indices[i]] += 1;
+    }
+
+    for(long v = 0; v < numOfUnique; v++) {
+        offsets[v + 1] = offsets[v] + numOfLive[v];
+        numOfLive[v] = 0;
+    }
+
+    for(long i = 0; i < numOfTriangles * 3; i++) {
+        unsigned int v = indices[i];
+        triangles[offsets[v] + numOfLive[v]] = (unsigned int)(i / 3);
+        numOfLive[v] += 1;
+    }
+
+    xValueArray<int> cachePositions;
+    xValueArray<float> vertexScores;
+    xValueArray<float> triangleScores;
+    xValueArray<unsigned char> isEmitted;
+
+    cachePositions.Resize(numOfUnique);
+    vertexScores.Resize(numOfUnique);
+    triangleScores.Resize(numOfTriangles);
+    isEmitted.Resize(numOfTriangles);
+
+    for(long v = 0; v < numOfUnique; v++) {
+        cachePositions[v] = -1;
+        vertexScores[v] = ForsythScore(-1, numOfLive[v]);
+    }
+
+    for(long i = 0; i < numOfTriangles; i++) {
+        triangleScores[i] = vertexScores[indices[3 * i]] + vertexScores[indices[3 * i + 1]] +
+                            vertexScores[indices[3 * i + 2]];
+    }
+
+    unsigned int cache[MESH_FORSYTH_CACHE_SIZE + 3];
+    unsigned int newCache[MESH_FORSYTH_CACHE_SIZE + 3];
+    int cacheSize = 0;
+
+    long best = -1;
+    long cursor = 0;
+
+    m_order.Clear();
+    m_order.Reserve(numOfTriangles);
+
+    for(long n = 0; n < numOfTriangles; n++)
+    {
+        // No triangles in the cache: next triangle of the input
+        if (best < 0) {
+            while (isEmitted[cursor]) {
+                cursor += 1;
+            }
+            best = cursor;
+        }
+
+        m_order.Add((unsigned int)best);
+        isEmitted[best] = 1;
+
+        unsigned int * corners = &indices[3 * best];
+        int newCacheSize = 0;
+
+        for(int j = 0; j < 3; j++)
+        {
+            unsigned int v = corners[j];
+
+            // Removes the triangle from not emitted ones of the vertex
+            unsigned int * list = &triangles[offsets[v]];
+            for(unsigned int k = 0; k < numOfLive[v]; k++) {
+                if (list[k] == (unsigned int)best) {
+                    list[k] = list[numOfLive[v] - 1];
+                    numOfLive[v] -= 1;
+                    break;
+                }
+            }
+
+            if (cachePositions[v] != -2) {
+                newCache[newCacheSize] = v;
+                newCacheSize += 1;
+                cachePositions[v] = -2;
+            }
+        }
+
+        // Other vertices of the cache are moved after the triangle vertices
+        for(int i = 0; i < cacheSize; i++) {
+            unsigned int v = cache[i];
+            if (cachePositions[v] != -2) {
+                newCache[newCacheSize] = v;
+                newCacheSize += 1;
+            }
+        }
+
+        for(int i = 0; i < newCacheSize; i++)
+        {
+            unsigned int v = newCache[i];
+            int position = (i < MESH_FORSYTH_CACHE_SIZE ? i : -1);
+
+            cachePositions[v] = position;
+
+            float score = ForsythScore(position, numOfLive[v]);
+            float delta = score - vertexScores[v];
+            vertexScores[v] = score;
+
+            unsigned int * list = &triangles[offsets[v]];
+            for(unsigned int k = 0; k < numOfLive[v]; k++) {
+                triangleScores[list[k]] += delta;
+            }
+        }
+
+        cacheSize = (newCacheSize < MESH_FORSYTH_CACHE_SIZE ? newCacheSize : MESH_FORSYTH_CACHE_SIZE);
+        memcpy(cache, newCache, sizeof(unsigned int) * cacheSize);
+
+        // The best triangle is one of triangles of cached vertices
+        best = -1;
+        float bestScore = -1.0f;
+
+        for(int i = 0; i < cacheSize; i++)
+        {
+            unsigned int * list = &triangles[offsets[cache[i]]];
+            for(unsigned int k = 0; k < numOfLive[cache[i]]; k++) {
+                if (triangleScores[list[k]] > bestScore) {
+                    bestScore = triangleScores[list[k]];
+                    best = list[k];
+                }
+            }
+        }
+    }
+}
+
+void xMeshProcessor::SortClusters(xObject3d * pObject)
+{
+    long numOfTriangles = m_indices.GetNumOfElements() / 3;
+
+    xValueArray<unsigned char> misses;
+    misses.Resize(numOfTriangles);
+    SimulateCache(pObject->num_unique, misses.Data());
+
+    // Hard clusters start with triangle, which vertices are not in the
+    // cache. They are split in smaller clusters while ACMR of each part
+    // (with cold cache) is not much worse than ACMR of the whole cluster
+    xValueArray<xMeshCluster> clusters;
+    long start = 0;
+
+    while (start < numOfTriangles)
+    {
+        long end = start + 1;
+        unsigned long clusterMisses = misses[start];
+
+        while (end < numOfTriangles && misses[end] != 3) {
+            clusterMisses += misses[end];
+            end += 1;
+        }
+
+        double threshold = (double)clusterMisses / (end - start) * MESH_OVERDRAW_THRESHOLD;
+        long part = start;
+        unsigned long partMisses = 3;
+
+        for(long i = start; i < end; i++)
+        {
+            if (i > part) {
+                partMisses += misses[i];
+            }
+
+            if (i + 1 == end || (double)partMisses / (i + 1 - part) <= threshold) {
+                xMeshCluster * cluster = clusters.EmplaceBack();
+                cluster->start = (unsigned int)part;
+                cluster->end = (unsigned int)(i + 1);
+
+                part = i + 1;
+                partMisses = 3;
+            }
+        }
+
+        start = end;
+    }
+
+    // Clusters, which face outside from the center of the object, are
+    // drawn first (they occlude other clusters more often)
+    xVertex * vertices = pObject->m_vertices->Data();
+    xVector3 center(0.0f, 0.0f, 0.0f);
+    float area = 0.0f;
+
+    xValueArray<xVector3> centroids;
+    xValueArray<xVector3> normals;
+
+    for(long c = 0; c < clusters.GetNumOfElements(); c++)
+    {
+        xVector3 centroid(0.0f, 0.0f, 0.0f);
+        xVector3 normal(0.0f, 0.0f, 0.0f);
+        float clusterArea = 0.0f;
+
+        for(unsigned int i = clusters[c].start; i < clusters[c].end; i++)
+        {
+            float * p0 = vertices[m_indices[3 * i]].position;
+            float * p1 = vertices[m_indices[3 * i + 1]].position;
+            float * p2 = vertices[m_indices[3 * i + 2]].position;
+
+            xVector3 e1(p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]);
+            xVector3 e2(p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]);
+            xVector3 n(e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x);
+
+            float triangleArea = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+
+            centroid.x += (p0[0] + p1[0] + p2[0]) / 3.0f * triangleArea;
+            centroid.y += (p0[1] + p1[1] + p2[1]) / 3.0f * triangleArea;
+            centroid.z += (p0[2] + p1[2] + p2[2]) / 3.0f * triangleArea;
+
+            normal.x += n.x;
+            normal.y += n.y;
+            normal.z += n.z;
+
+            clusterArea += triangleArea;
+        }
+
+        center.x += centroid.x;
+        center.y += centroid.y;
+        center.z += centroid.z;
+        area += clusterArea;
+
+        if (clusterArea > 0.0f) {
+            centroid.x /= clusterArea;
+            centroid.y /= clusterArea;
+            centroid.z /= clusterArea;
+        }
+
+        centroids.Add(centroid);
+        normals.Add(normal);
+    }
+
+    if (area > 0.0f) {
+        center.x /= area;
+        center.y /= area;
+        center.z /= area;
+    }
+
+    for(long c = 0; c < clusters.GetNumOfElements(); c++)
+    {
+        xVector3 & n = normals[c];
+        float length = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+
+        clusters[c].key = 0.0f;
+        if (length > 0.0f) {
+            clusters[c].key = ((centroids[c].x - center.x) * n.x + (centroids[c].y - center.y) * n.y +
+                               (centroids[c].z - center.z) * n.z) / length;
+        }
+    }
+
+    std::stable_sort(clusters.Data(), clusters.Data() + clusters.GetNumOfElements(), CompareClusters);
+
+    // Order of triangles and indices are changed by the clusters order
+    xValueArray<unsigned int> order(numOfTriangles);
+    m_table.Clear();
+    m_table.Reserve(numOfTriangles * 3);
+
+    for(long c = 0; c < clusters.GetNumOfElements(); c++) {
+        for(unsigned int i = clusters[c].start; i < clusters[c].end; i++) {
+            order.Add(m_order[i]);
+            m_table.Add(m_indices[3 * i]);
+            m_table.Add(m_indices[3 * i + 1]);
+            m_table.Add(m_indices[3 * i + 2]);
+        }
+    }
+
+    m_order.Swap(order);
+    m_indices.Swap(m_table);
+}
+
+void xMeshProcessor::BuildBounds(xObject3d * pObject)
+{
+    long numOfUnique = pObject->num_unique;
+    xVertex * vertices = pObject->m_vertices->Data();
+
+    pObject->m_center = xVector3(0.0f, 0.0f, 0.0f);
+    pObject->m_radius = 0.0f;
+    pObject->m_extents = xVector3(0.0f, 0.0f, 0.0f);
+
+    if (numOfUnique == 0) {
+        return;
+    }
+
+    // Center of bounding box is the center of sphere
+    float min[3], max[3];
+    for(int k = 0; k < 3; k++) {
+        min[k] = max[k] = vertices[0].position[k];
+    }
+
+    for(long i = 1; i < numOfUnique; i++) {
+        for(int k = 0; k < 3; k++) {
+            float value = vertices[i].position[k];
+            min[k] = (value < min[k] ? value : min[k]);
+            max[k] = (value > max[k] ? value : max[k]);
+        }
+    }
+
+    xVector3 center((min[0] + max[0]) * 0.5f, (min[1] + max[1]) * 0.5f, (min[2] + max[2]) * 0.5f);
+    float radius = 0.0f;
+
+    for(long i = 0; i < numOfUnique; i++) {
+        float * p = vertices[i].position;
+        float distance = (p[0] - center.x) * (p[0] - center.x) + (p[1] - center.y) * (p[1] - center.y) +
+                         (p[2] - center.z) * (p[2] - center.z);
+        radius = (distance > radius ? distance : radius);
+    }
+
+    pObject->m_center = center;
+    pObject->m_radius = sqrtf(radius);
+    pObject->m_extents = xVector3((max[0] - min[0]) * 0.5f, (max[1] - min[1]) * 0.5f, (max[2] - min[2]) * 0.5f);
+}
+
+double xMeshProcessor::Simplify(xObject3d * pObject, long target)
+{
+    xVertex * vertices = pObject->m_vertices->Data();
+    long numOfPositions = m_quadrics.GetNumOfElements();
+    double maxError = 0.0;
+
+    xValueArray<unsigned int> remap;
+    xValueArray<unsigned char> touched;
+    xValueArray<unsigned int> offsets;
+    xValueArray<unsigned int> triangles;
+    xValueArray<unsigned long long> edges;
+    xValueArray<xMeshCollapse> collapses;
+
+    remap.Resize(numOfPositions);
+    touched.Resize(numOfPositions);
+    offsets.Resize(numOfPositions + 1);
+
+    while (m_indices.GetNumOfElements() / 3 > target)
+    {
+        long numOfTriangles = m_indices.GetNumOfElements() / 3;
+        unsigned int * indices = m_indices.Data();
+
+        // Triangles of each position (in one array)
+        memset(offsets.Data(), 0, sizeof(unsigned int) * (numOfPositions + 1));
+        for(long i = 0; i < numOfTriangles * 3; i++) {
+            offsets[m_positions[indices[i]] + 1] += 1;
+        }
+        for(long p = 0; p < numOfPositions; p++) {
+            offsets[p + 1] += offsets[p];
+        }
+
+        // Triangles added to each position are counted in remap (it is
+        // filled after)
+        triangles.Resize(numOfTriangles * 3);
+        memset(remap.Data(), 0, sizeof(unsigned int) * numOfPositions);
+
+        for(long i = 0; i < numOfTriangles * 3; i++) {
+            unsigned int p = m_positions[indices[i]];
+            triangles[offsets[p] + remap[p]] = (unsigned int)(i / 3);
+            remap[p] += 1;
+        }
+
+        edges.Clear();
+        for(long i = 0; i < numOfTriangles; i++) {
+            for(int j = 0; j < 3; j++) {
+                unsigned int a = m_positions[indices[3 * i + j]];
+                unsigned int b = m_positions[indices[3 * i + (j + 1) % 3]];
+                edges.Add(a < b ? ((unsigned long long)a << 32) | b : ((unsigned long long)b << 32) | a);
+            }
+        }
+
+        std::sort(edges.Data(), edges.Data() + edges.GetNumOfElements());
+        long numOfEdges = std::unique(edges.Data(), edges.Data() + edges.GetNumOfElements()) - edges.Data();
+
+        // Each edge is collapsed in the direction with less error
+        collapses.Clear();
+        for(long i = 0; i < numOfEdges; i++)
+        {
+            unsigned int a = (unsigned int)(edges[i] >> 32);
+            unsigned int b = (unsigned int)(edges[i] & 0xffffffff);
+            float * pa = vertices[m_wedges[m_wedgeOffsets[a]]].position;
+            float * pb = vertices[m_wedges[m_wedgeOffsets[b]]].position;
+
+            double costA = QuadricError(m_quadrics[a], m_quadrics[b], pa);
+            double costB = QuadricError(m_quadrics[a], m_quadrics[b], pb);
+
+            xMeshCollapse * collapse = collapses.EmplaceBack();
+            collapse->cost = (costA < costB ? costA : costB);
+            collapse->from = (costA < costB ? b : a);
+            collapse->to = (costA < costB ? a : b);
+        }
+
+        std::sort(collapses.Data(), collapses.Data() + collapses.GetNumOfElements(), CompareCollapses);
+
+        for(long p = 0; p < numOfPositions; p++) {
+            remap[p] = (unsigned int)p;
+            touched[p] = 0;
+        }
+
+        // Collapses with the least error are done first. Positions of
+        // collapse are not changed again in the pass, therefore triangles
+        // are checked with remapped positions
+        long numOfRemoved = 0;
+        long numOfCollapses = 0;
+
+        for(long c = 0; c < collapses.GetNumOfElements() && numOfTriangles - numOfRemoved > target; c++)
+        {
+            unsigned int from = collapses[c].from;
+            unsigned int to = collapses[c].to;
+
+            if (touched[from] || touched[to]) {
+                continue;
+            }
+
+            // Collapse should not flip triangles around the removed position
+            bool isFlipped = false;
+            long removed = 0;
+
+            for(unsigned int k = offsets[from]; k < offsets[from + 1] && !isFlipped; k++)
+            {
+                unsigned int t = triangles[k];
+                unsigned int p[3];
+                bool hasTo = false;
+
+                for(int j = 0; j < 3; j++) {
+                    p[j] = remap[m_positions[indices[3 * t + j]]];
+                    hasTo = hasTo || (p[j] == to);
+                }
+
+                if (hasTo) {
+                    removed += 1;
+                    continue;
+                }
+
+                float * before[3];
+                float * after[3];
+                for(int j = 0; j < 3; j++) {
+                    before[j] = vertices[m_wedges[m_wedgeOffsets[p[j]]]].position;
+                    after[j] = vertices[m_wedges[m_wedgeOffsets[p[j] == from ? to : p[j]]]].position;
+                }
+
+                xVector3 n0 = TriangleNormal(before[0], before[1], before[2]);
+                xVector3 n1 = TriangleNormal(after[0], after[1], after[2]);
+
+                float dot = n0.x * n1.x + n0.y * n1.y + n0.z * n1.z;
+                float length = (n0.x * n0.x + n0.y * n0.y + n0.z * n0.z);
+
+                isFlipped = (length > 0.0f && dot <= 0.0f);
+            }
+
+            if (isFlipped) {
+                continue;
+            }
+
+            remap[from] = to;
+            touched[from] = 1;
+            touched[to] = 1;
+
+            xQuadric & q = m_quadrics[to];
+            xQuadric & r = m_quadrics[from];
+            q.a00 += r.a00; q.a01 += r.a01; q.a02 += r.a02;
+            q.a11 += r.a11; q.a12 += r.a12; q.a22 += r.a22;
+            q.b0 += r.b0; q.b1 += r.b1; q.b2 += r.b2;
+            q.c += r.c;
+
+            maxError = (collapses[c].cost > maxError ? collapses[c].cost : maxError);
+            numOfRemoved += removed;
+            numOfCollapses += 1;
+        }
+
+        // Passes with few collapses (most of edges flip triangles) are
+        // not repeated
+        if (numOfCollapses == 0) {
+            break;
+        }
+
+        bool isSlow = (numOfRemoved * 100 < numOfTriangles);
+
+        // Corners of removed positions use the vertex of the new position
+        // with the closest normal and texture coordinates. Triangles with
+        // two corners in the same position are removed
+        long numOfKept = 0;
+
+        for(long i = 0; i < numOfTriangles; i++)
+        {
+            unsigned int corners[3];
+            unsigned int p[3];
+
+            for(int j = 0; j < 3; j++)
+            {
+                unsigned int v = indices[3 * i + j];
+                p[j] = remap[m_positions[v]];
+                corners[j] = v;
+
+                if (p[j] == m_positions[v]) {
+                    continue;
+                }
+
+                float bestDistance = -1.0f;
+                for(unsigned int k = m_wedgeOffsets[p[j]]; k < m_wedgeOffsets[p[j] + 1]; k++)
+                {
+                    xVertex & w = vertices[m_wedges[k]];
+                    xVertex & o = vertices[v];
+
+                    float distance = 0.0f;
+                    for(int m = 0; m < 3; m++) {
+                        distance += (w.normal[m] - o.normal[m]) * (w.normal[m] - o.normal[m]);
+                    }
+                    for(int m = 0; m < 2; m++) {
+                        distance += (w.texcoord[m] - o.texcoord[m]) * (w.texcoord[m] - o.texcoord[m]);
+                    }
+
+                    if (bestDistance < 0.0f || distance < bestDistance) {
+                        bestDistance = distance;
+                        corners[j] = m_wedges[k];
+                    }
+                }
+            }
+
+            if (p[0] == p[1] || p[1] == p[2] || p[2] == p[0]) {
+                continue;
+            }
+
+            for(int j = 0; j < 3; j++) {
+                indices[3 * numOfKept + j] = corners[j];
+            }
+            numOfKept += 1;
+        }
+
+        m_indices.Resize(numOfKept * 3);
+
+        if (isSlow) {
+            break;
+        }
+    }
+
+    return sqrt(maxError);
+}
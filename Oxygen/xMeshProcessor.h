@@ -0,0 +1,209 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 23.02.2018.
+ * Copyright
+ *
+ * xMeshProcessor prepares imported objects for
+ * indexed drawing: each unique (v, vt, vn) triple
+ * of the faces becomes one interleaved vertex and
+ * faces become index buffer with 16 bit indices
+ * (if object has less than 65536 unique vertices)
+ * or with 32 bit indices. Order of triangles of
+ * indexed object can be optimized for the post
+ * transform vertex cache of GPU (Forsyth) and
+ * for less overdraw (clusters of triangles, which
+ * face outside of the object, are drawn first).
+ * Simplified levels (LOD) of objects are built by
+ * edge collapses with quadric error metric: LODs
+ * use vertices of the object and have their own
+ * index buffers. Faces and vertices of the file
+ * are released after indexing. Vertices of indexed
+ * objects can be compressed (xPackedVertex), then
+ * float vertices of objects are released
+ */
+
+#ifndef OXYGEN_XMESHPROCESSOR_H
+#define OXYGEN_XMESHPROCESSOR_H
+
+#include "xEngine.h"
+
+#define MESH_FORSYTH_CACHE_SIZE     32      // LRU cache size for scores of Forsyth ordering
+#define MESH_FIFO_CACHE_SIZE        16      // FIFO cache size for ACMR measuring
+#define MESH_OVERDRAW_THRESHOLD     1.05    // Max ACMR growth allowed by splitting in clusters
+#define MESH_MAX_LODS               3       // Max number of simplified levels of object
+#define MESH_LOD_REDUCTION          0.5     // Triangles of LOD relative to the previous level
+#define MESH_BORDER_WEIGHT          10.0    // Weight of planes, which keep borders of the object
+
+// ----------------------------------------------------------------------
+// Quadric (symmetric 4x4 matrix) of squared distances to planes
+// ----------------------------------------------------------------------
+
+struct xQuadric
+{
+    double a00, a01, a02, a11, a12, a22;
+    double b0, b1, b2;
+    double c;
+};
+
+// ----------------------------------------------------------------------
+// Memory and max errors of compressed objects
+// ----------------------------------------------------------------------
+
+struct xCompressionReport
+{
+    unsigned long bytesBefore;          // Unique vertices and indices of objects before compression
+    unsigned long bytesAfter;           // Unique vertices and indices of objects after compression
+    float positionError;                // Max difference of coordinates of positions
+    float normalError;                  // Max angle between normals (in degrees)
+    float texcoordError;                // Max difference of texture coordinates
+};
+
+// ----------------------------------------------------------------------
+// Mesh Processor Class
+// ----------------------------------------------------------------------
+
+class xMeshProcessor
+{
+public:
+
+    // ----------------------------------------------------------------------
+    // Creates processor with empty statistics
+    // ----------------------------------------------------------------------
+    xMeshProcessor();
+
+    // ----------------------------------------------------------------------
+    // Builds unique interleaved vertices and index buffer from the faces
+    // of the object (previous indexed data of the object is replaced).
+    // Faces and float vertices of the object are released after that
+    // ----------------------------------------------------------------------
+    void BuildIndexed(xObject3d * pObject);
+
+    // ----------------------------------------------------------------------
+    // Starts indexing of the object by parts: faces are added by the next
+    // IndexFaces calls (previous indexed data of the object is replaced)
+    // ----------------------------------------------------------------------
+    void BeginIndexed(xObject3d * pObject);
+
+    // ----------------------------------------------------------------------
+    // Adds up to numOfFaces next faces of the object started by BeginIndexed.
+    // Returns true, if all the faces are added: then indexed object is built
+    // as by BuildIndexed
+    // ----------------------------------------------------------------------
+    bool IndexFaces(xObject3d * pObject, long numOfFaces);
+
+    // ----------------------------------------------------------------------
+    // Reorders triangles of indexed object: Forsyth vertex
+    // cache ordering and sorting of clusters for overdraw after that.
+    // Saves ACMR of the object before and after optimization
+    // ----------------------------------------------------------------------
+    void OptimizeOrder(xObject3d * pObject);
+
+    // ----------------------------------------------------------------------
+    // Returns ACMR (average cache miss ratio: vertex shader runs per
+    // triangle) of indexed object for FIFO cache of MESH_FIFO_CACHE_SIZE
+    // ----------------------------------------------------------------------
+    double GetACMR(xObject3d * pObject);
+
+    // ----------------------------------------------------------------------
+    // Builds up to MESH_MAX_LODS simplified levels of indexed object (each
+    // level has MESH_LOD_REDUCTION of triangles of the previous level)
+    // ----------------------------------------------------------------------
+    void BuildLods(xObject3d * pObject);
+
+    // ----------------------------------------------------------------------
+    // Compresses unique vertices of indexed object and releases its float
+    // unique vertices. Object is drawn only by indices after that
+    // ----------------------------------------------------------------------
+    void Compress(xObject3d * pObject);
+
+    // ----------------------------------------------------------------------
+    // Returns memory and errors of objects compressed since reset
+    // ----------------------------------------------------------------------
+    xCompressionReport GetCompressionReport();
+
+    // ----------------------------------------------------------------------
+    // Returns number of corners of faces processed since reset
+    // ----------------------------------------------------------------------
+    unsigned long GetNumOfCorners();
+
+    // ----------------------------------------------------------------------
+    // Returns number of unique vertices built since reset
+    // ----------------------------------------------------------------------
+    unsigned long GetNumOfUnique();
+
+    // ----------------------------------------------------------------------
+    // Returns how many corners use one unique vertex on average
+    // (1.0 - vertices are not shared)
+    // ----------------------------------------------------------------------
+    double GetDedupRatio();
+
+    // ----------------------------------------------------------------------
+    // Returns ACMR of all the optimized objects before and after
+    // optimization (weighted by number of triangles) since reset
+    // ----------------------------------------------------------------------
+    double GetACMRBefore();
+    double GetACMRAfter();
+
+    // ----------------------------------------------------------------------
+    // Resets statistics
+    // ----------------------------------------------------------------------
+    void ResetStats();
+
+private:
+
+    // ----------------------------------------------------------------------
+    // Returns hash of (v, vt, vn) triple
+    // ----------------------------------------------------------------------
+    static unsigned long long HashTriple(long v, long t, long n);
+
+    // ----------------------------------------------------------------------
+    // Counts cache misses of each triangle of m_indices (FIFO cache).
+    // Returns number of all the misses
+    // ----------------------------------------------------------------------
+    unsigned long SimulateCache(long numOfUnique, unsigned char * misses);
+
+    // ----------------------------------------------------------------------
+    // Forsyth ordering of triangles of m_indices (result in m_order)
+    // ----------------------------------------------------------------------
+    void OrderForsyth(long numOfUnique);
+
+    // ----------------------------------------------------------------------
+    // Splits ordered triangles of m_indices in clusters and sorts them
+    // (outside facing clusters first)
+    // ----------------------------------------------------------------------
+    void SortClusters(xObject3d * pObject);
+
+    // ----------------------------------------------------------------------
+    // Counts bounding sphere of the vertices of indexed object
+    // ----------------------------------------------------------------------
+    void BuildBounds(xObject3d * pObject);
+
+    // ----------------------------------------------------------------------
+    // Collapses edges of triangles of m_indices, until number of triangles
+    // is not more than target (or edges cannot be collapsed).
+    // Returns max error of collapses
+    // ----------------------------------------------------------------------
+    double Simplify(xObject3d * pObject, long target);
+
+    unsigned long m_numOfCorners;           // Processed corners of faces
+    unsigned long m_numOfUnique;            // Built unique vertices
+    unsigned long m_numOfTriangles;         // Optimized triangles
+    double m_missesBefore;                  // Cache misses of optimized objects before optimization
+    double m_missesAfter;                   // Cache misses of optimized objects after optimization
+    xCompressionReport m_compression;       // Compressed objects
+    long m_nextFace;                        // Next face of the object to index
+
+    xValueArray<unsigned int> m_table;      // Open addressing table: unique vertex of the slot
+    xValueArray<long> m_keys;               // (v, vt, vn) triples of unique vertices
+    xValueArray<unsigned int> m_indices;    // 32 bit indices before packing
+    xValueArray<unsigned int> m_order;      // New order of triangles
+
+    xValueArray<unsigned int> m_positions;  // Welded position of each unique vertex
+    xValueArray<unsigned int> m_wedgeOffsets;   // First vertex of each position in m_wedges
+    xValueArray<unsigned int> m_wedges;     // Unique vertices grouped by positions
+    xValueArray<xQuadric> m_quadrics;       // Error quadric of each position
+
+};
+
+
+#endif //OXYGEN_XMESHPROCESSOR_H
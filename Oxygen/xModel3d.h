@@ -9,6 +9,18 @@
 #ifndef OXYGEN_XMODEL3D_H
 #define OXYGEN_XMODEL3D_H
 
+// Max projected error (in pixels) of LOD, which can be drawn
+#define MODEL_LOD_PIXEL_ERROR 1.0f
+
+// ----------------------------------------------------------------------
+// Simplified level of indexed object (indices use vertices of object)
+// ----------------------------------------------------------------------
+struct xObjectLod
+{
+    long firstIndex;        // First index in the LOD index buffer
+    long numOfIndices;      // Number of indices (3 per triangle)
+    float error;            // Max distance from the original surface
+};
 
 class xObject3d
 {
@@ -16,22 +28,57 @@ public:
 
     friend class xModel3d;
     friend class xModelLoader;
+    friend class xMeshCache;
+    friend class xMeshProcessor;
+    friend class xInstanceBatch;
 
     xObject3d()
     {
         is_active = true;
         m_MaterialId = -1;
         m_texture = NULL;
+        m_textureManager = NULL;
+        m_name[0] = '\0';
 
         num_vertexes = 0;
         num_textcords = 0;
         num_normals = 0;
         num_faces = 0;
 
-        m_vertexes = new xDynamicArray<xPoint3>;
-        m_textcords = new xDynamicArray<xPoint2>;
-        m_normals = new xDynamicArray<xPoint3>;
-        m_faces = new xDynamicArray<xFace>;
+        has_normals = false;
+        has_texcoords = false;
+        num_unique = 0;
+        num_indices = 0;
+        index_size = 0;
+        acmr_before = 0.0f;
+        acmr_after = 0.0f;
+
+        num_lods = 0;
+        m_currentLod = 0;
+        m_radius = 0.0f;
+        m_extents = xVector3(0.0f, 0.0f, 0.0f);
+
+        is_compressed = false;
+        for(int i = 0; i < 3; i++) {
+            m_boundsMin[i] = 0.0f;
+            m_boundsScale[i] = 0.0f;
+        }
+
+        is_uploaded = false;
+        m_vertexBuffer = 0;
+        m_indexBuffer = 0;
+        m_vertexArray = 0;
+
+        m_vertexes = new xValueArray<xPoint3>;
+        m_textcords = new xValueArray<xPoint2>;
+        m_normals = new xValueArray<xPoint3>;
+        m_faces = new xValueArray<xFace>;
+
+        m_vertices = new xValueArray<xVertex>;
+        m_indices = new xValueArray<unsigned char>;
+        m_lods = new xValueArray<xObjectLod>;
+        m_lodIndices = new xValueArray<unsigned char>;
+        m_packed = new xValueArray<xPackedVertex>;
     }
 
     ~xObject3d()
@@ -40,22 +87,188 @@ public:
         SAFE_DELETE(m_textcords);
         SAFE_DELETE(m_normals);
         SAFE_DELETE(m_faces);
-        SAFE_DELETE(m_texture);
+        SAFE_DELETE(m_vertices);
+        SAFE_DELETE(m_indices);
+        SAFE_DELETE(m_lods);
+        SAFE_DELETE(m_lodIndices);
+        SAFE_DELETE(m_packed);
+        if (m_textureManager != NULL) {
+            m_textureManager->Remove(m_texture);
+        }
+
+        if (m_vertexArray != 0) {
+            glDeleteVertexArrays(1, &m_vertexArray);
+        }
+        if (m_vertexBuffer != 0) {
+            glDeleteBuffers(1, &m_vertexBuffer);
+            glDeleteBuffers(1, &m_indexBuffer);
+        }
+    }
+
+    // Returns index of indexed object (without check of bounds)
+    unsigned int GetIndex(long i)
+    {
+        if (index_size == 2) {
+            return ((unsigned short *)m_indices->Data())[i];
+        } else {
+            return ((unsigned int *)m_indices->Data())[i];
+        }
     }
 
-    void LoadTexture(char * name, char * path)
+    // Returns index of LOD index buffer (without check of bounds)
+    unsigned int GetLodIndex(long i)
     {
-        m_texture = new xTexture(name, path);
+        if (index_size == 2) {
+            return ((unsigned short *)m_lodIndices->Data())[i];
+        } else {
+            return ((unsigned int *)m_lodIndices->Data())[i];
+        }
+    }
+
+    // Returns unique vertex of indexed object (decompressed, if object
+    // keeps vertices in the compressed format)
+    void GetVertex(long i, xVertex * vertex)
+    {
+        if (is_compressed) {
+            (*m_packed)[i].Unpack(m_boundsMin, m_boundsScale, vertex);
+        } else {
+            *vertex = (*m_vertices)[i];
+        }
+    }
+
+    // Chooses the simplest LOD, which projected error is less than
+    // max_error pixels for the camera (0 - full object). Object is
+    // moved by the model matrix (or NULL)
+    void SelectLod(xVirtualCamera * camera, const float * transform, float max_error)
+    {
+        // Error of level is scaled as radius of bounds
+        xVector3 center = m_center;
+        xVector3 extents = m_extents;
+        float scale = 1.0f;
+
+        if (transform != NULL) {
+            xFrustumCuller::TransformBounds(transform, &center, &scale, &extents);
+        }
+
+        float pixels = camera->GetProjectedSize(&center, scale);
+
+        m_currentLod = 0;
+        for(long i = 0; i < num_lods; i++) {
+            if ((*m_lods)[i].error * pixels > max_error) {
+                break;
+            }
+            m_currentLod = i + 1;
+        }
+    }
+
+    // Texture is shared through the manager (it is used instead of
+    // the texture of the material)
+    void LoadTexture(xResourceManager<xTexture> * manager, char * name, char * path)
+    {
+        if (m_textureManager != NULL) {
+            m_textureManager->Remove(m_texture);
+        }
+
+        m_texture = manager->Add(name, path);
+        m_textureManager = manager;
+    }
+
+    // Uploads unique vertices and indices (with indices of levels) of indexed
+    // object in buffer objects (vertex array object keeps arrays of the
+    // buffers, if it is supported). Needs current context, called by the
+    // first Render. Returns false, if buffer objects are not supported
+    bool Upload()
+    {
+        is_uploaded = true;
+
+        if (index_size == 0 || m_vertexBuffer != 0 || !GLEW_VERSION_1_5) {
+            return (m_vertexBuffer != 0);
+        }
+
+        // Compressed vertices are decoded in floats for fixed pipeline, so
+        // the buffer has the same size as for not compressed object
+        xValueArray<xVertex> decoded;
+        xVertex * vertices = m_vertices->Data();
+
+        if (is_compressed) {
+            decoded.Resize(num_unique);
+            for(long i = 0; i < num_unique; i++) {
+                GetVertex(i, &decoded[i]);
+            }
+            vertices = decoded.Data();
+        }
+
+        long indexBytes = num_indices * index_size;
+        long lodIndexBytes = m_lodIndices->GetNumOfElements();
+
+        glGenBuffers(1, &m_vertexBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(xVertex) * num_unique, vertices, GL_STATIC_DRAW);
+
+        // Indices of levels follow indices of the object
+        glGenBuffers(1, &m_indexBuffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes + lodIndexBytes, NULL, GL_STATIC_DRAW);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indexBytes, m_indices->Data());
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, lodIndexBytes, m_lodIndices->Data());
+
+        if (GLEW_VERSION_3_0 || GLEW_ARB_vertex_array_object) {
+            glGenVertexArrays(1, &m_vertexArray);
+            glBindVertexArray(m_vertexArray);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+            EnableArrays(NULL);
+            glBindVertexArray(0);
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        return true;
     }
 
     void Render(xMaterial * material)
     {
         if (is_active)
         {
+            if (material != NULL) {
+                material->ApplyMaterial();
+            }
+
             if (m_texture != NULL) {
+                glEnable(GL_TEXTURE_2D);
                 glBindTexture(GL_TEXTURE_2D, m_texture->GetTextureID());
             }
 
+            Draw();
+        }
+    }
+
+    // Draws triangles of the current level with current state
+    // (material and texture are not applied)
+    void Draw()
+    {
+        if (is_active)
+        {
+            if (index_size != 0 && !is_uploaded) {
+                Upload();
+            }
+
+            if (m_currentLod > 0) {
+                RenderLod(m_currentLod);
+                return;
+            }
+
+            if (index_size != 0) {
+                DrawIndices(m_indices, 0, num_indices);
+                return;
+            }
+
+            // Not indexed object is drawn by faces in immediate mode.
+            // Contiguous data of the object (walked linearly)
+            xPoint3 * vertexes = m_vertexes->Data();
+            xPoint2 * textcords = m_textcords->Data();
+            xPoint3 * normals = m_normals->Data();
+            xFace * faces = m_faces->Data();
+
             if (num_normals && num_textcords) {
                 for(long i = 0; i < num_faces; i++) {
 
@@ -63,16 +276,13 @@ public:
 
                     for(int j = 0; j < 3; j++) {
 
-                        glTexCoord2f(m_textcords->GetElement(m_faces->GetElement(i)->texture[j])->x,
-                                     m_textcords->GetElement(m_faces->GetElement(i)->texture[j])->y);
+                        xPoint2 * t = &textcords[faces[i].texture[j]];
+                        xPoint3 * n = &normals[faces[i].normal[j]];
+                        xPoint3 * v = &vertexes[faces[i].vertex[j]];
 
-                        glNormal3f(m_normals->GetElement(m_faces->GetElement(i)->normal[j])->x,
-                                   m_normals->GetElement(m_faces->GetElement(i)->normal[j])->y,
-                                   m_normals->GetElement(m_faces->GetElement(i)->normal[j])->z);
-
-                        glVertex3f(m_vertexes->GetElement(m_faces->GetElement(i)->vertex[j])->x,
-                                   m_vertexes->GetElement(m_faces->GetElement(i)->vertex[j])->y,
-                                   m_vertexes->GetElement(m_faces->GetElement(i)->vertex[j])->z);
+                        glTexCoord2f(t->x, t->y);
+                        glNormal3f(n->x, n->y, n->z);
+                        glVertex3f(v->x, v->y, v->z);
                     }
 
                     glEnd();
@@ -85,12 +295,11 @@ public:
 
                     for(int j = 0; j < 3; j++) {
 
-                        glTexCoord2f(m_textcords->GetElement(m_faces->GetElement(i)->texture[j])->x,
-                                     m_textcords->GetElement(m_faces->GetElement(i)->texture[j])->y);
+                        xPoint2 * t = &textcords[faces[i].texture[j]];
+                        xPoint3 * v = &vertexes[faces[i].vertex[j]];
 
-                        glVertex3f(m_vertexes->GetElement(m_faces->GetElement(i)->vertex[j])->x,
-                                   m_vertexes->GetElement(m_faces->GetElement(i)->vertex[j])->y,
-                                   m_vertexes->GetElement(m_faces->GetElement(i)->vertex[j])->z);
+                        glTexCoord2f(t->x, t->y);
+                        glVertex3f(v->x, v->y, v->z);
                     }
 
                     glEnd();
@@ -103,13 +312,11 @@ public:
 
                     for(int j = 0; j < 3; j++) {
 
-                        glNormal3f(m_normals->GetElement(m_faces->GetElement(i)->normal[j])->x,
-                                   m_normals->GetElement(m_faces->GetElement(i)->normal[j])->y,
-                                   m_normals->GetElement(m_faces->GetElement(i)->normal[j])->z);
+                        xPoint3 * n = &normals[faces[i].normal[j]];
+                        xPoint3 * v = &vertexes[faces[i].vertex[j]];
 
-                        glVertex3f(m_vertexes->GetElement(m_faces->GetElement(i)->vertex[j])->x,
-                                   m_vertexes->GetElement(m_faces->GetElement(i)->vertex[j])->y,
-                                   m_vertexes->GetElement(m_faces->GetElement(i)->vertex[j])->z);
+                        glNormal3f(n->x, n->y, n->z);
+                        glVertex3f(v->x, v->y, v->z);
                     }
 
                     glEnd();
@@ -122,9 +329,9 @@ public:
 
                     for(int j = 0; j < 3; j++) {
 
-                        glVertex3f(m_vertexes->GetElement(m_faces->GetElement(i)->vertex[j])->x,
-                                   m_vertexes->GetElement(m_faces->GetElement(i)->vertex[j])->y,
-                                   m_vertexes->GetElement(m_faces->GetElement(i)->vertex[j])->z);
+                        xPoint3 * v = &vertexes[faces[i].vertex[j]];
+
+                        glVertex3f(v->x, v->y, v->z);
                     }
 
                     glEnd();
@@ -134,6 +341,153 @@ public:
         }
     }
 
+    // Renders simplified level of the object (from 1 to num_lods)
+    void RenderLod(long level)
+    {
+        xObjectLod & lod = (*m_lods)[level - 1];
+        DrawIndices(m_lodIndices, lod.firstIndex, lod.numOfIndices);
+    }
+
+    // Renders triangles of index buffer (m_indices or m_lodIndices) by one
+    // glDrawElements from buffer objects (or from client memory, if object
+    // is not uploaded). Compressed object without buffers is drawn in
+    // immediate mode
+    void DrawIndices(xValueArray<unsigned char> * buffer, long first, long count)
+    {
+        if (!BindArrays()) {
+            RenderIndices(buffer, first, count);
+            return;
+        }
+
+        DrawElements(buffer, first, count, 0);
+        UnbindArrays();
+    }
+
+    // Binds vertex and index data of the object for the next DrawBound
+    // calls (uploads object, if it was not done). Returns false, if object
+    // cannot be drawn from arrays (compressed object without buffers)
+    bool BindArrays()
+    {
+        if (index_size != 0 && !is_uploaded) {
+            Upload();
+        }
+
+        if (m_vertexArray != 0) {
+            glBindVertexArray(m_vertexArray);
+        }
+        else if (m_vertexBuffer != 0) {
+            glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+            EnableArrays(NULL);
+        }
+        else if (index_size != 0 && !is_compressed) {
+            EnableArrays((const char *)m_vertices->Data());
+        }
+        else {
+            return false;
+        }
+
+        return true;
+    }
+
+    // Draws the current level of the object with bound arrays (the same
+    // triangles num_instances times by hardware instancing, if it is more
+    // than 0)
+    void DrawBound(GLsizei num_instances)
+    {
+        if (m_currentLod > 0) {
+            xObjectLod & lod = (*m_lods)[m_currentLod - 1];
+            DrawElements(m_lodIndices, lod.firstIndex, lod.numOfIndices, num_instances);
+        } else {
+            DrawElements(m_indices, 0, num_indices, num_instances);
+        }
+    }
+
+    // Unbinds arrays of the object after drawing
+    void UnbindArrays()
+    {
+        if (m_vertexArray != 0) {
+            glBindVertexArray(0);
+            return;
+        }
+
+        DisableArrays();
+
+        if (m_vertexBuffer != 0) {
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        }
+    }
+
+    // Draws range of index buffer with bound arrays
+    void DrawElements(xValueArray<unsigned char> * buffer, long first, long count, GLsizei num_instances)
+    {
+        GLenum type = (index_size == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT);
+        const GLvoid * indices = buffer->Data() + first * index_size;
+
+        // Indices of levels follow indices of the object in the buffer
+        if (m_vertexBuffer != 0) {
+            indices = (const GLvoid *)((buffer == m_lodIndices ? num_indices + first : first) * index_size);
+        }
+
+        if (num_instances > 0) {
+            glDrawElementsInstancedARB(GL_TRIANGLES, (GLsizei)count, type, indices, num_instances);
+        } else {
+            glDrawElements(GL_TRIANGLES, (GLsizei)count, type, indices);
+        }
+    }
+
+    // Sets client arrays of interleaved vertices (base - address of the
+    // first vertex, NULL for bound vertex buffer)
+    void EnableArrays(const char * base)
+    {
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glVertexPointer(3, GL_FLOAT, sizeof(xVertex), base + offsetof(xVertex, position));
+
+        if (has_normals) {
+            glEnableClientState(GL_NORMAL_ARRAY);
+            glNormalPointer(GL_FLOAT, sizeof(xVertex), base + offsetof(xVertex, normal));
+        }
+        if (has_texcoords) {
+            glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+            glTexCoordPointer(2, GL_FLOAT, sizeof(xVertex), base + offsetof(xVertex, texcoord));
+        }
+    }
+
+    void DisableArrays()
+    {
+        glDisableClientState(GL_VERTEX_ARRAY);
+        glDisableClientState(GL_NORMAL_ARRAY);
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    }
+
+    // Renders triangles of index buffer in immediate mode (with size of
+    // index of the object)
+    void RenderIndices(xValueArray<unsigned char> * buffer, long first, long count)
+    {
+        unsigned char * indices = buffer->Data();
+
+        glBegin(GL_TRIANGLES);
+
+        for(long i = first; i < first + count; i++) {
+
+            unsigned int index = (index_size == 2 ? ((unsigned short *)indices)[i] : ((unsigned int *)indices)[i]);
+
+            xVertex v;
+            GetVertex(index, &v);
+
+            if (has_texcoords) {
+                glTexCoord2f(v.texcoord[0], v.texcoord[1]);
+            }
+            if (has_normals) {
+                glNormal3f(v.normal[0], v.normal[1], v.normal[2]);
+            }
+            glVertex3f(v.position[0], v.position[1], v.position[2]);
+        }
+
+        glEnd();
+    }
+
 private:
 
     long num_vertexes;      //
@@ -146,10 +500,42 @@ private:
     char m_name[STRING_SIZE];   // Object name
 
     xTexture * m_texture;                    // Texture for model
-    xDynamicArray<xPoint3> * m_vertexes;     // Array of vertexes
-    xDynamicArray<xPoint2> * m_textcords;    // Array of texture coordinates
-    xDynamicArray<xPoint3> * m_normals;      // Array of normal vectors
-    xDynamicArray<xFace>   * m_faces;        // Array of faces (triangles) of object
+    xResourceManager<xTexture> * m_textureManager;  // Owner of the texture
+    xValueArray<xPoint3> * m_vertexes;       // Array of vertexes
+    xValueArray<xPoint2> * m_textcords;      // Array of texture coordinates
+    xValueArray<xPoint3> * m_normals;        // Array of normal vectors
+    xValueArray<xFace>   * m_faces;          // Array of faces (released after indexing)
+
+    bool has_normals;       // Unique vertices have normals
+    bool has_texcoords;     // Unique vertices have texture coordinates
+    long num_unique;        // Unique vertices of indexed object
+    long num_indices;       // Indices of indexed object (3 per triangle)
+    int index_size;         // Size of one index: 2 or 4 bytes (0 - object is not indexed)
+    float acmr_before;      // Vertex cache misses per triangle in the file order
+    float acmr_after;       // Vertex cache misses per triangle after optimization of order
+
+    xValueArray<xVertex> * m_vertices;       // Interleaved unique vertices
+    xValueArray<unsigned char> * m_indices;  // Index buffer (16 or 32 bit indices)
+
+    long num_lods;          // Simplified levels of the object
+    long m_currentLod;      // Level chosen for rendering (0 - full object)
+    xVector3 m_center;      // Center of bounding sphere (and bounding box)
+    float m_radius;         // Radius of bounding sphere
+    xVector3 m_extents;     // Half sizes of bounding box
+
+    xValueArray<xObjectLod> * m_lods;           // Simplified levels (from the most detailed)
+    xValueArray<unsigned char> * m_lodIndices;  // Indices of all the levels (size of index as in m_indices)
+
+    bool is_compressed;     // Vertices are kept in m_packed (other vertex data is released)
+    float m_boundsMin[3];   // Corner of bounds of compressed positions
+    float m_boundsScale[3]; // Size of bounds divided by 65535
+
+    xValueArray<xPackedVertex> * m_packed;      // Compressed unique vertices
+
+    bool is_uploaded;       // Upload was tried (buffers are created one time)
+    GLuint m_vertexBuffer;  // Unique vertices in GPU memory (0 - object is not uploaded)
+    GLuint m_indexBuffer;   // Indices of the object and indices of its levels in GPU memory
+    GLuint m_vertexArray;   // Arrays state of the buffers (0 - vertex array objects are not supported)
 
 };
 
@@ -159,6 +545,8 @@ class xModel3d
 public:
 
     friend class xModelLoader;
+    friend class xMeshCache;
+    friend class xInstanceBatch;
 
     xModel3d()
     {
@@ -167,14 +555,21 @@ public:
         num_objects = 0;
         num_materials = 0;
 
+        m_radius = 0.0f;
+        m_firstBounds = -1;
+
         m_objects = new xDynamicArray<xObject3d>;
         m_materials = new xDynamicArray<xMaterial>;
+        m_caches = new xDynamicArray<xMappedFile>;
     }
 
     ~xModel3d()
     {
         SAFE_DELETE(m_objects);
         SAFE_DELETE(m_materials);
+
+        // Objects could use mapped memory of caches
+        SAFE_DELETE(m_caches);
     }
 
     void Render()
@@ -187,6 +582,146 @@ public:
         }
     }
 
+    // Uploads indexed objects in buffer objects (needs current context,
+    // otherwise objects are uploaded by the first rendering)
+    void Upload()
+    {
+        for(long i = 0; i < num_objects; i++) {
+            m_objects->GetElement(i)->Upload();
+        }
+    }
+
+    // Counts bounds of the model by bounds of indexed objects (called
+    // by loader after import)
+    void BuildBounds()
+    {
+        float min[3] = {0.0f, 0.0f, 0.0f};
+        float max[3] = {0.0f, 0.0f, 0.0f};
+        bool isEmpty = true;
+
+        for(long i = 0; i < num_objects; i++)
+        {
+            xObject3d * pObject = m_objects->GetElement(i);
+            if (pObject->num_unique == 0) {
+                continue;
+            }
+
+            float center[3] = {pObject->m_center.x, pObject->m_center.y, pObject->m_center.z};
+            float extents[3] = {pObject->m_extents.x, pObject->m_extents.y, pObject->m_extents.z};
+
+            for(int k = 0; k < 3; k++) {
+                float low = center[k] - extents[k];
+                float high = center[k] + extents[k];
+                min[k] = (isEmpty || low < min[k] ? low : min[k]);
+                max[k] = (isEmpty || high > max[k] ? high : max[k]);
+            }
+            isEmpty = false;
+        }
+
+        m_center = xVector3((min[0] + max[0]) * 0.5f, (min[1] + max[1]) * 0.5f, (min[2] + max[2]) * 0.5f);
+        m_extents = xVector3((max[0] - min[0]) * 0.5f, (max[1] - min[1]) * 0.5f, (max[2] - min[2]) * 0.5f);
+        m_radius = 0.0f;
+
+        // Sphere of the model contains spheres of objects
+        for(long i = 0; i < num_objects; i++)
+        {
+            xObject3d * pObject = m_objects->GetElement(i);
+            if (pObject->num_unique == 0) {
+                continue;
+            }
+
+            float dx = pObject->m_center.x - m_center.x;
+            float dy = pObject->m_center.y - m_center.y;
+            float dz = pObject->m_center.z - m_center.z;
+            float radius = sqrtf(dx * dx + dy * dy + dz * dz) + pObject->m_radius;
+            m_radius = (radius > m_radius ? radius : m_radius);
+        }
+    }
+
+    // Returns bounding sphere and half sizes of bounding box of the
+    // model in its own space (box has the center of sphere)
+    void GetBounds(xVector3 * center, float * radius, xVector3 * extents)
+    {
+        *center = m_center;
+        *radius = m_radius;
+        *extents = m_extents;
+    }
+
+    // Adds bounds of all the objects in the culler moved by model matrix
+    // of the model (NULL - model is in world space). Indices of the
+    // objects are kept for the next Submit
+    void AddBounds(xFrustumCuller * culler, const float * transform = NULL)
+    {
+        m_firstBounds = culler->GetNumOfBounds();
+
+        for(long i = 0; i < num_objects; i++) {
+            xObject3d * pObject = m_objects->GetElement(i);
+            culler->Add(&pObject->m_center, pObject->m_radius, &pObject->m_extents, transform);
+        }
+    }
+
+    // Adds active objects in the queue with keys of their material,
+    // texture (texture of object replaces texture of material) and
+    // distance to the camera. Indexed objects out of frustum are skipped,
+    // if the culler is given (AddBounds and Cull should be called before).
+    // Items are drawn with model matrix (it should be the same as for
+    // AddBounds and be valid until the queue is executed)
+    void Submit(xRenderQueue * queue, xVirtualCamera * camera, unsigned int layer = 0,
+                xFrustumCuller * culler = NULL, const float * transform = NULL)
+    {
+        if (!is_active) {
+            return;
+        }
+
+        for(long i = 0; i < num_objects; i++)
+        {
+            xObject3d * pObject = m_objects->GetElement(i);
+            if (!pObject->is_active) {
+                continue;
+            }
+
+            // Objects without indices have no bounds
+            if (culler != NULL && m_firstBounds >= 0 && pObject->index_size != 0 &&
+                !culler->IsVisible(m_firstBounds + i)) {
+                continue;
+            }
+
+            xRenderItem item;
+            item.object = pObject;
+            item.material = m_materials->GetElement(pObject->m_MaterialId);
+            item.texture = pObject->m_texture;
+            item.program = 0;
+            item.transform = transform;
+
+            if (item.texture == NULL && item.material != NULL) {
+                item.texture = item.material->GetTexture();
+            }
+
+            xVector3 center = pObject->m_center;
+            if (transform != NULL) {
+                float radius = pObject->m_radius;
+                xVector3 extents = pObject->m_extents;
+                xFrustumCuller::TransformBounds(transform, &center, &radius, &extents);
+            }
+
+            unsigned long long key = xRenderQueue::MakeKey(layer, item.program,
+                                                            (item.material != NULL ? item.material->GetSortId() : 0),
+                                                            (item.texture != NULL ? item.texture->GetTextureID() : 0),
+                                                            camera->GetDepth(&center));
+            queue->Submit(key, item);
+        }
+    }
+
+    // Chooses levels of objects for the camera (before rendering) with
+    // model matrix of the model (NULL - model is in world space)
+    void SelectLod(xVirtualCamera * camera, const float * transform = NULL,
+                   float max_error = MODEL_LOD_PIXEL_ERROR)
+    {
+        for(long i = 0; i < num_objects; i++) {
+            m_objects->GetElement(i)->SelectLod(camera, transform, max_error);
+        }
+    }
+
 private:
 
     bool is_active;         //
@@ -194,8 +729,14 @@ private:
     long num_objects;       //
     long num_materials;     //
 
+    xVector3 m_center;      // Center of bounding sphere (and bounding box) of objects
+    float m_radius;         // Radius of bounding sphere
+    xVector3 m_extents;     // Half sizes of bounding box
+    long m_firstBounds;     // Index of bounds of the first object in the culler (-1 - not added)
+
     xDynamicArray<xObject3d> * m_objects;       //
     xDynamicArray<xMaterial> * m_materials;     //
+    xDynamicArray<xMappedFile> * m_caches;      // Mapped cache files, which data is used by objects
 
 };
 
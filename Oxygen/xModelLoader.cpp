@@ -10,241 +10,1419 @@
 
 #include "xEngine.h"
 
-xModelLoader::xModelLoader()
+// Powers of 10, which are exactly represented by double
+static const double s_powersOf10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// ----------------------------------------------------------------------
+// Skips spaces and tabs (but not the end of line)
+// ----------------------------------------------------------------------
+static inline const char * SkipSpaces(const char * c, const char * end)
+{
+    while (c < end && (*c == ' ' || *c == '\t' || *c == '\r')) {
+        c++;
+    }
+    return c;
+}
+
+// ----------------------------------------------------------------------
+// Returns the start of the next line (or the end of data)
+// ----------------------------------------------------------------------
+static inline const char * SkipLine(const char * c, const char * end)
+{
+    const char * eol = (const char *)memchr(c, '\n', end - c);
+    return (eol != NULL ? eol + 1 : end);
+}
+
+// ----------------------------------------------------------------------
+// Returns the end of the line without the line break and trailing spaces
+// ----------------------------------------------------------------------
+static inline const char * TrimLine(const char * c, const char * eol)
+{
+    while (eol > c && (eol[-1] == '\n' || eol[-1] == '\r' || eol[-1] == ' ' || eol[-1] == '\t')) {
+        eol--;
+    }
+    return eol;
+}
+
+// ----------------------------------------------------------------------
+// Returns the end of the word (first space or the end of data)
+// ----------------------------------------------------------------------
+static inline const char * SkipWord(const char * c, const char * end)
+{
+    while (c < end && *c != ' ' && *c != '\t' && *c != '\r' && *c != '\n') {
+        c++;
+    }
+    return c;
+}
+
+// ----------------------------------------------------------------------
+// Returns true if the word is equal to the keyword
+// ----------------------------------------------------------------------
+static inline bool IsKeyword(const char * word, const char * wordEnd, const char * keyword)
+{
+    unsigned long length = strlen(keyword);
+    return ((unsigned long)(wordEnd - word) == length && memcmp(word, keyword, length) == 0);
+}
+
+// ----------------------------------------------------------------------
+// Writes directory of the file (with the last slash) in the buffer
+// ----------------------------------------------------------------------
+static void GetDirectory(const char * filename, char * directory, unsigned long size)
+{
+    const char * slash = strrchr(filename, '/');
+    const char * backslash = strrchr(filename, '\\');
+    slash = (backslash > slash ? backslash : slash);
+
+    int length = (slash != NULL ? (int)(slash - filename + 1) : 0);
+    snprintf(directory, size, "%.*s", length, filename);
+}
+
+// ----------------------------------------------------------------------
+// Parses integer number. Returns position after the number (or c, if
+// there is no number)
+// ----------------------------------------------------------------------
+static inline const char * ParseInt(const char * c, const char * end, long * value)
+{
+    const char * start = c;
+    bool negative = false;
+
+    if (c < end && (*c == '-' || *c == '+')) {
+        negative = (*c == '-');
+        c++;
+    }
+
+    const char * digits = c;
+    long result = 0;
+
+    while (c < end && (unsigned char)(*c - '0') < 10) {
+        result = result * 10 + (*c - '0');
+        c++;
+    }
+
+    if (c == digits) {
+        return start;
+    }
+
+    *value = (negative ? -result : result);
+    return c;
+}
+
+// ----------------------------------------------------------------------
+// Parses float number (without locale, [+-]digits[.digits][e[+-]digits]).
+// Returns position after the number (or c, if there is no number)
+// ----------------------------------------------------------------------
+static inline const char * ParseFloat(const char * c, const char * end, float * value)
 {
-    m_bObjectHasUV = false;
-    m_bObjectHasNormals = false;
-    m_bJustReadAFace = false;
+    const char * start = c;
+    bool negative = false;
+
+    if (c < end && (*c == '-' || *c == '+')) {
+        negative = (*c == '-');
+        c++;
+    }
 
-    vertex_offset = 0;
-    texture_offset = 0;
-    normal_offset = 0;
+    // Up to 18 significant digits are saved in the mantissa,
+    // other digits only change the exponent
+    unsigned long long mantissa = 0;
+    int exponent = 0;
+    bool hasDigits = false;
 
-    vertex_offset_prev = 0;
-    texture_offset_prev = 0;
-    normal_offset_prev = 0;
+    while (c < end && (unsigned char)(*c - '0') < 10) {
+        if (mantissa < 100000000000000000ULL) {
+            mantissa = mantissa * 10 + (*c - '0');
+        } else {
+            exponent += 1;
+        }
+        hasDigits = true;
+        c++;
+    }
+
+    if (c < end && *c == '.') {
+        c++;
+        while (c < end && (unsigned char)(*c - '0') < 10) {
+            if (mantissa < 100000000000000000ULL) {
+                mantissa = mantissa * 10 + (*c - '0');
+                exponent -= 1;
+            }
+            hasDigits = true;
+            c++;
+        }
+    }
+
+    if (!hasDigits) {
+        return start;
+    }
+
+    if (c < end && (*c == 'e' || *c == 'E')) {
+        long power = 0;
+        const char * next = ParseInt(c + 1, end, &power);
+        if (next != c + 1) {
+            exponent += (int)power;
+            c = next;
+        }
+    }
+
+    double result = (double)mantissa;
+
+    if (exponent < 0) {
+        result = (exponent >= -22 ? result / s_powersOf10[-exponent] : result * pow(10.0, exponent));
+    } else if (exponent > 0) {
+        result = (exponent <= 22 ? result * s_powersOf10[exponent] : result * pow(10.0, exponent));
+    }
+
+    *value = (float)(negative ? -result : result);
+    return c;
+}
+
+// Files smaller than this size (per thread) are not split in chunks
+#define OBJ_MIN_CHUNK_SIZE (4 * 1024 * 1024)
+
+// Bytes parsed by one part of step by step import
+#define OBJ_STEP_SIZE (256 * 1024)
+
+// Faces indexed by one part of step by step import
+#define OBJ_STEP_FACES (64 * 1024)
+
+// Part of import progress given to parsing (other part is processing)
+#define OBJ_PARSE_PROGRESS 0.5
+
+// ----------------------------------------------------------------------
+// Copies elements [from, to) of the file, which are split in the
+// arrays of the chunks, in one array (gives the whole array of the
+// chunk without copying, if range is exactly one chunk)
+// ----------------------------------------------------------------------
+template <class Type> static void CopyRange(xValueArray<Type> & result, xObjChunk * chunks, unsigned int numOfChunks,
+                                            xValueArray<Type> xObjChunk::* array, long xObjBreak::* base,
+                                            long from, long to)
+{
+    for(unsigned int i = 0; i < numOfChunks; i++)
+    {
+        xValueArray<Type> & source = chunks[i].*array;
+        long start = chunks[i].base.*base;
+        long count = source.GetNumOfElements();
+
+        if (start == from && count == to - from && result.GetNumOfElements() == 0) {
+            result.Swap(source);
+            return;
+        }
+    }
+
+    result.Reserve(to - from);
+
+    for(unsigned int i = 0; i < numOfChunks; i++)
+    {
+        xValueArray<Type> & source = chunks[i].*array;
+        long start = chunks[i].base.*base;
+        long count = source.GetNumOfElements();
+
+        long first = (from > start ? from : start);
+        long last = (to < start + count ? to : start + count);
+
+        for(long j = first; j < last; j++) {
+            result.Add(source[j - start]);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------
+// Copies elements [from, to) of the file, which are used by the faces
+// of the object, in one array (in order of the first use) and replaces
+// indices of the faces (counted from from) by indices in the array.
+// Indices outside of the range become -1 (element is missing)
+// ----------------------------------------------------------------------
+template <class Type> static void CopyUsed(xValueArray<Type> & result, xValueArray<long> & remap,
+                                           xObjChunk * chunks, unsigned int numOfChunks,
+                                           xValueArray<Type> xObjChunk::* array, long xObjBreak::* base,
+                                           long from, long to, xValueArray<xFace> & faces, long (xFace::* index)[3])
+{
+    remap.Resize(to - from);
+    for(long i = 0; i < to - from; i++) {
+        remap[i] = -1;
+    }
+
+    for(long i = 0; i < faces.GetNumOfElements(); i++)
+    {
+        for(int j = 0; j < 3; j++)
+        {
+            long & k = (faces[i].*index)[j];
+            if (k < 0 || k >= to - from) {
+                k = -1;
+                continue;
+            }
+
+            // Element is found in its chunk by the global index
+            if (remap[k] < 0) {
+                remap[k] = result.GetNumOfElements();
+
+                for(unsigned int c = 0; c < numOfChunks; c++) {
+                    xValueArray<Type> & source = chunks[c].*array;
+                    long start = chunks[c].base.*base;
+
+                    if (from + k >= start && from + k < start + source.GetNumOfElements()) {
+                        result.Add(source[from + k - start]);
+                        break;
+                    }
+                }
+            }
+
+            k = remap[k];
+        }
+    }
+}
+
+// ----------------------------------------------------------------------
+// Adds piece of the file, which becomes one object
+// ----------------------------------------------------------------------
+static void AddPiece(xValueArray<xObjPiece> & pieces, const xObjBreak & from, const xObjBreak & to,
+                     long firstFace, long lastFace, long materialId)
+{
+    xObjPiece * piece = pieces.EmplaceBack();
+    piece->from = from;
+    piece->to = to;
+    piece->firstFace = firstFace;
+    piece->lastFace = lastFace;
+    piece->materialId = materialId;
+}
+
+xModelLoader::xModelLoader()
+{
+    m_numOfThreads = 0;
+    m_useCache = true;
+    m_optimize = true;
+    m_buildLods = true;
+    m_compress = false;
+    m_textureManager = NULL;
+    m_fileName = NULL;
+    m_chunks = NULL;
+    m_numOfChunks = 0;
+    m_stage = STAGE_NONE;
+    m_isBlocking = false;
+    m_result = MODEL_IMPORT_DONE;
+    m_progress = 0.0f;
+    m_model = NULL;
+    m_flags = 0;
+    m_firstObject = 0;
+    m_firstMaterial = 0;
+    m_nextObject = 0;
+    m_nextPiece = 0;
+    m_nextMaterial = 0;
+    m_numOfTextures = 0;
+    memset(&m_textureStats, 0, sizeof(m_textureStats));
+    m_isCached = false;
+    m_isIndexing = false;
 }
 
 xModelLoader::~xModelLoader()
 {
+    SAFE_DELETE_ARRAY(m_chunks);
+}
+
+void xModelLoader::SetCacheEnabled(bool enabled)
+{
+    m_useCache = enabled;
+}
+
+void xModelLoader::SetOptimizeEnabled(bool enabled)
+{
+    m_optimize = enabled;
+}
 
+void xModelLoader::SetLodEnabled(bool enabled)
+{
+    m_buildLods = enabled;
+}
+
+void xModelLoader::SetCompressEnabled(bool enabled)
+{
+    m_compress = enabled;
+}
+
+void xModelLoader::SetTextureManager(xResourceManager<xTexture> * manager)
+{
+    m_textureManager = manager;
+}
+
+void xModelLoader::SetNumOfThreads(unsigned int num_threads)
+{
+    m_numOfThreads = num_threads;
 }
 
 void xModelLoader::ImportObj(xModel3d *pModel, char *strFileName)
+{
+    m_isBlocking = true;
+    int result = BeginImport(pModel, strFileName);
+
+    while (result == MODEL_IMPORT_PENDING) {
+        result = StepStage();
+    }
+
+    m_isBlocking = false;
+
+    if (result != MODEL_IMPORT_DONE) {
+        exit(1);
+    }
+}
+
+int xModelLoader::BeginImport(xModel3d *pModel, char *strFileName)
 {
     if (!pModel || !strFileName) {
         printf("ERROR: Model or file \"%s\" name have wrong format \n", strFileName);
-        exit(1);
+        return MODEL_IMPORT_ERROR_ARGS;
     }
 
-    m_FilePointer = fopen(strFileName, "r");
-    if (!m_FilePointer) {
-        printf("ERROR: Cannot open file %s \n", strFileName);
-        exit(1);
+    if (m_stage != STAGE_NONE) {
+        printf("ERROR: Cannot import %s before the end of import of %s \n", strFileName, m_fileName);
+        return MODEL_IMPORT_ERROR_BUSY;
+    }
+
+    m_start = std::chrono::steady_clock::now();
+    m_stage = STAGE_OPEN;
+    m_result = MODEL_IMPORT_PENDING;
+    m_progress = 0.0f;
+    m_model = pModel;
+    m_fileName = strFileName;
+    m_flags = (m_optimize ? MESH_CACHE_OPTIMIZED : 0) | (m_buildLods ? MESH_CACHE_LODS : 0);
+    m_firstObject = pModel->num_objects;
+    m_firstMaterial = pModel->num_materials;
+    m_nextObject = m_firstObject;
+    m_nextPiece = 0;
+    m_isCached = false;
+    m_isIndexing = false;
+
+    return MODEL_IMPORT_PENDING;
+}
+
+int xModelLoader::Step(double budget_ms)
+{
+    if (m_stage == STAGE_NONE) {
+        return m_result;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::milli> budget(budget_ms);
+
+    // At least one part is done by each step
+    int result = StepStage();
+    while (result == MODEL_IMPORT_PENDING && std::chrono::steady_clock::now() - start < budget) {
+        result = StepStage();
+    }
+
+    return result;
+}
+
+float xModelLoader::GetProgress()
+{
+    switch (m_stage)
+    {
+        case STAGE_NONE:
+            return m_progress;
+
+        case STAGE_OPEN:
+            return 0.0f;
+
+        case STAGE_PARSE:
+        {
+            unsigned long parsed = 0;
+            for(unsigned int i = 0; i < m_numOfChunks; i++) {
+                parsed += m_chunks[i].cursor - m_chunks[i].begin;
+            }
+            return (float)(OBJ_PARSE_PROGRESS * parsed / (m_file.GetSize() > 0 ? m_file.GetSize() : 1));
+        }
+
+        case STAGE_MERGE:
+        case STAGE_OBJECTS:
+        case STAGE_TEXTURES:
+            return (float)OBJ_PARSE_PROGRESS;
+
+        case STAGE_FINISH:
+            return 1.0f;
+
+        default:
+        {
+            // Each enabled stage of processing has the same part of progress
+            // (saving of the cache is not counted)
+            long numOfObjects = m_model->num_objects - m_firstObject;
+            long numOfStages = 0;
+            long stage = 0;
+
+            for(int i = STAGE_INDEX; i <= STAGE_COMPRESS; i++) {
+                if (i != STAGE_SAVE && IsStageEnabled(i)) {
+                    numOfStages += 1;
+                    stage += (i < m_stage ? 1 : 0);
+                }
+            }
+
+            double done = (double)(stage * numOfObjects + m_nextObject - m_firstObject);
+            double total = (double)(numOfStages * numOfObjects);
+            return (float)(OBJ_PARSE_PROGRESS + (1.0 - OBJ_PARSE_PROGRESS) * (total > 0.0 ? done / total : 1.0));
+        }
+    }
+}
+
+int xModelLoader::StepStage()
+{
+    switch (m_stage)
+    {
+        case STAGE_OPEN:
+            return OpenObjFile();
+
+        case STAGE_PARSE:
+            return ParseObjFile();
+
+        case STAGE_MERGE:
+            ReadObjFile(m_model);
+            NextStage();
+            return MODEL_IMPORT_PENDING;
+
+        case STAGE_OBJECTS:
+            return CreateObject();
+
+        case STAGE_TEXTURES:
+            return LoadTexture();
+
+        case STAGE_INDEX:
+        case STAGE_OPTIMIZE:
+        case STAGE_LODS:
+        case STAGE_COMPRESS:
+            return ProcessObject();
+
+        case STAGE_SAVE:
+            m_cache.Save(m_model, m_firstObject, m_firstMaterial, m_flags, m_fileName, m_file.GetData(), m_file.GetSize());
+            NextStage();
+            return MODEL_IMPORT_PENDING;
+
+        case STAGE_FINISH:
+            return FinishObjFile();
+
+        default:
+            return m_result;
+    }
+}
+
+int xModelLoader::OpenObjFile()
+{
+    if (m_useCache && m_cache.Load(m_model, m_fileName, m_flags)) {
+        std::chrono::duration<double> time = std::chrono::steady_clock::now() - m_start;
+        printf("INFO: Imported %s from cache (%.3lf s) \n", m_fileName, time.count());
+
+        if (m_flags & MESH_CACHE_OPTIMIZED) {
+            PrintACMR(m_model, m_firstObject, m_fileName);
+        }
+        if (m_flags & MESH_CACHE_LODS) {
+            PrintLods(m_model, m_firstObject, m_fileName);
+        }
+
+        // Textures are loaded and objects are compressed after that
+        m_isCached = true;
+        NextStage();
+        return MODEL_IMPORT_PENDING;
+    }
+
+    if (!m_file.Open(m_fileName)) {
+        printf("ERROR: Cannot open file %s \n", m_fileName);
+        return EndImport(MODEL_IMPORT_ERROR_OPEN);
+    }
+
+    const char * data = m_file.GetData();
+    const char * end = data + m_file.GetSize();
+
+    // Step by step import parses the file in one chunk
+    unsigned int numOfThreads = (m_isBlocking ? m_numOfThreads : 1);
+    if (numOfThreads == 0) {
+        numOfThreads = std::thread::hardware_concurrency();
+        numOfThreads = (numOfThreads > 0 ? numOfThreads : 1);
+    }
+
+    unsigned long maxChunks = m_file.GetSize() / OBJ_MIN_CHUNK_SIZE;
+    m_numOfChunks = (unsigned int)(maxChunks < numOfThreads ? maxChunks : numOfThreads);
+    m_numOfChunks = (m_numOfChunks > 0 ? m_numOfChunks : 1);
+
+    m_chunks = new xObjChunk[m_numOfChunks];
+
+    // Chunks have equal size and are ended on the line ends
+    const char * begin = data;
+    for(unsigned int i = 0; i < m_numOfChunks; i++)
+    {
+        const char * split = data + m_file.GetSize() / m_numOfChunks * (i + 1);
+
+        if (i + 1 == m_numOfChunks) {
+            split = end;
+        } else {
+            split = (split > begin ? SkipLine(split - 1, end) : begin);
+        }
+
+        m_chunks[i].begin = begin;
+        m_chunks[i].end = split;
+        m_chunks[i].cursor = begin;
+        m_chunks[i].firstLine = xObjChunk::LINE_NONE;
+        m_chunks[i].lastLine = xObjChunk::LINE_NONE;
+        m_chunks[i].error = NULL;
+        begin = split;
+    }
+
+    NextStage();
+    return MODEL_IMPORT_PENDING;
+}
+
+int xModelLoader::ParseObjFile()
+{
+    X_PROFILE_SCOPE("Parse OBJ");
+
+    if (m_numOfChunks > 1)
+    {
+        // The first chunk is parsed by the calling thread
+        std::thread ** threads = new std::thread * [m_numOfChunks];
+        for(unsigned int i = 1; i < m_numOfChunks; i++) {
+            threads[i] = new std::thread(&xModelLoader::ParseChunk, this, &m_chunks[i], m_chunks[i].end);
+        }
+
+        ParseChunk(&m_chunks[0], m_chunks[0].end);
+
+        for(unsigned int i = 1; i < m_numOfChunks; i++) {
+            threads[i]->join();
+            SAFE_DELETE(threads[i]);
+        }
+
+        SAFE_DELETE_ARRAY(threads);
+    }
+    else
+    {
+        xObjChunk * pChunk = &m_chunks[0];
+        unsigned long left = pChunk->end - pChunk->cursor;
+        ParseChunk(pChunk, pChunk->cursor + (left < OBJ_STEP_SIZE ? left : OBJ_STEP_SIZE));
+
+        if (pChunk->cursor < pChunk->end && pChunk->error == NULL) {
+            return MODEL_IMPORT_PENDING;
+        }
+    }
+
+    for(unsigned int i = 0; i < m_numOfChunks; i++)
+    {
+        const char * error = m_chunks[i].error;
+        if (error == NULL) {
+            continue;
+        }
+
+        // Number of the line is counted only for the message
+        long line = 1;
+        for(const char * c = m_file.GetData(); (c = (const char *)memchr(c, '\n', error - c)) != NULL; c++) {
+            line += 1;
+        }
+
+        printf("ERROR: Mismatched number of scanned params in %s (line %ld) \n", m_fileName, line);
+        return EndImport(MODEL_IMPORT_ERROR_PARSE);
+    }
+
+    NextStage();
+    return MODEL_IMPORT_PENDING;
+}
+
+int xModelLoader::CreateObject()
+{
+    X_PROFILE_SCOPE("Merge OBJ");
+
+    if (m_nextPiece < m_pieces.GetNumOfElements()) {
+        xObjPiece & piece = m_pieces[m_nextPiece];
+        FillInObjectInfo(m_model, piece.from, piece.to, piece.firstFace, piece.lastFace, piece.materialId);
+        m_nextPiece += 1;
+        return MODEL_IMPORT_PENDING;
+    }
+
+    m_pieces.Clear();
+    NextStage();
+    return MODEL_IMPORT_PENDING;
+}
+
+int xModelLoader::LoadTexture()
+{
+    if (m_textureManager != NULL && m_nextMaterial < m_model->num_materials) {
+        if (m_model->m_materials->GetElement(m_nextMaterial)->LoadTexture(m_textureManager)) {
+            m_numOfTextures += 1;
+        }
+        m_nextMaterial += 1;
+        return MODEL_IMPORT_PENDING;
+    }
+
+    if (m_numOfTextures > 0) {
+        xResourceStats after = m_textureManager->GetStats();
+        printf("INFO: Textures of materials: %ld (%lu loaded, %lu shared) \n", m_numOfTextures,
+               after.misses - m_textureStats.misses, after.hits - m_textureStats.hits);
+    }
+
+    NextStage();
+    return MODEL_IMPORT_PENDING;
+}
+
+int xModelLoader::ProcessObject()
+{
+    if (m_nextObject < m_model->num_objects)
+    {
+        xObject3d * pObject = m_model->m_objects->GetElement(m_nextObject);
+        bool isDone = true;
+
+        if (m_stage == STAGE_INDEX) {
+            X_PROFILE_SCOPE("Index OBJ");
+
+            // Step by step import indexes large object by parts
+            if (!m_isIndexing) {
+                m_processor.BeginIndexed(pObject);
+                m_isIndexing = true;
+            }
+
+            isDone = m_processor.IndexFaces(pObject, (m_isBlocking ? pObject->num_faces : OBJ_STEP_FACES));
+            m_isIndexing = !isDone;
+        }
+        else if (m_stage == STAGE_OPTIMIZE) {
+            X_PROFILE_SCOPE("Optimize OBJ");
+            m_processor.OptimizeOrder(pObject);
+        }
+        else if (m_stage == STAGE_LODS) {
+            X_PROFILE_SCOPE("LOD OBJ");
+            m_processor.BuildLods(pObject);
+        }
+        else {
+            X_PROFILE_SCOPE("Compress OBJ");
+            m_processor.Compress(pObject);
+        }
+
+        if (isDone) {
+            m_nextObject += 1;
+        }
+
+        return MODEL_IMPORT_PENDING;
+    }
+
+    if (m_stage == STAGE_INDEX) {
+        printf("INFO: Indexed %s (%lu corners, %lu vertices, %.2lf corners per vertex) \n", m_fileName,
+               m_processor.GetNumOfCorners(), m_processor.GetNumOfUnique(), m_processor.GetDedupRatio());
+    }
+    else if (m_stage == STAGE_OPTIMIZE) {
+        PrintACMR(m_model, m_firstObject, m_fileName);
+    }
+    else if (m_stage == STAGE_LODS) {
+        PrintLods(m_model, m_firstObject, m_fileName);
+    }
+    else {
+        PrintCompression(m_fileName);
+    }
+
+    NextStage();
+    return MODEL_IMPORT_PENDING;
+}
+
+int xModelLoader::FinishObjFile()
+{
+    if (m_isCached) {
+        // Compressed objects do not use the mapped cache
+        if (m_compress) {
+            m_model->m_caches->Remove(m_model->m_caches->GetNumOfElements() - 1);
+        }
+
+        return EndImport(MODEL_IMPORT_DONE);
     }
 
-    ReadObjFile(pModel);
-    fclose(m_FilePointer);
+    double size = m_file.GetSize() / (1024.0 * 1024.0);
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - m_start;
+    printf("INFO: Imported %s (%.2lf MB, %.3lf s, %.1lf MB/s, %u threads) \n", m_fileName, size, time.count(),
+           (time.count() > 0.0 ? size / time.count() : 0.0), m_numOfChunks);
+
+    return EndImport(MODEL_IMPORT_DONE);
+}
+
+void xModelLoader::NextStage()
+{
+    do {
+        m_stage = (Stage)(m_stage + 1);
+    } while (!IsStageEnabled(m_stage));
 
-    vertex_offset = 0;
-    texture_offset = 0;
-    normal_offset = 0;
+    m_nextObject = m_firstObject;
+    m_processor.ResetStats();
 
-    vertex_offset_prev = 0;
-    texture_offset_prev = 0;
-    normal_offset_prev = 0;
+    if (m_stage == STAGE_TEXTURES) {
+        m_nextMaterial = m_firstMaterial;
+        m_numOfTextures = 0;
+        if (m_textureManager != NULL) {
+            m_textureStats = m_textureManager->GetStats();
+        }
+    }
+}
+
+bool xModelLoader::IsStageEnabled(int stage)
+{
+    // Cache keeps processed objects, but not compressed ones
+    // (compression is fast and lossy)
+    switch (stage)
+    {
+        case STAGE_PARSE:
+        case STAGE_MERGE:
+        case STAGE_OBJECTS:
+        case STAGE_INDEX:
+            return !m_isCached;
+
+        case STAGE_OPTIMIZE:
+            return !m_isCached && (m_flags & MESH_CACHE_OPTIMIZED);
+
+        case STAGE_LODS:
+            return !m_isCached && (m_flags & MESH_CACHE_LODS);
+
+        case STAGE_SAVE:
+            return !m_isCached && m_useCache;
+
+        case STAGE_COMPRESS:
+            return m_compress;
+
+        default:
+            return true;
+    }
+}
+
+int xModelLoader::EndImport(int result)
+{
+    m_progress = (result == MODEL_IMPORT_DONE ? 1.0f : GetProgress());
+
+    if (result == MODEL_IMPORT_DONE && m_model != NULL) {
+        m_model->BuildBounds();
+    }
+
+    m_file.Close();
+    SAFE_DELETE_ARRAY(m_chunks);
+    m_numOfChunks = 0;
+    m_pieces.Clear();
+    m_isIndexing = false;
+    m_fileName = NULL;
+    m_model = NULL;
+    m_stage = STAGE_NONE;
+    m_result = result;
+
+    return result;
 }
 
 void xModelLoader::ReadObjFile(xModel3d *pModel)
 {
-    char strLine[STRING_SIZE] = {0};
-    char ch  = 0;
+    X_PROFILE_SCOPE("Merge OBJ");
+
+    // Prefix sums of elements give positions of the chunks in the file,
+    // object starts become global (object is started by a 'v' line after
+    // 'f' line, which can be in one of the previous chunks)
+    xValueArray<xObjBreak> breaks;
+    xValueArray<xObjName> materials;
+    xValueArray<xObjName> libraries;
+    xObjBreak base = {0, 0, 0, 0};
+    xObjChunk::Line lastLine = xObjChunk::LINE_NONE;
 
-    while(!feof(m_FilePointer))
+    for(unsigned int i = 0; i < m_numOfChunks; i++)
     {
-        float x = 0.0f, y = 0.0f, z = 0.0f;
+        xObjChunk & chunk = m_chunks[i];
+        chunk.base = base;
 
-        ch = fgetc(m_FilePointer);
-        switch(ch)
+        // Relative indices become global
+        for(long j = 0; j < chunk.fixups.GetNumOfElements(); j++)
+        {
+            xFace & face = chunk.faces[chunk.fixups[j].face];
+            unsigned int mask = chunk.fixups[j].mask;
+
+            for(int k = 0; k < 3; k++)
+            {
+                if (mask & (1u << k)) {
+                    face.vertex[k] += base.vertices;
+                }
+                if (mask & (1u << (3 + k))) {
+                    face.texture[k] += base.texcoords;
+                }
+                if (mask & (1u << (6 + k))) {
+                    face.normal[k] += base.normals;
+                }
+            }
+        }
+
+        if (lastLine == xObjChunk::LINE_FACE && chunk.firstLine == xObjChunk::LINE_VERTEX) {
+            breaks.Add(base);
+        }
+
+        for(long j = 0; j < chunk.breaks.GetNumOfElements(); j++) {
+            xObjBreak & local = chunk.breaks[j];
+            xObjBreak * global = breaks.EmplaceBack();
+            global->vertices = base.vertices + local.vertices;
+            global->texcoords = base.texcoords + local.texcoords;
+            global->normals = base.normals + local.normals;
+            global->faces = base.faces + local.faces;
+        }
+
+        for(long j = 0; j < chunk.materials.GetNumOfElements(); j++) {
+            xObjName * use = materials.EmplaceBack(chunk.materials[j]);
+            use->face += base.faces;
+        }
+
+        for(long j = 0; j < chunk.libraries.GetNumOfElements(); j++) {
+            libraries.Add(chunk.libraries[j]);
+        }
+
+        if (chunk.lastLine != xObjChunk::LINE_NONE) {
+            lastLine = chunk.lastLine;
+        }
+
+        base.vertices += chunk.vertices.GetNumOfElements();
+        base.texcoords += chunk.texcoords.GetNumOfElements();
+        base.normals += chunk.normals.GetNumOfElements();
+        base.faces += chunk.faces.GetNumOfElements();
+    }
+
+    // End of file is the end of the last object
+    breaks.Add(base);
+
+    // Materials of libraries are added before objects, which use them
+    // (line can have many libraries, each library is loaded one time)
+    xValueArray<xObjName> files;
+    for(long i = 0; i < libraries.GetNumOfElements(); i++)
+    {
+        const char * c = libraries[i].name;
+        const char * end = c + libraries[i].length;
+
+        while ((c = SkipSpaces(c, end)) < end) {
+            xObjName * file = files.EmplaceBack();
+            file->face = libraries[i].face;
+            file->name = c;
+            file->length = SkipWord(c, end) - c;
+            c += file->length;
+        }
+    }
+
+    long firstMaterial = pModel->num_materials;
+    char directory[STRING_SIZE];
+    GetDirectory(m_fileName, directory, STRING_SIZE);
+
+    for(long i = 0; i < files.GetNumOfElements(); i++)
+    {
+        bool isLoaded = false;
+        for(long j = 0; j < i && !isLoaded; j++) {
+            isLoaded = (files[j].length == files[i].length && memcmp(files[j].name, files[i].name, files[i].length) == 0);
+        }
+
+        char filename[2 * STRING_SIZE];
+        snprintf(filename, sizeof(filename), "%s%.*s", directory, (int)files[i].length, files[i].name);
+
+        if (!isLoaded && !ImportMtl(pModel, filename)) {
+            printf("WARNING: Cannot open material library %s \n", filename);
+        }
+    }
+
+    // Object, which faces use other material after "usemtl", is split
+    // in objects with one material (each of them copies elements of the
+    // object, which are used by its faces)
+    m_pieces.Clear();
+    m_nextPiece = 0;
+    long use = 0;
+    long materialId = -1;
+
+    xObjBreak from = {0, 0, 0, 0};
+    for(long i = 0; i < breaks.GetNumOfElements(); i++)
+    {
+        xObjBreak & to = breaks[i];
+
+        while (use < materials.GetNumOfElements() && materials[use].face <= from.faces) {
+            materialId = FindMaterial(pModel, firstMaterial, materials[use].name, materials[use].length);
+            use += 1;
+        }
+
+        long firstFace = from.faces;
+
+        while (use < materials.GetNumOfElements() && materials[use].face < to.faces) {
+            if (materials[use].face > firstFace) {
+                AddPiece(m_pieces, from, to, firstFace, materials[use].face, materialId);
+                firstFace = materials[use].face;
+            }
+
+            materialId = FindMaterial(pModel, firstMaterial, materials[use].name, materials[use].length);
+            use += 1;
+        }
+
+        AddPiece(m_pieces, from, to, firstFace, to.faces, materialId);
+        from = to;
+    }
+}
+
+void xModelLoader::ParseChunk(xObjChunk *pChunk, const char *stop)
+{
+    const char * end = pChunk->end;
+
+    // Line, which is started before stop, is parsed to its end
+    while (pChunk->cursor < stop && pChunk->error == NULL)
+    {
+        pChunk->cursor = SkipSpaces(pChunk->cursor, end);
+        if (pChunk->cursor == end) {
+            break;
+        }
+
+        switch(*pChunk->cursor)
         {
             // v - vertexes, vt - texture coordinates, vn - normals
             case 'v':
 
-                // If we stopped read data about previous object
-                // we write it int the xObject
-                if(m_bJustReadAFace) {
-                    FillInObjectInfo(pModel);
+                // If we stopped read data about previous object,
+                // new object is started here
+                if (pChunk->lastLine == xObjChunk::LINE_FACE) {
+                    xObjBreak * start = pChunk->breaks.EmplaceBack();
+                    start->vertices = pChunk->vertices.GetNumOfElements();
+                    start->texcoords = pChunk->texcoords.GetNumOfElements();
+                    start->normals = pChunk->normals.GetNumOfElements();
+                    start->faces = pChunk->faces.GetNumOfElements();
+                }
+
+                if (pChunk->firstLine == xObjChunk::LINE_NONE) {
+                    pChunk->firstLine = xObjChunk::LINE_VERTEX;
                 }
 
-                ReadVertexInfo();
+                pChunk->lastLine = xObjChunk::LINE_VERTEX;
+                ReadVertexInfo(pChunk);
                 break;
 
             // f - faces
             case 'f':
-                ReadFaceInfo();
+                ReadFaceInfo(pChunk);
+                break;
+
+            // usemtl - material of the next faces, mtllib - material library
+            case 'u':
+            case 'm':
+                ReadNameInfo(pChunk);
                 break;
+
             default:
-                fgets(strLine, 100, m_FilePointer);
+                pChunk->cursor = SkipLine(pChunk->cursor, end);
                 break;
         }
     }
-
-    // End file reading, write data in the model
-    FillInObjectInfo(pModel);
 }
 
-void xModelLoader::ReadVertexInfo()
+void xModelLoader::ReadVertexInfo(xObjChunk *pChunk)
 {
-    float x = 0, y = 0, z = 0;
-    char strLine[STRING_SIZE] = {0};
-    char ch = 0;
+    float values[3] = {0.0f, 0.0f, 0.0f};
+    const char * end = pChunk->end;
+    const char * c = pChunk->cursor + 1;
+    char type = (c < end ? *c : '\n');
+    int count = 0;
 
-    ch = fgetc(m_FilePointer);
+    // "v x y z", "vt x y", "vn x y z" (other lines are skipped)
+    if (type == ' ' || type == '\t') {
+        count = 3;
+    } else if (type == 't' || type == 'n') {
+        count = (type == 't' ? 2 : 3);
+        c++;
+    }
 
-    // then read vertex coordinates "v x y z"
-    if(ch == ' ') {
-        fscanf(m_FilePointer, "%f %f %f", &x, &y, &z);
-        fgets(strLine, 100, m_FilePointer);
-        m_pVertices.Add(new xPoint3(x, y, z));
-        vertex_offset += 1;
+    for(int i = 0; i < count; i++) {
+        c = ParseFloat(SkipSpaces(c, end), end, &values[i]);
     }
-    // then read texture coordinates "vt x y"
-    else if(ch == 't')
-    {
-        fscanf(m_FilePointer, "%f %f", &x, &y);
-        fgets(strLine, 100, m_FilePointer);
-        m_pTextureCoords.Add(new xPoint2(x, y));
-        m_bObjectHasUV = true;
-        texture_offset += 1;
+
+    if (type == ' ' || type == '\t') {
+        pChunk->vertices.EmplaceBack(values[0], values[1], values[2]);
     }
-    // then read normal coordinates "vn x y z"
-    else if (ch == 'n') {
-        fscanf(m_FilePointer, "%f %f %f", &x, &y, &z);
-        fgets(strLine, 100, m_FilePointer);
-        m_pNormals.Add(new xPoint3(x, y, z));
-        m_bObjectHasNormals = true;
-        normal_offset += 1;
+    else if (type == 't') {
+        pChunk->texcoords.EmplaceBack(values[0], values[1]);
     }
-    // then skip the line
-    else
-    {
-        fgets(strLine, 100, m_FilePointer);
+    else if (type == 'n') {
+        pChunk->normals.EmplaceBack(values[0], values[1], values[2]);
     }
+
+    pChunk->cursor = SkipLine(c, end);
 }
 
-void xModelLoader::ReadFaceInfo()
+void xModelLoader::ReadFaceInfo(xObjChunk *pChunk)
 {
-    xFace * face = new xFace;
-    char strLine[STRING_SIZE];
-    int scanned = 0;
+    const char * end = pChunk->end;
+    const char * c = pChunk->cursor + 1;
+
+    // Line starts with 'f', but it is not a face
+    if (c < end && *c != ' ' && *c != '\t') {
+        pChunk->cursor = SkipLine(c, end);
+        return;
+    }
+
+    // Elements read before the face (for relative indices)
+    long counts[3] = {
+        pChunk->vertices.GetNumOfElements(),
+        pChunk->texcoords.GetNumOfElements(),
+        pChunk->normals.GetNumOfElements()
+    };
 
-    if (m_bObjectHasNormals && m_bObjectHasUV) {
-        scanned = fscanf(m_FilePointer, "%li/%li/%li %li/%li/%li %li/%li/%li",
-               &face->vertex[0], &face->texture[0], &face->normal[0],
-               &face->vertex[1], &face->texture[1], &face->normal[1],
-               &face->vertex[2], &face->texture[2], &face->normal[2]);
+    // The first, the previous and the current corners of the polygon
+    long corners[3][3];
+    unsigned int relative[3];
+    int numOfCorners = 0;
 
-        if (scanned < 9) {
-            printf("ERROR: Mismatched number of scanned params");
-            exit(1);
+    // Corners in formats "v", "v/t", "v//n" and "v/t/n"
+    while (true)
+    {
+        const char * corner = SkipSpaces(c, end);
+        long index[3] = {0, 0, 0};
+
+        c = ParseInt(corner, end, &index[0]);
+        if (c == corner) {
+            break;
         }
-    }
-    else if (m_bObjectHasUV) {
-        scanned = fscanf(m_FilePointer, "%li/%li %li/%li %li/%li",
-               &face->vertex[0], &face->texture[0],
-               &face->vertex[1], &face->texture[1],
-               &face->vertex[2], &face->texture[2]);
 
-        if (scanned < 6) {
-            printf("ERROR: Mismatched number of scanned params");
-            exit(1);
+        if (c < end && *c == '/') {
+            c = ParseInt(c + 1, end, &index[1]);
+
+            if (c < end && *c == '/') {
+                c = ParseInt(c + 1, end, &index[2]);
+            }
         }
-    }
-    else if (m_bObjectHasNormals) {
-        scanned = fscanf(m_FilePointer, "%li//%li %li//%li %li//%li",
-               &face->vertex[0], &face->normal[0],
-               &face->vertex[1], &face->normal[1],
-               &face->vertex[2], &face->normal[2]);
 
-        if (scanned < 6) {
-            printf("ERROR: Mismatched number of scanned params");
-            exit(1);
+        int slot = (numOfCorners < 2 ? numOfCorners : 2);
+        relative[slot] = 0;
+
+        // -1 is the last element read before the face
+        for(int a = 0; a < 3; a++) {
+            if (index[a] < 0) {
+                index[a] += counts[a] + 1;
+                relative[slot] |= 1u << a;
+            }
+            corners[slot][a] = index[a];
         }
-    }
-    else {
-        scanned = fscanf(m_FilePointer, "%li %li %li",
-               &face->vertex[0],
-               &face->vertex[1],
-               &face->vertex[2]);
 
-        if (scanned < 3) {
-            printf("ERROR: Mismatched number of scanned params");
-            exit(1);
+        numOfCorners += 1;
+
+        if (numOfCorners >= 3)
+        {
+            xFace * face = pChunk->faces.EmplaceBack();
+            unsigned int mask = 0;
+
+            for(int j = 0; j < 3; j++) {
+                face->vertex[j] = corners[j][0];
+                face->texture[j] = corners[j][1];
+                face->normal[j] = corners[j][2];
+
+                for(int a = 0; a < 3; a++) {
+                    if (relative[j] & (1u << a)) {
+                        mask |= 1u << (3 * a + j);
+                    }
+                }
+            }
+
+            if (mask != 0) {
+                xObjFixup * fixup = pChunk->fixups.EmplaceBack();
+                fixup->face = pChunk->faces.GetNumOfElements() - 1;
+                fixup->mask = mask;
+            }
+
+            // The current corner is the previous one for the next triangle
+            for(int a = 0; a < 3; a++) {
+                corners[1][a] = corners[2][a];
+            }
+            relative[1] = relative[2];
         }
     }
 
-    m_pFaces.Add(face);
-    fgets(strLine, 100, m_FilePointer);
-    m_bJustReadAFace = true;
+    // Parsing of the chunk is stopped on the wrong face
+    if (numOfCorners < 3) {
+        pChunk->error = pChunk->cursor;
+        pChunk->cursor = SkipLine(c, end);
+        return;
+    }
+
+    if (pChunk->firstLine == xObjChunk::LINE_NONE) {
+        pChunk->firstLine = xObjChunk::LINE_FACE;
+    }
+
+    pChunk->lastLine = xObjChunk::LINE_FACE;
+    pChunk->cursor = SkipLine(c, end);
+}
+
+void xModelLoader::ReadNameInfo(xObjChunk *pChunk)
+{
+    const char * end = pChunk->end;
+    const char * c = pChunk->cursor;
+    const char * eol = SkipLine(c, end);
+    const char * word = SkipWord(c, eol);
+
+    bool isMaterial = IsKeyword(c, word, "usemtl");
+    bool isLibrary = IsKeyword(c, word, "mtllib");
+
+    if (isMaterial || isLibrary) {
+        xObjName * name = (isMaterial ? pChunk->materials.EmplaceBack() : pChunk->libraries.EmplaceBack());
+        name->face = pChunk->faces.GetNumOfElements();
+        name->name = SkipSpaces(word, eol);
+        name->length = TrimLine(name->name, eol) - name->name;
+    }
+
+    pChunk->cursor = eol;
 }
 
-void xModelLoader::FillInObjectInfo(xModel3d *pModel)
+void xModelLoader::FillInObjectInfo(xModel3d *pModel, const xObjBreak &from, const xObjBreak &to,
+                                    long firstFace, long lastFace, long materialId)
 {
     xObject3d * pObject = new xObject3d;
     pModel->m_objects->Add(pObject);
     pModel->num_objects += 1;
 
-    pObject->num_vertexes = m_pVertices.GetNumOfElements();
-    pObject->num_textcords = m_pTextureCoords.GetNumOfElements();
-    pObject->num_normals = m_pNormals.GetNumOfElements();
-    pObject->num_faces = m_pFaces.GetNumOfElements();
+    CopyRange(*pObject->m_faces, m_chunks, m_numOfChunks, &xObjChunk::faces, &xObjBreak::faces,
+              firstFace, lastFace);
 
-    for(long i = 0; i < pObject->num_vertexes; i++) {
-        pObject->m_vertexes->Add(m_pVertices.GetElement(i));
+    // Indices of the file are global and start from 1
+    xFace * faces = pObject->m_faces->Data();
+    for(long i = 0; i < pObject->m_faces->GetNumOfElements(); i++) {
+        for(int j = 0; j < 3; j++) {
+            faces[i].vertex[j] -= 1 + from.vertices;
+            faces[i].texture[j] -= 1 + from.texcoords;
+            faces[i].normal[j] -= 1 + from.normals;
+        }
     }
 
-    for(long i = 0; i < pObject->num_textcords; i++) {
-        pObject->m_textcords->Add(m_pTextureCoords.GetElement(i));
+    // Object split by materials gets only elements used by its faces,
+    // other object gets the whole range (without copying, if object
+    // is in one chunk)
+    if (firstFace != from.faces || lastFace != to.faces)
+    {
+        CopyUsed(*pObject->m_vertexes, m_remap, m_chunks, m_numOfChunks, &xObjChunk::vertices,
+                 &xObjBreak::vertices, from.vertices, to.vertices, *pObject->m_faces, &xFace::vertex);
+        CopyUsed(*pObject->m_textcords, m_remap, m_chunks, m_numOfChunks, &xObjChunk::texcoords,
+                 &xObjBreak::texcoords, from.texcoords, to.texcoords, *pObject->m_faces, &xFace::texture);
+        CopyUsed(*pObject->m_normals, m_remap, m_chunks, m_numOfChunks, &xObjChunk::normals,
+                 &xObjBreak::normals, from.normals, to.normals, *pObject->m_faces, &xFace::normal);
     }
+    else
+    {
+        CopyRange(*pObject->m_vertexes, m_chunks, m_numOfChunks, &xObjChunk::vertices, &xObjBreak::vertices,
+                  from.vertices, to.vertices);
+        CopyRange(*pObject->m_textcords, m_chunks, m_numOfChunks, &xObjChunk::texcoords, &xObjBreak::texcoords,
+                  from.texcoords, to.texcoords);
+        CopyRange(*pObject->m_normals, m_chunks, m_numOfChunks, &xObjChunk::normals, &xObjBreak::normals,
+                  from.normals, to.normals);
+    }
+
+    pObject->m_MaterialId = materialId;
 
-    for(long i = 0; i < pObject->num_normals; i++) {
-        pObject->m_normals->Add(m_pNormals.GetElement(i));
+    pObject->num_vertexes = pObject->m_vertexes->GetNumOfElements();
+    pObject->num_textcords = pObject->m_textcords->GetNumOfElements();
+    pObject->num_normals = pObject->m_normals->GetNumOfElements();
+    pObject->num_faces = pObject->m_faces->GetNumOfElements();
+}
+
+void xModelLoader::PrintACMR(xModel3d *pModel, long firstObject, char *strFileName)
+{
+    double before = 0.0;
+    double after = 0.0;
+    long numOfTriangles = 0;
+
+    // ACMR of the model is weighted by triangles of objects
+    for(long i = firstObject; i < pModel->num_objects; i++) {
+        xObject3d * pObject = pModel->m_objects->GetElement(i);
+        long triangles = pObject->num_indices / 3;
+        before += pObject->acmr_before * triangles;
+        after += pObject->acmr_after * triangles;
+        numOfTriangles += triangles;
     }
 
-    for(long i = 0; i < pObject->num_faces; i++) {
-        pObject->m_faces->Add(m_pFaces.GetElement(i));
+    if (numOfTriangles > 0) {
+        printf("INFO: Optimized %s (ACMR %.3lf -> %.3lf) \n", strFileName, before / numOfTriangles,
+               after / numOfTriangles);
+    }
+}
 
-        for(int j = 0; j < 3; j++) {
-            m_pFaces.GetElement(i)->vertex[j] -= 1 + vertex_offset_prev;
-            m_pFaces.GetElement(i)->texture[j] -= 1 + texture_offset_prev;
-            m_pFaces.GetElement(i)->normal[j] -= 1 + normal_offset_prev;
+void xModelLoader::PrintLods(xModel3d *pModel, long firstObject, char *strFileName)
+{
+    long numOfTriangles[MESH_MAX_LODS + 1] = { 0 };
+    long numOfLevels = 0;
+
+    // Object without some level is counted with its simplest level
+    for(long i = firstObject; i < pModel->num_objects; i++)
+    {
+        xObject3d * pObject = pModel->m_objects->GetElement(i);
+        numOfLevels = (pObject->num_lods > numOfLevels ? pObject->num_lods : numOfLevels);
+
+        long triangles = pObject->num_indices / 3;
+        numOfTriangles[0] += triangles;
+
+        for(long j = 0; j < MESH_MAX_LODS; j++) {
+            if (j < pObject->num_lods) {
+                triangles = (*pObject->m_lods)[j].numOfIndices / 3;
+            }
+            numOfTriangles[j + 1] += triangles;
         }
     }
 
-    m_pVertices.Clear();
-    m_pTextureCoords.Clear();
-    m_pNormals.Clear();
-    m_pFaces.Clear();
+    char levels[256];
+    int length = 0;
 
-    m_bObjectHasUV = false;
-    m_bObjectHasNormals = false;
-    m_bJustReadAFace = false;
+    for(long j = 0; j <= numOfLevels; j++) {
+        length += snprintf(levels + length, sizeof(levels) - length, (j == 0 ? "%ld" : " -> %ld"),
+                           numOfTriangles[j]);
+    }
 
-    vertex_offset_prev += vertex_offset;
-    texture_offset_prev += texture_offset;
-    normal_offset_prev += normal_offset;
+    printf("INFO: Built %ld LOD levels of %s (triangles %s) \n", numOfLevels, strFileName, levels);
+}
 
-    vertex_offset = 0;
-    texture_offset = 0;
-    normal_offset = 0;
+void xModelLoader::PrintCompression(char *strFileName)
+{
+    xCompressionReport report = m_processor.GetCompressionReport();
+    printf("INFO: Compressed %s (%.2lf MB -> %.2lf MB, max errors: position %g, normal %.3f deg, texcoord %g) \n",
+           strFileName, report.bytesBefore / (1024.0 * 1024.0), report.bytesAfter / (1024.0 * 1024.0),
+           report.positionError, report.normalError, report.texcoordError);
+}
+
+long xModelLoader::FindMaterial(xModel3d *pModel, long firstMaterial, const char *name, long length)
+{
+    for(long i = firstMaterial; i < pModel->num_materials; i++) {
+        char * materialName = pModel->m_materials->GetElement(i)->materialName;
+        if (strncmp(materialName, name, length) == 0 && materialName[length] == '\0') {
+            return i;
+        }
+    }
+
+    printf("WARNING: Material %.*s is not found (default material is used) \n", (int)length, name);
+
+    xMaterial * pMaterial = new xMaterial;
+    snprintf(pMaterial->materialName, STRING_SIZE, "%.*s", (int)length, name);
+    pMaterial->SetDiffuse(0.8f, 0.8f, 0.8f);
+
+    pModel->m_materials->Add(pMaterial);
+    pModel->num_materials += 1;
+
+    return pModel->num_materials - 1;
+}
+
+bool xModelLoader::ImportMtl(xModel3d *pModel, char *strFileName)
+{
+    xMappedFile file;
+    if (!file.Open(strFileName)) {
+        return false;
+    }
+
+    // Textures are found relatively to the library
+    char directory[STRING_SIZE];
+    GetDirectory(strFileName, directory, STRING_SIZE);
+
+    const char * c = file.GetData();
+    const char * end = c + file.GetSize();
+
+    xMaterial * pMaterial = NULL;
+    long numOfMaterials = 0;
+
+    while (c < end)
+    {
+        c = SkipSpaces(c, end);
+
+        const char * eol = SkipLine(c, end);
+        const char * word = SkipWord(c, eol);
+        const char * value = SkipSpaces(word, eol);
+        const char * valueEnd = TrimLine(value, eol);
+
+        if (IsKeyword(c, word, "newmtl"))
+        {
+            pMaterial = new xMaterial;
+            snprintf(pMaterial->materialName, STRING_SIZE, "%.*s", (int)(valueEnd - value), value);
+
+            pModel->m_materials->Add(pMaterial);
+            pModel->num_materials += 1;
+            numOfMaterials += 1;
+        }
+        else if (pMaterial != NULL && (IsKeyword(c, word, "Ka") || IsKeyword(c, word, "Kd") ||
+                                       IsKeyword(c, word, "Ks") || IsKeyword(c, word, "Ke")))
+        {
+            // "Kd r g b" or "Kd r" (the same value for all components),
+            // other formats ("Kd spectral ...") are skipped
+            float color[3] = {0.0f, 0.0f, 0.0f};
+            int count = 0;
+
+            while (count < 3) {
+                const char * number = SkipSpaces(value, valueEnd);
+                value = ParseFloat(number, valueEnd, &color[count]);
+                if (value == number) {
+                    break;
+                }
+                count += 1;
+            }
+
+            if (count == 1) {
+                color[1] = color[2] = color[0];
+            }
+
+            switch (count > 0 ? c[1] : '\0')
+            {
+                case 'a':
+                    pMaterial->SetAmbient(color[0], color[1], color[2]);
+                    break;
+                case 'd':
+                    pMaterial->SetDiffuse(color[0], color[1], color[2]);
+                    break;
+                case 's':
+                    pMaterial->SetSpecular(color[0], color[1], color[2]);
+                    break;
+                case 'e':
+                    pMaterial->SetEmission(color[0], color[1], color[2]);
+                    break;
+                default:
+                    break;
+            }
+        }
+        else if (pMaterial != NULL && IsKeyword(c, word, "Ns"))
+        {
+            // Exponent of .mtl is in [0, 1000], of OpenGL is in [0, 128]
+            float exponent = 0.0f;
+            ParseFloat(value, valueEnd, &exponent);
+            pMaterial->SetShininess((int)(exponent * 128.0f / 1000.0f + 0.5f));
+        }
+        else if (pMaterial != NULL && IsKeyword(c, word, "map_Kd"))
+        {
+            // Options of the texture are skipped: file is the last word
+            const char * name = valueEnd;
+            while (name > value && name[-1] != ' ' && name[-1] != '\t') {
+                name--;
+            }
+
+            char textureName[STRING_SIZE];
+            snprintf(textureName, STRING_SIZE, "%.*s", (int)(valueEnd - name), name);
+
+            for(char * s = textureName; *s != '\0'; s++) {
+                if (*s == '\\') {
+                    *s = '/';
+                }
+            }
+
+            pMaterial->SetTextureName(textureName, directory);
+        }
+
+        c = eol;
+    }
+
+    printf("INFO: Imported %s (%ld materials) \n", strFileName, numOfMaterials);
+    return true;
 }
 
 void xModelLoader::SetObjectMaterial(xModel3d *pModel, int whichObject, int materialID)
 {
+    if (!pModel || whichObject < 0 || whichObject >= pModel->num_objects ||
+        materialID < -1 || materialID >= pModel->num_materials) {
+        printf("WARNING: Cannot set material %i for object %i \n", materialID, whichObject);
+        return;
+    }
 
+    pModel->m_objects->GetElement(whichObject)->m_MaterialId = materialID;
 }
 
 void xModelLoader::AddMaterial(xModel3d *pModel, char *strName, char *strFile)
 {
+    if (!pModel || !strName) {
+        printf("WARNING: Cannot add material without model or name \n");
+        return;
+    }
 
+    xMaterial * pMaterial = new xMaterial;
+    snprintf(pMaterial->materialName, STRING_SIZE, "%s", strName);
+    pMaterial->SetDiffuse(1.0f, 1.0f, 1.0f);
+
+    pModel->m_materials->Add(pMaterial);
+    pModel->num_materials += 1;
+
+    // Texture is shared with other materials with the same file
+    if (strFile != NULL) {
+        char directory[STRING_SIZE];
+        GetDirectory(strFile, directory, STRING_SIZE);
+        pMaterial->SetTextureName(strFile + strlen(directory), directory);
+        pMaterial->LoadTexture(m_textureManager);
+    }
 }
\ No newline at end of file
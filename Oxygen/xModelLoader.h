@@ -9,6 +9,90 @@
 #ifndef OXYGEN_XMODELLOADER_H
 #define OXYGEN_XMODELLOADER_H
 
+#define MODEL_IMPORT_DONE           0   // Model is imported (or there is no import)
+#define MODEL_IMPORT_PENDING        1   // Import is not finished: Step should be called again
+#define MODEL_IMPORT_ERROR_ARGS     -1  // Model or file name is NULL
+#define MODEL_IMPORT_ERROR_BUSY     -2  // Other import of the loader is not finished
+#define MODEL_IMPORT_ERROR_OPEN     -3  // File cannot be opened
+#define MODEL_IMPORT_ERROR_PARSE    -4  // File has line with wrong format
+
+// ----------------------------------------------------------------------
+// Numbers of elements read before the start of the object
+// ----------------------------------------------------------------------
+
+struct xObjBreak
+{
+    long vertices;
+    long texcoords;
+    long normals;
+    long faces;
+};
+
+// ----------------------------------------------------------------------
+// Face with relative (negative) indices, which are counted from the start
+// of the chunk and should be moved by the base of the chunk. Bit
+// (3 * attribute + corner) of mask is set for each relative index
+// (attributes: 0 - vertex, 1 - texture, 2 - normal)
+// ----------------------------------------------------------------------
+
+struct xObjFixup
+{
+    long face;
+    unsigned int mask;
+};
+
+// ----------------------------------------------------------------------
+// Name from "usemtl" or "mtllib" line (points in the mapped file) with
+// number of faces read before the line
+// ----------------------------------------------------------------------
+
+struct xObjName
+{
+    long face;
+    const char * name;
+    long length;
+};
+
+// ----------------------------------------------------------------------
+// Elements of the file, which become one object (faces [firstFace,
+// lastFace) of one material and elements between two object starts)
+// ----------------------------------------------------------------------
+
+struct xObjPiece
+{
+    xObjBreak from;
+    xObjBreak to;
+    long firstFace;
+    long lastFace;
+    long materialId;
+};
+
+// ----------------------------------------------------------------------
+// Part of the file (whole lines), which is parsed by one thread
+// ----------------------------------------------------------------------
+
+struct xObjChunk
+{
+    enum Line { LINE_NONE, LINE_VERTEX, LINE_FACE };
+
+    const char * begin;                         // First line of the chunk
+    const char * end;                           // End of the last line of the chunk
+    const char * cursor;                        // Current position in the chunk
+
+    xValueArray<xPoint3> vertices;              // Vertices of the chunk
+    xValueArray<xPoint2> texcoords;             // Texture coordinates of the chunk
+    xValueArray<xPoint3> normals;               // Normals of the chunk
+    xValueArray<xFace> faces;                   // Faces (with global indices from the file)
+    xValueArray<xObjBreak> breaks;              // Starts of objects inside the chunk
+    xValueArray<xObjFixup> fixups;              // Faces with relative indices
+    xValueArray<xObjName> materials;            // Materials used by the next faces (usemtl)
+    xValueArray<xObjName> libraries;            // Material libraries (mtllib)
+
+    Line firstLine;                             // First 'v' or 'f' line of the chunk
+    Line lastLine;                              // Last 'v' or 'f' line of the chunk
+    xObjBreak base;                             // Elements in all the previous chunks
+    const char * error;                         // First line with wrong format (or NULL)
+};
 
 class xModelLoader {
 
@@ -19,8 +103,29 @@ public:
 
     // Вы будете вызывать только эту функцию. Просто передаёте структуру
     // модели для сохранения данных, и имя файла для загрузки.
+    // Program is terminated, if file cannot be imported
     void ImportObj(xModel3d * pModel, char * strFileName);
 
+    // Starts import of the file, which is done by the next Step calls
+    // (model and name should exist until import is finished). Returns
+    // MODEL_IMPORT_PENDING or error code
+    int BeginImport(xModel3d * pModel, char * strFileName);
+
+    // Continues import for about budget_ms milliseconds (for example, in
+    // xState::Update of loading screen). File is parsed by parts of
+    // OBJ_STEP_SIZE bytes, objects are created, indexed (by parts of
+    // OBJ_STEP_FACES faces) and compressed one by one, one texture is
+    // loaded by one part. Parts, which are not split and can take more
+    // than the budget on large files: loading of the cache, merging of
+    // parsed data (with .mtl libraries), order optimization and LODs of
+    // one object, saving of the cache. Returns MODEL_IMPORT_PENDING,
+    // MODEL_IMPORT_DONE or error code (objects are not added in the
+    // model, if file cannot be parsed)
+    int Step(double budget_ms);
+
+    // Returns estimated part of import, which is done [0, 1]
+    float GetProgress();
+
     // Так как .obj файлы не хранят имен текстур и информации о материалах, мы создадим
     // функцию, устанавливающую их вручную. materialID - индекс для массива pMaterial нашей модели.
     void SetObjectMaterial(xModel3d * pModel, int whichObject, int materialID);
@@ -30,40 +135,144 @@ public:
     // Если нам нужен только цвет, передаём NULL для strFile.
     void AddMaterial(xModel3d *pModel, char *strName, char *strFile);
 
+    // Loads materials of .mtl library in the model (textures are loaded
+    // through the texture manager). Returns false, if file is not found
+    bool ImportMtl(xModel3d *pModel, char *strFileName);
+
+    // Sets manager, which shares textures of materials between models
+    // (without manager textures are not loaded)
+    void SetTextureManager(xResourceManager<xTexture> * manager);
+
+    // Turns on (or off) binary cache of imported files (on by default).
+    // Cache is saved next to the .obj file and is loaded instead of it
+    void SetCacheEnabled(bool enabled);
+
+    // Turns on (or off) optimization of triangles order of imported
+    // objects for vertex cache and overdraw (on by default)
+    void SetOptimizeEnabled(bool enabled);
+
+    // Turns on (or off) building of simplified levels (LOD) of
+    // imported objects (on by default)
+    void SetLodEnabled(bool enabled);
+
+    // Turns on (or off) compression of vertices of imported objects
+    // (off by default). Compressed objects keep only indexed data. It
+    // reduces CPU memory only, GPU buffers keep float vertices
+    void SetCompressEnabled(bool enabled);
+
+    // Sets number of threads for parsing (0 - number of CPU cores).
+    // Small files are parsed by one thread
+    void SetNumOfThreads(unsigned int num_threads);
+
 protected:
 
-    // Главный загружающий цикл, вызывающийся из ImportObj()
+    // Does the next part of the import stage. Returns MODEL_IMPORT_PENDING,
+    // if import is not finished
+    int StepStage();
+
+    // Loads model from the cache or opens the file and splits it in chunks
+    int OpenObjFile();
+
+    // Parses all the chunks in parallel threads (or the next OBJ_STEP_SIZE
+    // bytes of one chunk)
+    int ParseObjFile();
+
+    // Merges the parsed chunks and splits them in pieces of objects
+    // (materials of libraries are added in the model)
     void ReadObjFile(xModel3d *pModel);
 
-    // Вызывается в ReadObjFile() если линия начинается с 'v'
-    void ReadVertexInfo();
+    // Creates object of the model from the next piece of the file
+    int CreateObject();
 
-    // Вызывается в ReadObjFile() если линия начинается с 'f'
-    void ReadFaceInfo();
+    // Loads texture of the next material of the import
+    int LoadTexture();
 
-    // Вызывается после загрузки информации полигонов
-    void FillInObjectInfo(xModel3d *pModel);
+    // Processes the next object (or the next faces of large object on
+    // index stage) on index, optimize, LOD and compress stages
+    int ProcessObject();
 
-private:
+    // Prints import info and ends the import
+    int FinishObjFile();
+
+    // Goes to the next enabled stage of the import
+    void NextStage();
+
+    // Returns true, if stage is done by the current import
+    bool IsStageEnabled(int stage);
 
-    long vertex_offset;
-    long texture_offset;
-    long normal_offset;
+    // Releases data of the import and saves its result
+    int EndImport(int result);
+
+    // Parses lines of one part of the file, which start before stop
+    // (in its own thread)
+    void ParseChunk(xObjChunk *pChunk, const char *stop);
+
+    // Вызывается в ParseChunk() если линия начинается с 'v'
+    void ReadVertexInfo(xObjChunk *pChunk);
+
+    // Вызывается в ParseChunk() если линия начинается с 'f'.
+    // Polygons are split in triangles (fan from the first corner)
+    void ReadFaceInfo(xObjChunk *pChunk);
+
+    // Called in ParseChunk() for "usemtl" and "mtllib" lines
+    void ReadNameInfo(xObjChunk *pChunk);
+
+    // Creates object from the elements of the file between two object starts
+    // (faces [firstFace, lastFace) of them, if object is split by materials)
+    void FillInObjectInfo(xModel3d *pModel, const xObjBreak &from, const xObjBreak &to,
+                          long firstFace, long lastFace, long materialId);
+
+    // Returns index of the material of the model with such name (material
+    // with default parameters is added, if there is no such one)
+    long FindMaterial(xModel3d *pModel, long firstMaterial, const char *name, long length);
+
+    // Prints ACMR of imported objects before and after optimization
+    void PrintACMR(xModel3d *pModel, long firstObject, char *strFileName);
+
+    // Prints number of triangles of each level of imported objects
+    void PrintLods(xModel3d *pModel, long firstObject, char *strFileName);
+
+    // Prints memory and errors of compressed objects
+    void PrintCompression(char *strFileName);
+
+private:
 
-    long vertex_offset_prev;
-    long texture_offset_prev;
-    long normal_offset_prev;
+    // Stages of the import (disabled stages are skipped)
+    enum Stage { STAGE_NONE, STAGE_OPEN, STAGE_PARSE, STAGE_MERGE, STAGE_OBJECTS, STAGE_TEXTURES,
+                 STAGE_INDEX, STAGE_OPTIMIZE, STAGE_LODS, STAGE_SAVE, STAGE_COMPRESS, STAGE_FINISH };
 
-    bool m_bObjectHasUV;                        // If object has texture coordinates
-    bool m_bObjectHasNormals;                   // If object has normak vectors
-    bool m_bJustReadAFace;                      // If object is read and we need to write data in the xObject
+    unsigned int m_numOfThreads;                // Max number of parsing threads
+    bool m_useCache;                            // Load (and save) binary cache of the files
+    bool m_optimize;                            // Optimize order of triangles of imported objects
+    bool m_buildLods;                           // Build simplified levels of imported objects
+    bool m_compress;                            // Compress vertices of imported objects
+    xMeshCache m_cache;                         // Binary cache of imported files
+    xMeshProcessor m_processor;                 // Builds indexed data of imported objects
+    xResourceManager<xTexture> * m_textureManager;  // Shared textures of materials
 
-    FILE * m_FilePointer;                       // Pointer to opening model file
+    xMappedFile m_file;                         // Mapped model file
+    char * m_fileName;                          // Name of the imported file
+    xObjChunk * m_chunks;                       // Parts of the file parsed in parallel
+    unsigned int m_numOfChunks;                 // Number of parts
+    xValueArray<long> m_remap;                  // New indices of elements of object split by materials
+    xValueArray<xObjPiece> m_pieces;            // Pieces of the file, which become objects
 
-    xDynamicArray<xPoint3>  m_pVertices;        // Object vertices
-    xDynamicArray<xPoint2>  m_pTextureCoords;   // Object texture coordinates
-    xDynamicArray<xPoint3> m_pNormals;          // Object normals
-    xDynamicArray<xFace> m_pFaces;              // Object faces
+    Stage m_stage;                              // Current stage of the import
+    bool m_isBlocking;                          // Import is done by one call (ImportObj)
+    int m_result;                               // Result of the last import
+    float m_progress;                           // Progress of the last import
+    xModel3d * m_model;                         // Model of the import
+    unsigned int m_flags;                       // Import options (MESH_CACHE_OPTIMIZED, MESH_CACHE_LODS)
+    long m_firstObject;                         // First object of the imported file
+    long m_firstMaterial;                       // First material of the imported file
+    long m_nextObject;                          // Next object to process on the current stage
+    long m_nextPiece;                           // Next piece of the file to create object
+    long m_nextMaterial;                        // Next material to load its texture
+    long m_numOfTextures;                       // Textures of materials of the import
+    xResourceStats m_textureStats;              // Stats of texture manager before textures stage
+    bool m_isCached;                            // Objects are loaded from the cache
+    bool m_isIndexing;                          // Object m_nextObject is partly indexed
+    std::chrono::steady_clock::time_point m_start;  // Start time of the import
 
 };
 
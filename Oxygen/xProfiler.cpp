@@ -0,0 +1,323 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 20.02.2018.
+ * Copyright
+ *
+ * Realisation of functions defined in the file
+ * xProfiler.h. Go there to find more information
+ * and interface specifications
+ */
+
+#include "xEngine.h"
+
+xProfiler * g_profiler = NULL;
+
+// Ring buffer of the thread and number of the profiler, which owns it
+// (new profiler creates new ring buffers)
+static thread_local xProfileThread * t_thread = NULL;
+static thread_local unsigned long t_generation = 0;
+
+static std::atomic<unsigned long> s_generations(0);
+
+xProfiler::xProfiler(bool enabled)
+{
+    m_enabled = enabled;
+    m_inFrame = false;
+    m_frameStart = 0.0;
+    m_start = std::chrono::steady_clock::now();
+    m_generation = ++s_generations;
+
+    m_numOfThreads = 0;
+    for(unsigned int i = 0; i < PROFILER_MAX_THREADS; i++) {
+        m_threads[i] = NULL;
+    }
+
+    m_isCapturing = false;
+}
+
+xProfiler::~xProfiler()
+{
+    for(unsigned int i = 0; i < m_numOfThreads; i++) {
+        SAFE_DELETE(m_threads[i]);
+    }
+}
+
+void xProfiler::SetEnabled(bool enabled)
+{
+    m_enabled = enabled;
+}
+
+bool xProfiler::IsEnabled()
+{
+    return m_enabled;
+}
+
+void xProfiler::BeginFrame()
+{
+    if (m_inFrame) {
+        EndFrame();
+    }
+
+    m_inFrame = true;
+    m_frameStart = GetTime();
+}
+
+void xProfiler::EndFrame()
+{
+    if (!m_inFrame) {
+        return;
+    }
+
+    m_inFrame = false;
+
+    if (!m_enabled) {
+        return;
+    }
+
+    double frameEnd = GetTime();
+
+    unsigned int numOfThreads;
+    {
+        std::unique_lock<std::mutex> lock(m_threadsMutex);
+        numOfThreads = m_numOfThreads;
+    }
+
+    for(unsigned int i = 0; i < numOfThreads; i++) {
+        Collect(m_threads[i]);
+    }
+
+    GetCounter("Frame")->frame = (frameEnd - m_frameStart) / 1000.0;
+
+    if (m_isCapturing) {
+        xProfileEvent event;
+        event.name = "Frame";
+        event.start = m_frameStart;
+        event.end = frameEnd;
+        event.depth = 0;
+        event.thread = (GetThread() != NULL ? GetThread()->id : 0);
+        m_trace.Add(event);
+    }
+
+    // Saves time of the frame for each scope (0 if scope was not measured)
+    for(long i = 0; i < m_counters.GetNumOfElements(); i++)
+    {
+        Counter & counter = m_counters[i];
+
+        counter.history[counter.numOfFrames % PROFILER_HISTORY_SIZE] = counter.frame;
+        counter.numOfFrames += 1;
+        counter.frame = 0.0;
+    }
+}
+
+bool xProfiler::GetStats(const char * name, xProfileStats * stats)
+{
+    if (name == NULL || stats == NULL) {
+        return false;
+    }
+
+    Counter * counter = NULL;
+    for(long i = 0; i < m_counters.GetNumOfElements(); i++) {
+        if (strcmp(m_counters[i].name, name) == 0) {
+            counter = &m_counters[i];
+            break;
+        }
+    }
+
+    if (counter == NULL || counter->numOfFrames == 0) {
+        return false;
+    }
+
+    unsigned long count = counter->numOfFrames;
+    if (count > PROFILER_HISTORY_SIZE) {
+        count = PROFILER_HISTORY_SIZE;
+    }
+
+    double sorted[PROFILER_HISTORY_SIZE];
+    double sum = 0.0;
+
+    for(unsigned long i = 0; i < count; i++) {
+        sorted[i] = counter->history[i];
+        sum += sorted[i];
+    }
+
+    std::sort(sorted, sorted + count);
+
+    unsigned long p99 = (unsigned long)ceil(0.99 * count);
+
+    stats->last = counter->history[(counter->numOfFrames - 1) % PROFILER_HISTORY_SIZE];
+    stats->min = sorted[0];
+    stats->avg = sum / count;
+    stats->p99 = sorted[p99 - 1];
+    stats->max = sorted[count - 1];
+    stats->numOfFrames = count;
+
+    return true;
+}
+
+void xProfiler::StartCapture()
+{
+    m_trace.Clear();
+    m_isCapturing = true;
+}
+
+bool xProfiler::StopCapture(const char * filename)
+{
+    m_isCapturing = false;
+
+    FILE * file = fopen(filename, "w");
+    if (file == NULL) {
+        printf("ERROR: Cannot open file %s for trace \n", filename);
+        return false;
+    }
+
+    fprintf(file, "{\"traceEvents\":[\n");
+
+    {
+        std::unique_lock<std::mutex> lock(m_threadsMutex);
+
+        for(unsigned int i = 0; i < m_numOfThreads; i++) {
+            fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"%s\"}},\n",
+                    m_threads[i]->id, m_threads[i]->name);
+        }
+    }
+
+    for(long i = 0; i < m_trace.GetNumOfElements(); i++)
+    {
+        xProfileEvent & event = m_trace[i];
+
+        fprintf(file, "{\"name\":\"%s\",\"cat\":\"oxygen\",\"ph\":\"X\",\"ts\":%.3lf,\"dur\":%.3lf,\"pid\":0,\"tid\":%u}%s\n",
+                event.name, event.start, event.end - event.start, event.thread,
+                (i + 1 < m_trace.GetNumOfElements() ? "," : ""));
+    }
+
+    fprintf(file, "]}\n");
+    fclose(file);
+
+    printf("INFO: Saved %li profiler events in %s \n", m_trace.GetNumOfElements(), filename);
+    m_trace.EmptyMass();
+
+    return true;
+}
+
+void xProfiler::SetThreadName(const char * name)
+{
+    xProfileThread * thread = GetThread();
+
+    if (thread != NULL && name != NULL) {
+        strncpy(thread->name, name, STRING_SIZE - 1);
+        thread->name[STRING_SIZE - 1] = '\0';
+    }
+}
+
+double xProfiler::GetTime()
+{
+    std::chrono::duration<double, std::micro> time = std::chrono::steady_clock::now() - m_start;
+    return time.count();
+}
+
+xProfileThread * xProfiler::GetThread()
+{
+    if (t_thread != NULL && t_generation == m_generation) {
+        return t_thread;
+    }
+
+    std::unique_lock<std::mutex> lock(m_threadsMutex);
+
+    if (m_numOfThreads == PROFILER_MAX_THREADS) {
+        return NULL;
+    }
+
+    xProfileThread * thread = new xProfileThread;
+    thread->written = 0;
+    thread->read = 0;
+    thread->depth = 0;
+    thread->id = m_numOfThreads;
+    sprintf(thread->name, "Thread %u", thread->id);
+
+    m_threads[m_numOfThreads] = thread;
+    m_numOfThreads += 1;
+
+    t_thread = thread;
+    t_generation = m_generation;
+
+    return thread;
+}
+
+xProfiler::Counter * xProfiler::GetCounter(const char * name)
+{
+    // Names are string literals, therefore pointers are compared first
+    for(long i = 0; i < m_counters.GetNumOfElements(); i++) {
+        if (m_counters[i].name == name || strcmp(m_counters[i].name, name) == 0) {
+            return &m_counters[i];
+        }
+    }
+
+    Counter * counter = m_counters.EmplaceBack();
+    counter->name = name;
+    counter->frame = 0.0;
+    counter->numOfFrames = 0;
+
+    return counter;
+}
+
+void xProfiler::Collect(xProfileThread * thread)
+{
+    unsigned long written = thread->written.load(std::memory_order_acquire);
+    unsigned long read = thread->read.load(std::memory_order_relaxed);
+
+    for(; read < written; read++)
+    {
+        xProfileEvent & event = thread->events[read % PROFILER_RING_SIZE];
+
+        GetCounter(event.name)->frame += (event.end - event.start) / 1000.0;
+
+        if (m_isCapturing) {
+            m_trace.Add(event);
+        }
+    }
+
+    // Frees read events for the owner thread
+    thread->read.store(read, std::memory_order_release);
+}
+
+xProfileScope::xProfileScope(const char * name)
+{
+    m_thread = NULL;
+
+    if (g_profiler == NULL || !g_profiler->IsEnabled()) {
+        return;
+    }
+
+    m_thread = g_profiler->GetThread();
+
+    if (m_thread != NULL) {
+        m_name = name;
+        m_thread->depth += 1;
+        m_start = g_profiler->GetTime();
+    }
+}
+
+xProfileScope::~xProfileScope()
+{
+    if (m_thread == NULL) {
+        return;
+    }
+
+    m_thread->depth -= 1;
+
+    // Event is dropped, if main thread has not read the buffer yet
+    unsigned long written = m_thread->written.load(std::memory_order_relaxed);
+    if (written - m_thread->read.load(std::memory_order_acquire) >= PROFILER_RING_SIZE) {
+        return;
+    }
+
+    xProfileEvent & event = m_thread->events[written % PROFILER_RING_SIZE];
+
+    event.name = m_name;
+    event.start = m_start;
+    event.end = g_profiler->GetTime();
+    event.depth = m_thread->depth;
+    event.thread = m_thread->id;
+
+    m_thread->written.store(written + 1, std::memory_order_release);
+}
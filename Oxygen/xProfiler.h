@@ -0,0 +1,224 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 20.02.2018.
+ * Copyright
+ *
+ * xProfiler releases CPU frame profiler. Code is
+ * instrumented by X_PROFILE_SCOPE(name) macro,
+ * which measures time of the enclosing block.
+ * Scopes can be nested and used on any thread:
+ * each thread writes its events in its own ring
+ * buffer without locks (if buffer is full, new
+ * events of the thread are dropped). Events are collected on
+ * the main thread by EndFrame, where time of each
+ * scope is summed for the frame and min/avg/p99
+ * statistics for the last frames are counted.
+ * Captured events can be saved in Chrome trace
+ * format (chrome://tracing, ui.perfetto.dev)
+ */
+
+#ifndef OXYGEN_XPROFILER_H
+#define OXYGEN_XPROFILER_H
+
+#include "xEngine.h"
+
+#define PROFILER_RING_SIZE      16384   // Events in the ring buffer of each thread
+#define PROFILER_HISTORY_SIZE   256     // Frames for statistics of each scope
+#define PROFILER_MAX_THREADS    64      // Threads, which can write events
+
+// ----------------------------------------------------------------------
+// Measures time of the enclosing block (name should be string literal).
+// Define OXYGEN_NO_PROFILER to remove all the scopes from the code
+// ----------------------------------------------------------------------
+
+#ifdef OXYGEN_NO_PROFILER
+    #define X_PROFILE_SCOPE(name)
+#else
+    #define X_PROFILE_CONCAT_(a, b) a##b
+    #define X_PROFILE_CONCAT(a, b) X_PROFILE_CONCAT_(a, b)
+    #define X_PROFILE_SCOPE(name) xProfileScope X_PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#endif
+
+// ----------------------------------------------------------------------
+// One measured scope
+// ----------------------------------------------------------------------
+
+struct xProfileEvent
+{
+    const char * name;          // Name of the scope (string literal)
+    double start;               // Start time (in microseconds from profiler creation)
+    double end;                 // End time (in microseconds from profiler creation)
+    unsigned int depth;         // Depth of the scope in its thread
+    unsigned int thread;        // Index of the thread
+};
+
+// ----------------------------------------------------------------------
+// Statistics of scope for the last frames (in milliseconds)
+// ----------------------------------------------------------------------
+
+struct xProfileStats
+{
+    double last;                // Time in the last frame
+    double min;                 // Min time per frame
+    double avg;                 // Average time per frame
+    double p99;                 // 99th percentile of time per frame
+    double max;                 // Max time per frame
+    unsigned long numOfFrames;  // Number of frames in statistics
+};
+
+// ----------------------------------------------------------------------
+// Ring buffer of events of one thread
+// ----------------------------------------------------------------------
+
+struct xProfileThread
+{
+    xProfileEvent events[PROFILER_RING_SIZE];   // Ring buffer of finished scopes
+    std::atomic<unsigned long> written;         // Number of written events (by owner thread)
+    std::atomic<unsigned long> read;            // Number of read events (by main thread)
+    unsigned int depth;                         // Current depth of scopes
+    unsigned int id;                            // Thread index in the trace
+    char name[STRING_SIZE];                     // Thread name in the trace
+};
+
+// ----------------------------------------------------------------------
+// Frame Profiler Class
+// ----------------------------------------------------------------------
+
+class xProfiler
+{
+public:
+
+    // ----------------------------------------------------------------------
+    // Creates profiler (enabled or not)
+    // ----------------------------------------------------------------------
+    xProfiler(bool enabled = true);
+
+    // ----------------------------------------------------------------------
+    // Deletes ring buffers of all the threads
+    // ----------------------------------------------------------------------
+    ~xProfiler();
+
+    // ----------------------------------------------------------------------
+    // Turns on (or off) recording of scopes
+    // ----------------------------------------------------------------------
+    void SetEnabled(bool enabled);
+
+    // ----------------------------------------------------------------------
+    // Returns true if scopes are recorded
+    // ----------------------------------------------------------------------
+    bool IsEnabled();
+
+    // ----------------------------------------------------------------------
+    // Begins new frame (ends previous frame, if it was not ended)
+    // ----------------------------------------------------------------------
+    void BeginFrame();
+
+    // ----------------------------------------------------------------------
+    // Ends frame: collects events of all the threads and updates
+    // statistics of scopes (only on the main thread)
+    // ----------------------------------------------------------------------
+    void EndFrame();
+
+    // ----------------------------------------------------------------------
+    // Returns statistics of scope by name (or of the whole frame for
+    // "Frame" name). Returns false, if scope was not measured
+    // ----------------------------------------------------------------------
+    bool GetStats(const char * name, xProfileStats * stats);
+
+    // ----------------------------------------------------------------------
+    // Starts saving of events for trace
+    // ----------------------------------------------------------------------
+    void StartCapture();
+
+    // ----------------------------------------------------------------------
+    // Stops capture and writes saved events in file in Chrome trace
+    // event format. Returns false, if file cannot be written
+    // ----------------------------------------------------------------------
+    bool StopCapture(const char * filename);
+
+    // ----------------------------------------------------------------------
+    // Sets name of the current thread for the trace
+    // ----------------------------------------------------------------------
+    void SetThreadName(const char * name);
+
+    // ----------------------------------------------------------------------
+    // Returns current time (in microseconds from profiler creation)
+    // ----------------------------------------------------------------------
+    double GetTime();
+
+    // ----------------------------------------------------------------------
+    // Returns ring buffer of the current thread (creates it first time)
+    // ----------------------------------------------------------------------
+    xProfileThread * GetThread();
+
+private:
+
+    // ----------------------------------------------------------------------
+    // Sum of scope time in frames (for statistics)
+    // ----------------------------------------------------------------------
+    struct Counter
+    {
+        const char * name;                          // Name of the scope
+        double frame;                               // Time in the current frame
+        double history[PROFILER_HISTORY_SIZE];      // Time in the last frames
+        unsigned long numOfFrames;                  // Number of frames in history
+    };
+
+    // ----------------------------------------------------------------------
+    // Returns counter of the scope (creates it first time)
+    // ----------------------------------------------------------------------
+    Counter * GetCounter(const char * name);
+
+    // ----------------------------------------------------------------------
+    // Collects new events of the thread
+    // ----------------------------------------------------------------------
+    void Collect(xProfileThread * thread);
+
+    std::atomic<bool> m_enabled;                // Scopes are recorded
+    bool m_inFrame;                             // Frame is begun and not ended
+    double m_frameStart;                        // Start time of the current frame
+    std::chrono::steady_clock::time_point m_start;  // Time of profiler creation
+    unsigned long m_generation;                 // Unique number of this profiler
+
+    std::mutex m_threadsMutex;                  // Guards array of threads
+    xProfileThread * m_threads[PROFILER_MAX_THREADS];   // Ring buffers of threads
+    unsigned int m_numOfThreads;                // Number of threads
+
+    xValueArray<Counter> m_counters;            // Counters of scopes (and of the frame)
+    bool m_isCapturing;                         // Events are saved for trace
+    xValueArray<xProfileEvent> m_trace;         // Captured events
+};
+
+// ----------------------------------------------------------------------
+// Measures time of the scope (created by X_PROFILE_SCOPE)
+// ----------------------------------------------------------------------
+
+class xProfileScope
+{
+public:
+
+    // ----------------------------------------------------------------------
+    // Starts measuring (if global profiler exists and is enabled)
+    // ----------------------------------------------------------------------
+    xProfileScope(const char * name);
+
+    // ----------------------------------------------------------------------
+    // Writes the event in the ring buffer of current thread
+    // ----------------------------------------------------------------------
+    ~xProfileScope();
+
+private:
+
+    const char * m_name;            // Name of the scope
+    double m_start;                 // Start time
+    xProfileThread * m_thread;      // Ring buffer of current thread (NULL - not measured)
+};
+
+// ----------------------------------------------------------------------
+// External variables and pointers
+// ----------------------------------------------------------------------
+
+extern xProfiler * g_profiler;          // Global Profiler pointer
+
+
+#endif //OXYGEN_XPROFILER_H
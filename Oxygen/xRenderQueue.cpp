@@ -0,0 +1,206 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 24.02.2018.
+ * Copyright
+ *
+ * Realisation of functions defined in the file
+ * xRenderQueue.h. Go there to find more information
+ * and interface specifications
+ */
+
+#include "xEngine.h"
+
+// ----------------------------------------------------------------------
+// Returns value clamped by max value of the field with such bits
+// ----------------------------------------------------------------------
+static inline unsigned long long ClampField(unsigned int value, int bits)
+{
+    unsigned long long max = (1ULL << bits) - 1;
+    return (value < max ? value : max);
+}
+
+xRenderQueue::xRenderQueue()
+{
+    m_isSorted = true;
+    m_stats.drawCalls = 0;
+    m_stats.stateChanges = 0;
+    m_stats.stateSaved = 0;
+}
+
+unsigned long long xRenderQueue::MakeKey(unsigned int layer, unsigned int shader, unsigned int material,
+                                         unsigned int texture, float depth)
+{
+    depth = (depth > 0.0f ? (depth < 1.0f ? depth : 1.0f) : 0.0f);
+    unsigned long long quantized = (unsigned long long)(depth * ((1 << RENDER_KEY_DEPTH_BITS) - 1) + 0.5f);
+
+    unsigned long long key = ClampField(layer, RENDER_KEY_LAYER_BITS);
+    key = (key << RENDER_KEY_SHADER_BITS) | ClampField(shader, RENDER_KEY_SHADER_BITS);
+    key = (key << RENDER_KEY_MATERIAL_BITS) | ClampField(material, RENDER_KEY_MATERIAL_BITS);
+    key = (key << RENDER_KEY_TEXTURE_BITS) | ClampField(texture, RENDER_KEY_TEXTURE_BITS);
+    key = (key << RENDER_KEY_DEPTH_BITS) | quantized;
+
+    return key;
+}
+
+void xRenderQueue::Clear()
+{
+    m_items.Clear();
+    m_keys.Clear();
+    m_isSorted = true;
+}
+
+void xRenderQueue::Submit(unsigned long long key, const xRenderItem & item)
+{
+    xRenderKey * sortKey = m_keys.EmplaceBack();
+    sortKey->key = key;
+    sortKey->item = (unsigned int)m_items.GetNumOfElements();
+
+    m_items.Add(item);
+    m_isSorted = false;
+}
+
+void xRenderQueue::Sort()
+{
+    X_PROFILE_SCOPE("Sort Queue");
+
+    if (m_isSorted) {
+        return;
+    }
+
+    const int numOfPasses = 64 / RENDER_RADIX_BITS;
+    const int numOfBuckets = 1 << RENDER_RADIX_BITS;
+    const unsigned long long mask = numOfBuckets - 1;
+
+    long numOfKeys = m_keys.GetNumOfElements();
+    m_buffer.Resize(numOfKeys);
+
+    // Histograms of all the passes are counted by one walk
+    unsigned long counts[numOfPasses][numOfBuckets];
+    memset(counts, 0, sizeof(counts));
+
+    xRenderKey * keys = m_keys.Data();
+    for(long i = 0; i < numOfKeys; i++) {
+        unsigned long long key = keys[i].key;
+        for(int pass = 0; pass < numOfPasses; pass++) {
+            counts[pass][(key >> (pass * RENDER_RADIX_BITS)) & mask] += 1;
+        }
+    }
+
+    for(int pass = 0; pass < numOfPasses; pass++)
+    {
+        unsigned long * count = counts[pass];
+        unsigned long long shift = pass * RENDER_RADIX_BITS;
+
+        // Pass is skipped, if all the keys have the same digit
+        if (count[(keys[0].key >> shift) & mask] == (unsigned long)numOfKeys) {
+            continue;
+        }
+
+        unsigned long offset = 0;
+        for(int b = 0; b < numOfBuckets; b++) {
+            unsigned long size = count[b];
+            count[b] = offset;
+            offset += size;
+        }
+
+        xRenderKey * sorted = m_buffer.Data();
+        for(long i = 0; i < numOfKeys; i++) {
+            sorted[count[(keys[i].key >> shift) & mask]++] = keys[i];
+        }
+
+        m_keys.Swap(m_buffer);
+        keys = m_keys.Data();
+    }
+
+    m_isSorted = true;
+}
+
+void xRenderQueue::Execute()
+{
+    X_PROFILE_SCOPE("Execute Queue");
+
+    m_stats.drawCalls = 0;
+    m_stats.stateChanges = 0;
+    m_stats.stateSaved = 0;
+
+    if (!m_isSorted) {
+        Sort();
+    }
+
+    // State is not known before the first item
+    bool isFirst = true;
+    GLuint program = 0;
+    xMaterial * material = NULL;
+    GLuint texture = 0;
+
+    for(long i = 0; i < m_keys.GetNumOfElements(); i++)
+    {
+        xRenderItem & item = m_items[m_keys[i].item];
+        GLuint itemTexture = (item.texture != NULL ? item.texture->GetTextureID() : 0);
+
+        if (isFirst || item.program != program) {
+            if (GLEW_VERSION_2_0) {
+                glUseProgram(item.program);
+            }
+            program = item.program;
+            m_stats.stateChanges += 1;
+        } else {
+            m_stats.stateSaved += 1;
+        }
+
+        // Item without material keeps the current colors (it is neither
+        // a change nor a saved change)
+        if (item.material != NULL) {
+            if (item.material != material) {
+                item.material->ApplyColors();
+                material = item.material;
+                m_stats.stateChanges += 1;
+            } else {
+                m_stats.stateSaved += 1;
+            }
+        }
+
+        if (isFirst || itemTexture != texture) {
+            if (itemTexture != 0) {
+                glEnable(GL_TEXTURE_2D);
+                glBindTexture(GL_TEXTURE_2D, itemTexture);
+            } else {
+                glDisable(GL_TEXTURE_2D);
+            }
+            texture = itemTexture;
+            m_stats.stateChanges += 1;
+        } else {
+            m_stats.stateSaved += 1;
+        }
+
+        isFirst = false;
+
+        if (item.transform != NULL) {
+            glPushMatrix();
+            glMultMatrixf(item.transform);
+            item.object->Draw();
+            glPopMatrix();
+        } else {
+            item.object->Draw();
+        }
+
+        m_stats.drawCalls += 1;
+    }
+
+    if (texture != 0) {
+        glDisable(GL_TEXTURE_2D);
+    }
+    if (program != 0 && GLEW_VERSION_2_0) {
+        glUseProgram(0);
+    }
+}
+
+unsigned long xRenderQueue::GetNumOfItems()
+{
+    return (unsigned long)m_items.GetNumOfElements();
+}
+
+xRenderQueueStats xRenderQueue::GetStats()
+{
+    return m_stats;
+}
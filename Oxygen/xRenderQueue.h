@@ -0,0 +1,127 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 24.02.2018.
+ * Copyright
+ *
+ * xRenderQueue collects draw calls of the frame
+ * and executes them in the order of their 64 bit
+ * sort keys (layer, shader, material, texture,
+ * front to back depth). Keys are sorted by LSD
+ * radix sort, then items are drawn and state
+ * (program, material, texture) is changed only
+ * if it differs from the previous item
+ */
+
+#ifndef OXYGEN_XRENDERQUEUE_H
+#define OXYGEN_XRENDERQUEUE_H
+
+// Bits of the fields of the sort key (from the high bits to the low ones)
+#define RENDER_KEY_LAYER_BITS       4
+#define RENDER_KEY_SHADER_BITS      8
+#define RENDER_KEY_MATERIAL_BITS    16
+#define RENDER_KEY_TEXTURE_BITS     16
+#define RENDER_KEY_DEPTH_BITS       20
+
+#define RENDER_RADIX_BITS           8       // Bits of the key sorted by one pass
+
+class xObject3d;
+
+// ----------------------------------------------------------------------
+// Draw call of the frame (state, which is changed only when needed,
+// and object, which is drawn with it)
+// ----------------------------------------------------------------------
+
+struct xRenderItem
+{
+    xObject3d * object;         // Object drawn with its current level
+    xMaterial * material;       // Lighting parameters (NULL - current colors are kept, material of key is 0)
+    xTexture * texture;         // Diffuse texture (or NULL)
+    GLuint program;             // Shader program (0 - fixed pipeline)
+    const float * transform;    // Matrix multiplied with model view (or NULL)
+};
+
+// ----------------------------------------------------------------------
+// Sort key with the index of its item
+// ----------------------------------------------------------------------
+
+struct xRenderKey
+{
+    unsigned long long key;
+    unsigned int item;
+};
+
+// ----------------------------------------------------------------------
+// Counters of the last executed frame
+// ----------------------------------------------------------------------
+
+struct xRenderQueueStats
+{
+    unsigned long drawCalls;        // Executed items
+    unsigned long stateChanges;     // Changes of program, material and texture
+    unsigned long stateSaved;       // Changes, which were skipped as redundant
+};
+
+// ----------------------------------------------------------------------
+// Render Queue Class
+// ----------------------------------------------------------------------
+
+class xRenderQueue
+{
+public:
+
+    // ----------------------------------------------------------------------
+    // Creates empty queue
+    // ----------------------------------------------------------------------
+    xRenderQueue();
+
+    // ----------------------------------------------------------------------
+    // Builds sort key (fields are clamped by their bits, depth in [0, 1] is
+    // drawn from the front to the back; use 1 - depth for back to front).
+    // Material 0 is for items without material (sort ids start from 1)
+    // ----------------------------------------------------------------------
+    static unsigned long long MakeKey(unsigned int layer, unsigned int shader, unsigned int material,
+                                      unsigned int texture, float depth);
+
+    // ----------------------------------------------------------------------
+    // Removes items of the previous frame
+    // ----------------------------------------------------------------------
+    void Clear();
+
+    // ----------------------------------------------------------------------
+    // Adds draw call with the key (item is copied)
+    // ----------------------------------------------------------------------
+    void Submit(unsigned long long key, const xRenderItem & item);
+
+    // ----------------------------------------------------------------------
+    // Sorts items by keys (stable, items with equal keys keep the order)
+    // ----------------------------------------------------------------------
+    void Sort();
+
+    // ----------------------------------------------------------------------
+    // Draws items in sorted order without redundant state changes and
+    // counts statistics. State is reset after the last item
+    // ----------------------------------------------------------------------
+    void Execute();
+
+    // ----------------------------------------------------------------------
+    // Returns number of submitted items
+    // ----------------------------------------------------------------------
+    unsigned long GetNumOfItems();
+
+    // ----------------------------------------------------------------------
+    // Returns counters of the last Execute
+    // ----------------------------------------------------------------------
+    xRenderQueueStats GetStats();
+
+private:
+
+    xValueArray<xRenderItem> m_items;       // Items in the order of submitting
+    xValueArray<xRenderKey> m_keys;         // Keys of items (sorted by Sort)
+    xValueArray<xRenderKey> m_buffer;       // Temporary keys of radix sort passes
+    bool m_isSorted;                        // Keys are sorted after the last Submit
+    xRenderQueueStats m_stats;              // Counters of the last Execute
+
+};
+
+
+#endif //OXYGEN_XRENDERQUEUE_H
@@ -12,13 +12,47 @@
 
 #define MAX_LIGHT_COUNT 32
 
+// ----------------------------------------------------------------------
+// Builds column-major matrix of rotation by angle (in degrees) around
+// axis x y z (as glRotatef)
+// ----------------------------------------------------------------------
+static void RotationMatrix(float angle, float x, float y, float z, float * matrix)
+{
+    float length = sqrtf(x * x + y * y + z * z);
+    x /= length;
+    y /= length;
+    z /= length;
+
+    float radians = angle * 3.14159265358979f / 180.0f;
+    float c = cosf(radians);
+    float s = sinf(radians);
+    float t = 1.0f - c;
+
+    matrix[0] = x * x * t + c;      matrix[4] = x * y * t - z * s;  matrix[8] = x * z * t + y * s;   matrix[12] = 0.0f;
+    matrix[1] = y * x * t + z * s;  matrix[5] = y * y * t + c;      matrix[9] = y * z * t - x * s;   matrix[13] = 0.0f;
+    matrix[2] = x * z * t - y * s;  matrix[6] = y * z * t + x * s;  matrix[10] = z * z * t + c;      matrix[14] = 0.0f;
+    matrix[3] = 0.0f;               matrix[7] = 0.0f;               matrix[11] = 0.0f;               matrix[15] = 1.0f;
+}
+
 xRenderSystem::xRenderSystem(GLFWwindow * window, xVirtualCamera * camera)
 {
     m_window = window;
     m_lights = new xLinkedList<xLight>;
+    m_staticGeometry = new xLinkedList<xStaticGeometry>;
 
     UpdateSettings(camera);
 
+    // Import does not need context (headless run loads models and
+    // textures too, GL objects are not created)
+    xTexture::SetHeadless(m_window == NULL);
+    char path2[] = "Models/cube.obj";
+    modelLoader.SetTextureManager(&m_textureManager);
+    modelLoader.ImportObj(&model3d, path2);
+
+    if (m_window == NULL) {
+        return;
+    }
+
     glHint(GL_FOG_HINT, GL_NICEST);
     glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
     glHint(GL_POINT_SMOOTH_HINT, GL_NICEST);
@@ -35,17 +69,44 @@ xRenderSystem::xRenderSystem(GLFWwindow * window, xVirtualCamera * camera)
     char path[] = "Models/foot.obj";
     g_LoadObj.ImportObj(&g_3DModel, path);         // Load our .Obj file into our model structure
 
-    char path2[] = "Models/cube.obj";
-    modelLoader.ImportObj(&model3d, path2);
+    model3d.Upload();
+
+    // Grid is built once and drawn by one call each frame
+    xStaticGeometry * grid = new xStaticGeometry();
+    grid->SetColor(0.1f, 0.1f, 0.1f);
+    grid->Begin(GL_QUADS);
+    for(int i = -100; i < 100; i++) {
+        for(int j = -100; j < 100; j++) {
+            grid->Vertex(i, -4.0f, j);
+            grid->Vertex(i, -4.0f, j + 1);
+            grid->Vertex(i + 1, -4.0f, j + 1);
+            grid->Vertex(i + 1, -4.0f, j);
+        }
+    }
+    grid->End();
+    AddStaticGeometry(grid);
 }
 
 xRenderSystem::~xRenderSystem()
 {
+    SAFE_DELETE(m_staticGeometry);
+}
+
+bool xRenderSystem::IsNull()
+{
+    return m_window == NULL;
 }
 
 void xRenderSystem::UpdateSettings(xVirtualCamera * camera)
 {
     m_camera = camera;
+
+    if (m_window == NULL) {
+        m_width = DEFAULT_X_SIZE;
+        m_height = DEFAULT_Y_SIZE;
+        return;
+    }
+
     glfwGetFramebufferSize(m_window, &m_width, &m_height);
     if (m_height <= 0) {
         m_height = 1;
@@ -60,6 +121,7 @@ void xRenderSystem::ApplySettings()
 
 void xRenderSystem::PrepareRendering3D()
 {
+    // Frustum of the camera is updated with its matrices
     m_camera->SetPerspective(&m_width, &m_height);
 }
 
@@ -78,22 +140,14 @@ void xRenderSystem::Rendering3D()
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
 
-    glColor3f(0.1,0.1,0.1);
     glEnable(GL_DEPTH_TEST);
-    glTranslatef(0.0, -4.0, 0.0);
-    glBegin(GL_QUADS);
-    for(int i = -100; i < 100; i++) {
-        for(int j = -100; j < 100; j++) {
-            glVertex3i(i, 0.0, j);
-            glVertex3i(i, 0.0, j+1);
-            glVertex3i(i+1, 0.0, j+1);
-            glVertex3i(i+1, 0.0, j);
+
+    {
+        X_PROFILE_SCOPE("Static Geometry");
+        for(xStaticGeometry * geometry : *m_staticGeometry) {
+            geometry->Draw();
         }
     }
-    glEnd();
-    glTranslatef(0.0, 4.0, 0.0);
-
-    m_camera->UpdateFrustumPyramid();
 
     glEnable(GL_LIGHTING);                              // Turn on lighting
     glEnable(GL_LIGHT0);                                // Turn on a light with defaults set
@@ -109,8 +163,11 @@ void xRenderSystem::Rendering3D()
     glLightModelf(GL_LIGHT_MODEL_TWO_SIDE, GL_FALSE);
     glLightModelf(GL_LIGHT_MODEL_LOCAL_VIEWER, GL_TRUE);
 
+    // Model matrix is used by culling, LOD selection and drawing of
+    // the model (it is not multiplied with model view of GL)
     static float rotation = 0;
-    glRotatef(rotation, 1,1,1);
+    float transform[16];
+    RotationMatrix(rotation, 1,1,1, transform);
     rotation+= 1;
 
     float diff[] = {1,1,1,1};
@@ -120,16 +177,31 @@ void xRenderSystem::Rendering3D()
     char path[] = "Models/";
 
     glColor3f(1.,1.,1.);
-    model3d.Render();
+    {
+        X_PROFILE_SCOPE("Models");
+        m_renderQueue.Clear();
+        m_frustumCuller.Clear();
+        model3d.AddBounds(&m_frustumCuller, transform);
+        m_frustumCuller.Cull(m_camera);
+        model3d.SelectLod(m_camera, transform);
+        model3d.Submit(&m_renderQueue, m_camera, 0, &m_frustumCuller, transform);
+        m_renderQueue.Sort();
+        m_renderQueue.Execute();
+    }
+
+    // Copies submitted by the state in this frame (transforms of copies
+    // are in world space)
+    float view[16];
+    m_camera->GetViewMatrix(view);
+    m_instanceBatch.Execute(view);
+    m_instanceBatch.Clear();
 
     glDisable(GL_CULL_FACE);
     glDisable(GL_LIGHT0);                                // Turn on a light with defaults set
     glDisable(GL_LIGHTING);                              // Turn on lighting
     glDisable(GL_DEPTH_TEST);
 
-    m_lights->Iterate(true);
-    while (m_lights->Iterate()) {
-        xLight * light = m_lights->GetCurrent();
+    for(xLight * light : *m_lights) {
         if (light->IsActive() && light->IsGlareEffected()) {
             m_camera->RenderGlareEffect(light);
         }
@@ -144,4 +216,29 @@ void xRenderSystem::Rendering2D()
 void xRenderSystem::AddLightSource(xLight * light)
 {
     m_lights->Add(light);
+}
+
+void xRenderSystem::AddStaticGeometry(xStaticGeometry * geometry)
+{
+    m_staticGeometry->Add(geometry);
+}
+
+xResourceManager<xTexture> * xRenderSystem::GetTextureManager()
+{
+    return &m_textureManager;
+}
+
+xRenderQueue * xRenderSystem::GetRenderQueue()
+{
+    return &m_renderQueue;
+}
+
+xInstanceBatch * xRenderSystem::GetInstanceBatch()
+{
+    return &m_instanceBatch;
+}
+
+xFrustumCuller * xRenderSystem::GetFrustumCuller()
+{
+    return &m_frustumCuller;
 }
\ No newline at end of file
@@ -7,7 +7,8 @@
  *  for rendering 3d objects by using OpenGL
  *  in the co-operation with GLEW and GLFW for
  *  creations and working with windows and
- *  contexts
+ *  contexts. Without window (headless mode)
+ *  it works as null backend: nothing is drawn
  */
 
 #ifndef OXYGEN_XRENDERCORE_H
@@ -28,6 +29,11 @@ public:
     // ----------------------------------------------------------------------
     xRenderSystem(GLFWwindow * window, xVirtualCamera * camera);
 
+    // ----------------------------------------------------------------------
+    // Returns true if render system works without window (headless mode)
+    // ----------------------------------------------------------------------
+    bool IsNull();
+
     // ----------------------------------------------------------------------
     //
     // ----------------------------------------------------------------------
@@ -68,6 +74,35 @@ public:
     // ----------------------------------------------------------------------
     void AddLightSource(xLight * light);
 
+    // ----------------------------------------------------------------------
+    // Adds built geometry, which is drawn before models each frame
+    // (render system deletes it)
+    // ----------------------------------------------------------------------
+    void AddStaticGeometry(xStaticGeometry * geometry);
+
+    // ----------------------------------------------------------------------
+    // Returns manager of textures shared by materials of all the models
+    // ----------------------------------------------------------------------
+    xResourceManager<xTexture> * GetTextureManager();
+
+    // ----------------------------------------------------------------------
+    // Returns queue of draw calls of 3D objects (its counters are
+    // updated by each Rendering3D)
+    // ----------------------------------------------------------------------
+    xRenderQueue * GetRenderQueue();
+
+    // ----------------------------------------------------------------------
+    // Returns batch of copies of models, which are submitted during the
+    // frame (for example, in xState::Update) and drawn by Rendering3D
+    // ----------------------------------------------------------------------
+    xInstanceBatch * GetInstanceBatch();
+
+    // ----------------------------------------------------------------------
+    // Returns culler of objects of models (its counters are updated by
+    // each Rendering3D)
+    // ----------------------------------------------------------------------
+    xFrustumCuller * GetFrustumCuller();
+
 private:
 
     int m_width;                    //
@@ -76,12 +111,20 @@ private:
 
     xVirtualCamera * m_camera;      //
     xLinkedList<xLight> * m_lights; //
+    xLinkedList<xStaticGeometry> * m_staticGeometry; // Background geometry (grid, terrain)
 
     CLoadObj g_LoadObj;
     t3DModel g_3DModel;
 
+    // Manager is destroyed after models, which use its textures
+    xResourceManager<xTexture> m_textureManager;
+
     xModel3d model3d;
     xModelLoader modelLoader;
+
+    xRenderQueue m_renderQueue;     // Sorted draw calls of the frame
+    xInstanceBatch m_instanceBatch; // Copies of models of the frame
+    xFrustumCuller m_frustumCuller; // Visibility of objects of models in the frame
 };
 
 
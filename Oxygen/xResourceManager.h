@@ -9,7 +9,21 @@
  * One resource will be loaded only one time if
  * you tries to do it many times. Moreover, it has
  * pointer counter for each resource, therefore you
- * cannot delete it by a mistake
+ * cannot delete it by a mistake. Resources are found
+ * by (name, path) pair through hash index, which is
+ * kept in sync with the list of resources.
+ *
+ * Resources can be referenced by handles (slot index
+ * and generation in the table of manager). Stale
+ * handle of deleted resource is resolved to NULL,
+ * and references counters are atomic, therefore
+ * handles can be acquired and released from the
+ * other threads (loading, audio).
+ *
+ * With memory budget not used resources are not
+ * deleted at once: they are kept in the LRU cache
+ * and evicted (least recently used first) only
+ * when resident size of resources exceeds budget
  */
 
 #ifndef OXYGEN_XRESOURCEMANAGER_H
@@ -17,6 +31,34 @@
 
 #include "xEngine.h"
 
+#define RESOURCE_STATE_READY    0
+#define RESOURCE_STATE_PENDING  1
+#define RESOURCE_STATE_FAILED   2
+
+// ----------------------------------------------------------------------
+// Resource Handle structure
+// ----------------------------------------------------------------------
+
+struct xResourceHandle
+{
+    unsigned int index;         // Index of the slot in the table of manager
+    unsigned int generation;    // Generation of the slot (0 for null handle)
+
+    xResourceHandle(unsigned int index = 0, unsigned int generation = 0)
+    {
+        this->index = index;
+        this->generation = generation;
+    }
+
+    // ----------------------------------------------------------------------
+    // Returns true if handle does not reference any resource
+    // ----------------------------------------------------------------------
+    bool IsNull()
+    {
+        return generation == 0;
+    }
+};
+
 // ----------------------------------------------------------------------
 // Resource Class
 // ----------------------------------------------------------------------
@@ -57,6 +99,18 @@ public:
 
         // Starts the references counter
         m_refCount = 1;
+        m_state = RESOURCE_STATE_READY;
+        m_slot = 0;
+
+        // Resource is not counted and cached by manager yet
+        m_byteSize = 0;
+        m_isCached = false;
+        m_lruPrev = NULL;
+        m_lruNext = NULL;
+
+        // Key of the resource in the hash index of manager
+        m_hash = HashNamePath(name, path);
+        m_hashNext = NULL;
     }
 
     // ----------------------------------------------------------------------
@@ -94,7 +148,7 @@ public:
     }
 
     // ----------------------------------------------------------------------
-    // Increments the references counter to 1
+    // Increments the references counter to 1 (atomic)
     // ----------------------------------------------------------------------
     void IncRef()
     {
@@ -102,11 +156,12 @@ public:
     }
 
     // ----------------------------------------------------------------------
-    // Decrements the references counter to 1
+    // Decrements the references counter to 1 (atomic) and returns
+    // new value of the counter
     // ----------------------------------------------------------------------
-    void DecRef()
+    unsigned long DecRef()
     {
-        m_refCount -= 1;
+        return --m_refCount;
     }
 
     // ----------------------------------------------------------------------
@@ -117,11 +172,116 @@ public:
         return m_refCount;
     }
 
+    // ----------------------------------------------------------------------
+    // Reads and decodes the file of resource in the RAM (can be called
+    // from the worker thread, therefore it must not use OpenGL/OpenAL)
+    // ----------------------------------------------------------------------
+    virtual bool Decode()
+    {
+        return true;
+    }
+
+    // ----------------------------------------------------------------------
+    // Uploads decoded data to OpenGL/OpenAL (only on the main thread)
+    // ----------------------------------------------------------------------
+    virtual bool Upload()
+    {
+        return true;
+    }
+
+    // ----------------------------------------------------------------------
+    // Returns size of loaded data of resource in RAM or video memory
+    // (in bytes). Used by manager to keep resources in memory budget
+    // ----------------------------------------------------------------------
+    virtual unsigned long GetByteSize()
+    {
+        return 0;
+    }
+
+    // ----------------------------------------------------------------------
+    // Returns loading state of resource (RESOURCE_STATE_...)
+    // ----------------------------------------------------------------------
+    int GetState()
+    {
+        return m_state;
+    }
+
+    // ----------------------------------------------------------------------
+    // Sets loading state of resource (RESOURCE_STATE_...)
+    // ----------------------------------------------------------------------
+    void SetState(int state)
+    {
+        m_state = state;
+    }
+
+    // ----------------------------------------------------------------------
+    // Returns true if resource is loaded and can be used
+    // ----------------------------------------------------------------------
+    bool IsReady()
+    {
+        return m_state == RESOURCE_STATE_READY;
+    }
+
+    // ----------------------------------------------------------------------
+    // Returns hash of the (name, path) pair of resource
+    // ----------------------------------------------------------------------
+    unsigned long GetHash()
+    {
+        return m_hash;
+    }
+
+    // ----------------------------------------------------------------------
+    // Counts hash (FNV-1a) of the (name, path) pair
+    // ----------------------------------------------------------------------
+    static unsigned long HashNamePath(const char * name, const char * path)
+    {
+        unsigned long long hash = 14695981039346656037ULL;
+
+        for(const char * c = path; c != NULL && *c != '\0'; c++) {
+            hash = (hash ^ (unsigned char)(*c)) * 1099511628211ULL;
+        }
+
+        // Separator between path and name
+        hash = (hash ^ 0xff) * 1099511628211ULL;
+
+        for(const char * c = name; c != NULL && *c != '\0'; c++) {
+            hash = (hash ^ (unsigned char)(*c)) * 1099511628211ULL;
+        }
+
+        return (unsigned long)hash;
+    }
+
 private:
+
+    template <class Type> friend class xResourceManager;
+
     char * m_name;                  // Name of the resource.
     char * m_path;                  // Path to the resource.
     char * m_filename;              // Filename (name + path) of the resource.
-    unsigned long m_refCount;       // Reference count.
+    std::atomic<unsigned long> m_refCount;  // Reference count.
+    std::atomic<int> m_state;       // Loading state (changed by async loader)
+    unsigned int m_slot;            // Index of the slot in the table of manager
+    unsigned long m_hash;           // Hash of name and path (key in the manager's index)
+    xResource * m_hashNext;         // Next resource in the bucket of manager's index
+    unsigned long m_byteSize;       // Size of resource counted by manager
+    bool m_isCached;                // Resource is not used and kept in LRU cache of manager
+    xResource * m_lruPrev;          // More recently released resource in the cache
+    xResource * m_lruNext;          // Less recently released resource in the cache
+};
+
+// ----------------------------------------------------------------------
+// Resource Manager statistics
+// ----------------------------------------------------------------------
+
+struct xResourceStats
+{
+    unsigned long hits;             // Requests of resources, which were in manager
+    unsigned long misses;           // Requests, for which resource was created
+    unsigned long evictions;        // Not used resources deleted to keep budget
+    unsigned long residentBytes;    // Size of all the resources of manager
+    unsigned long numOfResident;    // Number of all the resources of manager
+    unsigned long cachedBytes;      // Size of not used resources in the cache
+    unsigned long numOfCached;      // Number of not used resources in the cache
 };
 
 // ----------------------------------------------------------------------
@@ -137,7 +297,19 @@ public:
     xResourceManager(void (* CreateResourceFunction)(Type * resource, char * name, char * path) = NULL)
     {
         m_list = new xLinkedList<Type>;
+        m_loader = NULL;
         CreateResource = CreateResourceFunction;
+
+        m_numOfBuckets = 0;
+        m_buckets = NULL;
+        RebuildIndex(64);
+
+        m_freeSlot = NO_FREE_SLOT;
+
+        m_budget = 0;
+        m_lruHead = NULL;
+        m_lruTail = NULL;
+        memset(&m_stats, 0, sizeof(xResourceStats));
     }
 
     // ----------------------------------------------------------------------
@@ -145,11 +317,16 @@ public:
     // ----------------------------------------------------------------------
     ~xResourceManager()
     {
+        if (m_loader != NULL)
+            m_loader->Cancel(this);
+
         SAFE_DELETE(m_list);
+        free(m_buckets);
     }
 
     // ----------------------------------------------------------------------
-    // Adds a new resource in the manager
+    // Adds a new resource in the manager (if the resource was requested
+    // by AddAsync before, it can be still pending)
     // ----------------------------------------------------------------------
     Type * Add(char * name, char * path = NULL)
     {
@@ -162,14 +339,20 @@ public:
         if (m_list == NULL || name == NULL || path == NULL)
             return NULL;
 
+        CollectReleased();
+
         // If element exists it wil be returned
         Type * element = GetElement(name, path);
         if (element != NULL)
         {
+            m_stats.hits += 1;
             element->IncRef();
+            CacheRemove(element);
             return element;
         }
 
+        m_stats.misses += 1;
+
         // Creates the resource (better, if by useng of special construct
         // function or by using standard method)
         Type * resource = NULL;
@@ -178,8 +361,54 @@ public:
         else
             resource = new Type(name, path);
 
+        if (resource == NULL)
+            return NULL;
+
         // Adds new resource in manager and returns the pointer to that
-        return m_list->Add(resource);
+        Register(resource);
+        return resource;
+    }
+
+    // ----------------------------------------------------------------------
+    // Adds a new resource in the manager, which will be loaded by
+    // async loader. Returns pending resource at once (check IsReady()
+    // before usage). Type should have constructor (name, path, deferred)
+    // ----------------------------------------------------------------------
+    Type * AddAsync(xAsyncLoader * loader, char * name, char * path = NULL)
+    {
+        if (path == NULL) {
+            char standard_way[] = "./";
+            path = standard_way;
+        }
+
+        // Check the settings and params
+        if (m_list == NULL || loader == NULL || name == NULL || path == NULL)
+            return NULL;
+
+        CollectReleased();
+
+        // If element exists (loaded or pending) it wil be returned
+        Type * element = GetElement(name, path);
+        if (element != NULL)
+        {
+            m_stats.hits += 1;
+            element->IncRef();
+            CacheRemove(element);
+            return element;
+        }
+
+        m_stats.misses += 1;
+
+        // Creates resource without loading of data
+        Type * resource = new Type(name, path, true);
+        resource->SetState(RESOURCE_STATE_PENDING);
+
+        Register(resource);
+
+        m_loader = loader;
+        m_loader->Submit(resource, this, OnLoaded);
+
+        return resource;
     }
 
     // ----------------------------------------------------------------------
@@ -191,13 +420,114 @@ public:
         if (resource == NULL || m_list == NULL)
             return;
 
-        // Decrements the references counter
-        resource->DecRef();
+        // Decrements the references counter. If references counter is
+        // equal to the 0 (it means that resource do not used any more) it
+        // will delete that resource. Pending resource will be deleted by
+        // async loader after loading
+        if (resource->DecRef() == 0 && resource->GetState() != RESOURCE_STATE_PENDING)
+            Retire(resource);
+    }
+
+    // ----------------------------------------------------------------------
+    // Sets memory budget (in bytes) for resources of manager. Not used
+    // resources are kept in the cache, while resident size of all the
+    // resources fits budget (0 - not used resources are deleted at once)
+    // ----------------------------------------------------------------------
+    void SetMemoryBudget(unsigned long bytes)
+    {
+        m_budget = bytes;
+        Evict();
+    }
+
+    // ----------------------------------------------------------------------
+    // Returns memory budget of manager (in bytes)
+    // ----------------------------------------------------------------------
+    unsigned long GetMemoryBudget()
+    {
+        return m_budget;
+    }
+
+    // ----------------------------------------------------------------------
+    // Returns statistics of manager (hits, misses, evictions, sizes)
+    // ----------------------------------------------------------------------
+    xResourceStats GetStats()
+    {
+        return m_stats;
+    }
+
+    // ----------------------------------------------------------------------
+    // Returns handle of the resource of this manager
+    // ----------------------------------------------------------------------
+    xResourceHandle GetHandle(Type * resource)
+    {
+        if (resource == NULL)
+            return xResourceHandle();
+
+        std::unique_lock<std::mutex> lock(m_tableMutex);
+        return xResourceHandle(resource->m_slot, m_slots[resource->m_slot].generation);
+    }
+
+    // ----------------------------------------------------------------------
+    // Returns resource by handle or NULL if the resource has been deleted
+    // (does not change references counter)
+    // ----------------------------------------------------------------------
+    Type * Resolve(xResourceHandle handle)
+    {
+        std::unique_lock<std::mutex> lock(m_tableMutex);
+        return ResolveSlot(handle);
+    }
+
+    // ----------------------------------------------------------------------
+    // Increments references counter of resource by handle and returns
+    // it (or NULL if the resource has been deleted). Can be called
+    // from any thread
+    // ----------------------------------------------------------------------
+    Type * Acquire(xResourceHandle handle)
+    {
+        std::unique_lock<std::mutex> lock(m_tableMutex);
+
+        Type * resource = ResolveSlot(handle);
+        if (resource != NULL)
+            resource->IncRef();
+
+        return resource;
+    }
+
+    // ----------------------------------------------------------------------
+    // Decrements references counter of resource by handle. Can be called
+    // from any thread: not used resource is deleted later on the main
+    // thread by CollectReleased
+    // ----------------------------------------------------------------------
+    void Release(xResourceHandle handle)
+    {
+        std::unique_lock<std::mutex> lock(m_tableMutex);
+
+        Type * resource = ResolveSlot(handle);
+        if (resource != NULL && resource->DecRef() == 0)
+            m_released.Add(handle);
+    }
+
+    // ----------------------------------------------------------------------
+    // Deletes resources released by handles, which are not used any more
+    // (should be called on the main thread, also it is called by Add)
+    // ----------------------------------------------------------------------
+    void CollectReleased()
+    {
+        xValueArray<xResourceHandle> released;
+
+        {
+            std::unique_lock<std::mutex> lock(m_tableMutex);
+            released.Swap(m_released);
+        }
+
+        for(long i = 0; i < released.GetNumOfElements(); i++)
+        {
+            Type * resource = Resolve(released[i]);
 
-        // If references counter is equal to the 1 (it means that resource
-        // do not used any more) it will delete that resource
-        if ((resource)->GetRefCount() == 0)
-            m_list->Remove(resource);
+            if (resource != NULL && resource->GetRefCount() == 0 &&
+                resource->GetState() != RESOURCE_STATE_PENDING)
+                Retire(resource);
+        }
     }
 
     // ----------------------------------------------------------------------
@@ -205,8 +535,33 @@ public:
     // ----------------------------------------------------------------------
     void EmptyList()
     {
+        if (m_loader != NULL)
+            m_loader->Cancel(this);
+
+        // All handles of resources become stale
+        {
+            std::unique_lock<std::mutex> lock(m_tableMutex);
+
+            for(long i = 0; i < m_slots.GetNumOfElements(); i++) {
+                if (m_slots[i].resource != NULL)
+                    FreeSlot((unsigned int)i);
+            }
+
+            m_released.Clear();
+        }
+
         if (m_list != NULL)
             m_list->Empty();
+
+        memset(m_buckets, 0, sizeof(xResource *) * m_numOfBuckets);
+        m_numOfIndexed = 0;
+
+        m_lruHead = NULL;
+        m_lruTail = NULL;
+        m_stats.residentBytes = 0;
+        m_stats.numOfResident = 0;
+        m_stats.cachedBytes = 0;
+        m_stats.numOfCached = 0;
     }
 
     // ----------------------------------------------------------------------
@@ -230,18 +585,20 @@ public:
         // Check the settings and params
         if (name == NULL || path == NULL || m_list == NULL)
             return NULL;
-        if (m_list->GetFirst() == NULL)
-            return NULL;
 
-        // Iterates whole the list to fin the pointer to the resource
-        m_list->Iterate(true);
-        while(m_list->Iterate())
+        // Looks for the resource only in its bucket of the hash index
+        unsigned long hash = xResource::HashNamePath(name, path);
+        xResource * resource = m_buckets[hash & (m_numOfBuckets - 1)];
+
+        while (resource != NULL)
         {
-            if (strcmp(m_list->GetCurrent()->GetName(), name) == 0) {
-                if (strcmp(m_list->GetCurrent()->GetPath(), path) == 0) {
-                    return m_list->GetCurrent();
-                }
+            if (resource->m_hash == hash &&
+                strcmp(resource->GetName(), name) == 0 &&
+                strcmp(resource->GetPath(), path) == 0) {
+                return (Type *)resource;
             }
+
+            resource = resource->m_hashNext;
         }
 
         // Returns NULL if resource is not found
@@ -249,8 +606,280 @@ public:
     }
 
 private:
+
+    static const unsigned int NO_FREE_SLOT = 0xffffffff;    // End of the list of free slots
+
+    // ----------------------------------------------------------------------
+    // Slot of the table of handles
+    // ----------------------------------------------------------------------
+    struct Slot
+    {
+        Type * resource;            // Resource in the slot (or NULL)
+        unsigned int generation;    // Incremented when resource is deleted
+        unsigned int nextFree;      // Next free slot (if slot is free)
+    };
+
+    // ----------------------------------------------------------------------
+    // Called by async loader after loading of resource: counts its size
+    // and retires it, if it was removed while loading
+    // ----------------------------------------------------------------------
+    static void OnLoaded(void * owner, xResource * resource)
+    {
+        xResourceManager * manager = (xResourceManager *)owner;
+
+        manager->Account(resource);
+
+        if (resource->GetRefCount() == 0)
+            manager->Retire((Type *)resource);
+        else
+            manager->Evict();
+    }
+
+    // ----------------------------------------------------------------------
+    // Updates counted size of resource (if it is changed after loading)
+    // ----------------------------------------------------------------------
+    void Account(xResource * resource)
+    {
+        m_stats.residentBytes -= resource->m_byteSize;
+        resource->m_byteSize = resource->GetByteSize();
+        m_stats.residentBytes += resource->m_byteSize;
+    }
+
+    // ----------------------------------------------------------------------
+    // Puts not used resource in the cache or deletes it (if there is no
+    // budget or resource is failed) and evicts resources out of budget
+    // ----------------------------------------------------------------------
+    void Retire(Type * resource)
+    {
+        if (m_budget == 0 || resource->GetState() == RESOURCE_STATE_FAILED) {
+            Unregister(resource);
+            return;
+        }
+
+        // Resource becomes the most recently used
+        CacheRemove(resource);
+        CacheInsert(resource);
+
+        Evict();
+    }
+
+    // ----------------------------------------------------------------------
+    // Deletes least recently used resources from the cache, while resident
+    // size of resources exceeds budget
+    // ----------------------------------------------------------------------
+    void Evict()
+    {
+        while (m_lruTail != NULL && (m_budget == 0 || m_stats.residentBytes > m_budget))
+        {
+            Type * resource = (Type *)m_lruTail;
+            CacheRemove(resource);
+
+            // Resource could be acquired by handle from the other thread
+            if (Unregister(resource))
+                m_stats.evictions += 1;
+        }
+    }
+
+    // ----------------------------------------------------------------------
+    // Puts resource in the head of the cache (most recently used)
+    // ----------------------------------------------------------------------
+    void CacheInsert(xResource * resource)
+    {
+        resource->m_isCached = true;
+        resource->m_lruPrev = NULL;
+        resource->m_lruNext = m_lruHead;
+
+        if (m_lruHead != NULL)
+            m_lruHead->m_lruPrev = resource;
+        else
+            m_lruTail = resource;
+
+        m_lruHead = resource;
+
+        m_stats.cachedBytes += resource->m_byteSize;
+        m_stats.numOfCached += 1;
+    }
+
+    // ----------------------------------------------------------------------
+    // Removes resource from the cache (if it is there)
+    // ----------------------------------------------------------------------
+    void CacheRemove(xResource * resource)
+    {
+        if (!resource->m_isCached)
+            return;
+
+        if (resource->m_lruPrev != NULL)
+            resource->m_lruPrev->m_lruNext = resource->m_lruNext;
+        else
+            m_lruHead = resource->m_lruNext;
+
+        if (resource->m_lruNext != NULL)
+            resource->m_lruNext->m_lruPrev = resource->m_lruPrev;
+        else
+            m_lruTail = resource->m_lruPrev;
+
+        resource->m_isCached = false;
+        resource->m_lruPrev = NULL;
+        resource->m_lruNext = NULL;
+
+        m_stats.cachedBytes -= resource->m_byteSize;
+        m_stats.numOfCached -= 1;
+    }
+
+    // ----------------------------------------------------------------------
+    // Adds created resource in the list, hash index and table of handles
+    // ----------------------------------------------------------------------
+    void Register(Type * resource)
+    {
+        IndexInsert(resource);
+        m_list->Add(resource);
+
+        Account(resource);
+        m_stats.numOfResident += 1;
+
+        std::unique_lock<std::mutex> lock(m_tableMutex);
+
+        if (m_freeSlot == NO_FREE_SLOT) {
+            Slot slot;
+            slot.resource = NULL;
+            slot.generation = 1;
+            slot.nextFree = NO_FREE_SLOT;
+            m_slots.Add(slot);
+            m_freeSlot = (unsigned int)(m_slots.GetNumOfElements() - 1);
+        }
+
+        resource->m_slot = m_freeSlot;
+        m_freeSlot = m_slots[m_freeSlot].nextFree;
+        m_slots[resource->m_slot].resource = resource;
+    }
+
+    // ----------------------------------------------------------------------
+    // Deletes not used resource from the manager (if it was not acquired
+    // by handle from the other thread in this moment). Returns true if
+    // resource is deleted
+    // ----------------------------------------------------------------------
+    bool Unregister(Type * resource)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_tableMutex);
+
+            if (resource->GetRefCount() != 0)
+                return false;
+
+            FreeSlot(resource->m_slot);
+        }
+
+        CacheRemove(resource);
+        IndexRemove(resource);
+
+        m_stats.residentBytes -= resource->m_byteSize;
+        m_stats.numOfResident -= 1;
+
+        m_list->Remove(resource);
+        return true;
+    }
+
+    // ----------------------------------------------------------------------
+    // Makes the slot free and all its handles stale (table should be locked)
+    // ----------------------------------------------------------------------
+    void FreeSlot(unsigned int index)
+    {
+        Slot & slot = m_slots[index];
+
+        slot.resource = NULL;
+        slot.generation = (slot.generation == 0xffffffff ? 1 : slot.generation + 1);
+        slot.nextFree = m_freeSlot;
+        m_freeSlot = index;
+    }
+
+    // ----------------------------------------------------------------------
+    // Returns resource of the valid handle or NULL (table should be locked)
+    // ----------------------------------------------------------------------
+    Type * ResolveSlot(xResourceHandle handle)
+    {
+        if (handle.index >= (unsigned long)m_slots.GetNumOfElements())
+            return NULL;
+        if (m_slots[handle.index].generation != handle.generation)
+            return NULL;
+
+        return m_slots[handle.index].resource;
+    }
+
+    // ----------------------------------------------------------------------
+    // Adds resource in the hash index (expands index if it is needed)
+    // ----------------------------------------------------------------------
+    void IndexInsert(xResource * resource)
+    {
+        if (m_numOfIndexed + 1 > m_numOfBuckets - m_numOfBuckets / 4) {
+            RebuildIndex(m_numOfBuckets * 2);
+        }
+
+        xResource ** bucket = &m_buckets[resource->m_hash & (m_numOfBuckets - 1)];
+        resource->m_hashNext = *bucket;
+        *bucket = resource;
+
+        m_numOfIndexed += 1;
+    }
+
+    // ----------------------------------------------------------------------
+    // Removes resource from the hash index
+    // ----------------------------------------------------------------------
+    void IndexRemove(xResource * resource)
+    {
+        xResource ** link = &m_buckets[resource->m_hash & (m_numOfBuckets - 1)];
+
+        while (*link != NULL)
+        {
+            if (*link == resource) {
+                *link = resource->m_hashNext;
+                resource->m_hashNext = NULL;
+                m_numOfIndexed -= 1;
+                return;
+            }
+
+            link = &(*link)->m_hashNext;
+        }
+    }
+
+    // ----------------------------------------------------------------------
+    // Allocates index with numOfBuckets (power of 2) buckets and puts
+    // in it all the resources of the list
+    // ----------------------------------------------------------------------
+    void RebuildIndex(unsigned long numOfBuckets)
+    {
+        free(m_buckets);
+        m_buckets = (xResource **)calloc(numOfBuckets, sizeof(xResource *));
+
+        if (m_buckets == NULL) {
+            printf("ERROR: cannot allocate memory for resource index \n");
+            exit(1);
+        }
+
+        m_numOfBuckets = numOfBuckets;
+        m_numOfIndexed = 0;
+
+        for(Type * resource : *m_list) {
+            IndexInsert(resource);
+        }
+    }
+
     xLinkedList<Type> * m_list;                                             // Linked List of resources
     void (* CreateResource)(Type * resource, char * name, char * path);     // Special loading function for current resource type
+    xAsyncLoader * m_loader;                                                // Async loader, which was used by manager
+
+    std::mutex m_tableMutex;                    // Guards table of handles and released handles
+    xValueArray<Slot> m_slots;                  // Table of handles (slot for each resource)
+    unsigned int m_freeSlot;                    // First free slot in the table
+    xValueArray<xResourceHandle> m_released;    // Handles released to zero references
+
+    xResource ** m_buckets;                 // Hash index of resources (by name and path)
+    unsigned long m_numOfBuckets;           // Number of buckets in the index (power of 2)
+    unsigned long m_numOfIndexed;           // Number of resources in the index
+
+    unsigned long m_budget;                 // Memory budget (in bytes, 0 - without cache)
+    xResource * m_lruHead;                  // Most recently released resource in the cache
+    xResource * m_lruTail;                  // Least recently released resource in the cache
+    xResourceStats m_stats;                 // Statistics of manager
 };
 
 
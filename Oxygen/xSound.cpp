@@ -10,26 +10,73 @@
 
 #include "xEngine.h"
 
-xSound::xSound(char * name, char * path) : xResource(name, path)
+xSound::xSound(char * name, char * path, bool deferred) : xResource(name, path)
 {
-    ALenum      format;
-    ALsizei     size;
-    ALvoid    * data;
-    ALsizei     freq;
+    m_buffer = 0;
+    m_data = NULL;
+    m_size = 0;
+
+    if (!deferred) {
+        Decode();
+        Upload();
+    }
+}
+
+xSound::~xSound()
+{
+    if (m_data != NULL) {
+        alutUnloadWAV(m_format, m_data, m_size, m_freq);
+    }
+
+    if (m_buffer != 0) {
+        alDeleteBuffers(1, &m_buffer);
+    }
+}
+
+bool xSound::Decode()
+{
+    m_data = NULL;
+    alutLoadWAVFile(GetFilename(), &m_format, &m_data, &m_size, &m_freq);
+
+    if (m_data == NULL) {
+        printf("ERROR: Cannot read sound file %s \n", GetFilename());
+        return false;
+    }
+
+    return true;
+}
+
+bool xSound::Upload()
+{
+    // Null audio backend: data is only counted
+    if (alcGetCurrentContext() == NULL) {
+        if (m_data != NULL) {
+            alutUnloadWAV(m_format, m_data, m_size, m_freq);
+            m_data = NULL;
+            return true;
+        }
+        return false;
+    }
 
     alGenBuffers(1, &m_buffer);
     if (alGetError() != AL_NO_ERROR) {
         printf("ERROR: Cannot crate buffer for file \n");
     }
 
-    alutLoadWAVFile(GetFilename(), &format, &data, &size, &freq);
-    alBufferData(m_buffer, format, data, size, freq);
-    alutUnloadWAV(format, data, size, freq);
+    if (m_data == NULL) {
+        return false;
+    }
+
+    alBufferData(m_buffer, m_format, m_data, m_size, m_freq);
+    alutUnloadWAV(m_format, m_data, m_size, m_freq);
+    m_data = NULL;
+
+    return true;
 }
 
-xSound::~xSound()
+unsigned long xSound::GetByteSize()
 {
-    alDeleteBuffers(1, &m_buffer);
+    return (unsigned long)m_size;
 }
 
 ALuint xSound::GetSoundBuffer()
@@ -19,15 +19,31 @@ class xSound : public xResource
 public:
 
     // ----------------------------------------------------------------------
-    // Creates sound data from file name
+    // Creates sound data from file name (if deferred is true, data is
+    // loaded later by Decode and Upload of async loader)
     // ----------------------------------------------------------------------
-    xSound(char * name, char * path = NULL);
+    xSound(char * name, char * path = NULL, bool deferred = false);
 
     // ----------------------------------------------------------------------
     // Free memory for sound data
     // ----------------------------------------------------------------------
     ~xSound();
 
+    // ----------------------------------------------------------------------
+    // Reads wav file in the RAM (can be done by worker thread)
+    // ----------------------------------------------------------------------
+    bool Decode();
+
+    // ----------------------------------------------------------------------
+    // Creates OpenAL buffer from decoded data (only on main thread)
+    // ----------------------------------------------------------------------
+    bool Upload();
+
+    // ----------------------------------------------------------------------
+    // Returns size of sound data (in bytes)
+    // ----------------------------------------------------------------------
+    unsigned long GetByteSize();
+
     // ----------------------------------------------------------------------
     // Returns buffer index
     // ----------------------------------------------------------------------
@@ -37,6 +53,11 @@ private:
 
     ALuint m_buffer;                // Buffer for sound data
 
+    ALenum m_format;                // Format of decoded data
+    ALvoid * m_data;                // Decoded data (before uploading)
+    ALsizei m_size;                 // Size of decoded data
+    ALsizei m_freq;                 // Frequency of decoded data
+
 };
 
 
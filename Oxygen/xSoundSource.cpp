@@ -22,10 +22,15 @@ xSoundSource::xSoundSource(xSound * sound, xResourceManager<xSound> * manager)
         exit(1);
     }
 
-    alGenSources(1, &m_source);
-    if (alGetError() != AL_NO_ERROR) {
-        printf("ERROR: Cannot create sound source \n");
-        //exit(1);
+    // Null audio backend (there is no current context): source is not
+    // created, and all the calls for source 0 are ignored by OpenAL
+    m_source = 0;
+    if (alcGetCurrentContext() != NULL) {
+        alGenSources(1, &m_source);
+        if (alGetError() != AL_NO_ERROR) {
+            printf("ERROR: Cannot create sound source \n");
+            //exit(1);
+        }
     }
 
     m_position = new xVector3;
@@ -45,7 +50,9 @@ xSoundSource::~xSoundSource()
     SAFE_DELETE(m_direction);
 
     m_sound_manager->Remove(m_sound);
-    alDeleteSources(1, &m_source);
+    if (m_source != 0) {
+        alDeleteSources(1, &m_source);
+    }
 }
 
 void xSoundSource::SetGain(float gain)
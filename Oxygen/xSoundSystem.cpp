@@ -10,39 +10,51 @@
 
 #include "xEngine.h"
 
-xSoundSystem::xSoundSystem()
+xSoundSystem::xSoundSystem(bool null_backend)
 {
-    m_device = alcOpenDevice(NULL);
-    if (alGetError() != AL_NO_ERROR) {
-        printf("ERROR: Cannot open audio device \n");
-        exit(1);
-    }
-
-    m_context = alcCreateContext(m_device, NULL);
-    if (alGetError() != AL_NO_ERROR) {
-        printf("ERROR: Cannot create audio context \n");
-        exit(1);
-    }
+    m_device = NULL;
+    m_context = NULL;
 
     m_ContextList = new xLinkedList<ALCcontext>;
-    m_ContextList->Add(m_context);
-
     m_SoundSources = new xLinkedList<xSoundSource>;
     m_SoundManager = new xResourceManager<xSound>;
 
-    alcMakeContextCurrent(m_context);
-    alDistanceModel(AL_INVERSE_DISTANCE); // !!!
+    if (!null_backend)
+    {
+        m_device = alcOpenDevice(NULL);
+        if (m_device == NULL) {
+            printf("WARNING: Cannot open audio device (null audio backend is used) \n");
+        }
+    }
+
+    if (m_device != NULL)
+    {
+        m_context = alcCreateContext(m_device, NULL);
+        if (m_context == NULL) {
+            printf("WARNING: Cannot create audio context (null audio backend is used) \n");
+            alcCloseDevice(m_device);
+            m_device = NULL;
+        }
+    }
+
+    if (m_device != NULL)
+    {
+        m_ContextList->Add(m_context);
+
+        alcMakeContextCurrent(m_context);
+        alDistanceModel(AL_INVERSE_DISTANCE); // !!!
 
-    const ALchar * version = alGetString(AL_VERSION);
-    const ALchar * vendor = alGetString(AL_VENDOR);
-    const ALchar * renderer = alGetString(AL_RENDERER);
-    const ALchar * extensions = alGetString(AL_EXTENSIONS);
+        const ALchar * version = alGetString(AL_VERSION);
+        const ALchar * vendor = alGetString(AL_VENDOR);
+        const ALchar * renderer = alGetString(AL_RENDERER);
+        const ALchar * extensions = alGetString(AL_EXTENSIONS);
 
-    printf("AL Vendor     : %s\n", vendor);
-    printf("AL Version    : %s\n", version);
-    printf("AL Renderer   : %s\n", renderer);
-    printf("AL Extensions : %s\n", extensions);
-    printf("\n");
+        printf("AL Vendor     : %s\n", vendor);
+        printf("AL Version    : %s\n", version);
+        printf("AL Renderer   : %s\n", renderer);
+        printf("AL Extensions : %s\n", extensions);
+        printf("\n");
+    }
 
     m_position = new xVector3;
     m_velocity = new xVector3;
@@ -55,13 +67,20 @@ xSoundSystem::~xSoundSystem()
     SAFE_DELETE(m_SoundSources);
     SAFE_DELETE(m_SoundManager);
 
-    while(m_ContextList->Iterate()) {
-        alcSuspendContext(m_ContextList->GetCurrent());
-        alcDestroyContext(m_ContextList->GetCurrent());
+    for(ALCcontext * context : *m_ContextList) {
+        alcSuspendContext(context);
+        alcDestroyContext(context);
     }
 
     //SAFE_DELETE(m_ContextList);
-    alcCloseDevice(m_device);
+    if (m_device != NULL) {
+        alcCloseDevice(m_device);
+    }
+}
+
+bool xSoundSystem::IsNull()
+{
+    return m_device == NULL;
 }
 
 xSoundSource * xSoundSystem::CreateSoundSource(char * name, char * path)
@@ -79,8 +98,13 @@ void xSoundSystem::DeleteSoundSource(xSoundSource * source)
 
 ALCcontext * xSoundSystem::CreateContext()
 {
+    if (m_device == NULL) {
+        return NULL;
+    }
+
     ALCcontext * context = alcCreateContext(m_device, NULL);
     m_ContextList->Add(context);
+    return context;
 }
 
 void xSoundSystem::DeleteContext(ALCcontext * context)
@@ -96,9 +120,9 @@ void xSoundSystem::SetContextCurrent(ALCcontext *context)
 
 void xSoundSystem::DeleteAllContexts()
 {
-    while(m_ContextList->Iterate()) {
-        alcSuspendContext(m_ContextList->GetCurrent());
-        alcDestroyContext(m_ContextList->GetCurrent());
+    for(ALCcontext * context : *m_ContextList) {
+        alcSuspendContext(context);
+        alcDestroyContext(context);
     }
 }
 
@@ -154,44 +178,44 @@ void xSoundSystem::SetListenerOrientation(float at_x, float at_y, float at_z, fl
 
 void xSoundSystem::PlayAllSources()
 {
-    m_SoundSources->Iterate(true);
-    while(m_SoundSources->Iterate()) {
-        m_SoundSources->GetCurrent()->Play();
+    for(xSoundSource * source : *m_SoundSources) {
+        source->Play();
     }
 }
 
 void xSoundSystem::StopAllSources()
 {
-    m_SoundSources->Iterate(true);
-    while(m_SoundSources->Iterate()) {
-        m_SoundSources->GetCurrent()->Stop();
+    for(xSoundSource * source : *m_SoundSources) {
+        source->Stop();
     }
 }
 
 void xSoundSystem::PauseAllSources()
 {
-    m_SoundSources->Iterate(true);
-    while(m_SoundSources->Iterate()) {
-        m_SoundSources->GetCurrent()->Pause();
+    for(xSoundSource * source : *m_SoundSources) {
+        source->Pause();
     }
 }
 
 void xSoundSystem::RewindAllSources()
 {
-    m_SoundSources->Iterate(true);
-    while(m_SoundSources->Iterate()) {
-        m_SoundSources->GetCurrent()->Rewind();
+    for(xSoundSource * source : *m_SoundSources) {
+        source->Rewind();
     }
 }
 
 void xSoundSystem::SuspendContext()
 {
-    alcSuspendContext(m_context);
+    if (m_context != NULL) {
+        alcSuspendContext(m_context);
+    }
 }
 
 void xSoundSystem::ProcessContext()
 {
-    alcProcessContext(m_context);
+    if (m_context != NULL) {
+        alcProcessContext(m_context);
+    }
 }
 
 void xSoundSystem::DeleteAllSources()
@@ -8,7 +8,9 @@
  *  programmer create device, context and play
  *  different sounds in the 3d space (by simple
  *  setting up of important values: listener position,
- *  velocity, orientation and etc.)
+ *  velocity, orientation and etc.). Without audio
+ *  device it works as null backend: sounds are
+ *  loaded, but not played
  */
 
 #ifndef OXYGEN_XSOUNDSYSTEM_H
@@ -23,11 +25,17 @@ class xSoundSystem
 public:
 
     // ----------------------------------------------------------------------
-    // Class constructor and destructor
+    // Class constructor and destructor (null_backend - do not open
+    // audio device, it is also used if device cannot be opened)
     // ----------------------------------------------------------------------
-    xSoundSystem();
+    xSoundSystem(bool null_backend = false);
     ~xSoundSystem();
 
+    // ----------------------------------------------------------------------
+    // Returns true if sound system works without audio device
+    // ----------------------------------------------------------------------
+    bool IsNull();
+
     // ----------------------------------------------------------------------
     // Creates and deletes sound sources
     // ----------------------------------------------------------------------
@@ -51,14 +51,9 @@ void xStateManager::RemoveState(xState * state)
 
 void xStateManager::RemoveState(unsigned long state_id)
 {
-    xState * tmp;
-    m_states->Iterate(true);
-
     // Find the state with needed id
-    while(m_states->Iterate() != NULL)
+    for(xState * tmp : *m_states)
     {
-        tmp = m_states->GetCurrent();
-
         if (tmp->GetID() == state_id) {
             m_states->Remove(tmp);
 
@@ -70,17 +65,16 @@ void xStateManager::RemoveState(unsigned long state_id)
 void xStateManager::ChangeState(unsigned long state_id)
 {
     // Iterates throw the list to find needed state to change
-    m_states->Iterate (true);
-    while(m_states->Iterate() != NULL)
+    for(xState * state : *m_states)
     {
-        if (m_states->GetCurrent()->GetID() == state_id)
+        if (state->GetID() == state_id)
         {
             // Close previous state
             if (m_currentState != NULL)
                 m_currentState->Close();
 
             // Sets new state as currend and loads it
-            m_currentState = m_states->GetCurrent();
+            m_currentState = state;
             m_currentState->Load();
 
             // Sets the flag to indicate, tha state has been changed
@@ -0,0 +1,189 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 26.02.2018.
+ * Copyright
+ *
+ * Realisation of functions defined in the file
+ * xStaticGeometry.h. Go there to find more information
+ * and interface specifications
+ */
+
+#include "xEngine.h"
+
+xStaticGeometry::xStaticGeometry() : m_normal(0.0f, 0.0f, 1.0f), m_texcoord(0.0f, 0.0f)
+{
+    m_mode = GL_TRIANGLES;
+    m_numOfVertices = 0;
+    m_hasNormals = false;
+    m_hasTexcoords = false;
+    m_isBuilt = false;
+
+    m_color[0] = 1.0f;
+    m_color[1] = 1.0f;
+    m_color[2] = 1.0f;
+
+    m_buffer = 0;
+    m_list = 0;
+}
+
+xStaticGeometry::~xStaticGeometry()
+{
+    if (m_buffer != 0) {
+        glDeleteBuffers(1, &m_buffer);
+    }
+    if (m_list != 0) {
+        glDeleteLists(m_list, 1);
+    }
+}
+
+void xStaticGeometry::Begin(GLenum mode)
+{
+    if (m_buffer != 0) {
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+    }
+    if (m_list != 0) {
+        glDeleteLists(m_list, 1);
+        m_list = 0;
+    }
+
+    m_mode = mode;
+    m_numOfVertices = 0;
+    m_hasNormals = false;
+    m_hasTexcoords = false;
+    m_isBuilt = false;
+
+    m_positions.Clear();
+    m_normals.Clear();
+    m_texcoords.Clear();
+}
+
+void xStaticGeometry::Normal(float x, float y, float z)
+{
+    m_normal = xPoint3(x, y, z);
+    m_hasNormals = true;
+}
+
+void xStaticGeometry::TexCoord(float u, float v)
+{
+    m_texcoord = xPoint2(u, v);
+    m_hasTexcoords = true;
+}
+
+void xStaticGeometry::Vertex(float x, float y, float z)
+{
+    m_positions.EmplaceBack(x, y, z);
+    m_normals.Add(m_normal);
+    m_texcoords.Add(m_texcoord);
+    m_numOfVertices += 1;
+}
+
+void xStaticGeometry::End()
+{
+    m_isBuilt = true;
+
+    // Not used attributes are not kept
+    if (!m_hasNormals) {
+        m_normals.EmptyMass();
+    }
+    if (!m_hasTexcoords) {
+        m_texcoords.EmptyMass();
+    }
+}
+
+void xStaticGeometry::SetColor(float r, float g, float b)
+{
+    m_color[0] = r;
+    m_color[1] = g;
+    m_color[2] = b;
+}
+
+long xStaticGeometry::GetNumOfVertices()
+{
+    return m_numOfVertices;
+}
+
+void xStaticGeometry::Draw()
+{
+    if (!m_isBuilt || m_numOfVertices == 0) {
+        return;
+    }
+
+    if (m_buffer == 0 && m_list == 0) {
+        Upload();
+    }
+
+    glColor3fv(m_color);
+
+    if (m_list != 0) {
+        glCallList(m_list);
+        return;
+    }
+
+    // Attributes follow each other in the buffer
+    unsigned long normals = sizeof(xPoint3) * m_numOfVertices;
+    unsigned long texcoords = normals + (m_hasNormals ? sizeof(xPoint3) * m_numOfVertices : 0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, (const GLvoid *)0);
+
+    if (m_hasNormals) {
+        glEnableClientState(GL_NORMAL_ARRAY);
+        glNormalPointer(GL_FLOAT, 0, (const GLvoid *)normals);
+    }
+    if (m_hasTexcoords) {
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glTexCoordPointer(2, GL_FLOAT, 0, (const GLvoid *)texcoords);
+    }
+
+    glDrawArrays(m_mode, 0, (GLsizei)m_numOfVertices);
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void xStaticGeometry::Upload()
+{
+    if (GLEW_VERSION_1_5)
+    {
+        unsigned long positionsSize = sizeof(xPoint3) * m_numOfVertices;
+        unsigned long normalsSize = (m_hasNormals ? sizeof(xPoint3) * m_numOfVertices : 0);
+        unsigned long texcoordsSize = (m_hasTexcoords ? sizeof(xPoint2) * m_numOfVertices : 0);
+
+        glGenBuffers(1, &m_buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+        glBufferData(GL_ARRAY_BUFFER, positionsSize + normalsSize + texcoordsSize, NULL, GL_STATIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, positionsSize, m_positions.Data());
+        glBufferSubData(GL_ARRAY_BUFFER, positionsSize, normalsSize, m_normals.Data());
+        glBufferSubData(GL_ARRAY_BUFFER, positionsSize + normalsSize, texcoordsSize, m_texcoords.Data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    else
+    {
+        m_list = glGenLists(1);
+        glNewList(m_list, GL_COMPILE);
+        glBegin(m_mode);
+
+        for(long i = 0; i < m_numOfVertices; i++) {
+            if (m_hasTexcoords) {
+                glTexCoord2f(m_texcoords[i].x, m_texcoords[i].y);
+            }
+            if (m_hasNormals) {
+                glNormal3f(m_normals[i].x, m_normals[i].y, m_normals[i].z);
+            }
+            glVertex3f(m_positions[i].x, m_positions[i].y, m_positions[i].z);
+        }
+
+        glEnd();
+        glEndList();
+    }
+
+    // Data is kept only by GPU
+    m_positions.EmptyMass();
+    m_normals.EmptyMass();
+    m_texcoords.EmptyMass();
+}
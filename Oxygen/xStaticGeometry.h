@@ -0,0 +1,101 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 26.02.2018.
+ * Copyright
+ *
+ * xStaticGeometry keeps geometry, which is not
+ * changed after building (ground grid, terrain,
+ * background). Vertices are given one time as in
+ * immediate mode (Begin, Normal, TexCoord, Vertex,
+ * End), then they are uploaded by the first Draw
+ * in vertex buffer (or compiled in display list,
+ * if buffer objects are not supported) and each
+ * Draw is one call
+ */
+
+#ifndef OXYGEN_XSTATICGEOMETRY_H
+#define OXYGEN_XSTATICGEOMETRY_H
+
+// ----------------------------------------------------------------------
+// Static Geometry Class
+// ----------------------------------------------------------------------
+
+class xStaticGeometry
+{
+public:
+
+    // ----------------------------------------------------------------------
+    // Creates empty geometry with white color
+    // ----------------------------------------------------------------------
+    xStaticGeometry();
+
+    // ----------------------------------------------------------------------
+    // Deletes buffer (or display list) of the geometry
+    // ----------------------------------------------------------------------
+    ~xStaticGeometry();
+
+    // ----------------------------------------------------------------------
+    // Starts building of primitives of mode (GL_TRIANGLES, GL_QUADS,
+    // GL_LINES ...). Previous geometry is removed
+    // ----------------------------------------------------------------------
+    void Begin(GLenum mode);
+
+    // ----------------------------------------------------------------------
+    // Sets normal and texture coordinates of the next vertices (arrays
+    // of them are kept only if they were set)
+    // ----------------------------------------------------------------------
+    void Normal(float x, float y, float z);
+    void TexCoord(float u, float v);
+
+    // ----------------------------------------------------------------------
+    // Adds vertex with the current normal and texture coordinates
+    // ----------------------------------------------------------------------
+    void Vertex(float x, float y, float z);
+
+    // ----------------------------------------------------------------------
+    // Ends building (geometry is uploaded by the first Draw)
+    // ----------------------------------------------------------------------
+    void End();
+
+    // ----------------------------------------------------------------------
+    // Sets color, which is used for drawing
+    // ----------------------------------------------------------------------
+    void SetColor(float r, float g, float b);
+
+    // ----------------------------------------------------------------------
+    // Draws geometry by one call (needs current context)
+    // ----------------------------------------------------------------------
+    void Draw();
+
+    // ----------------------------------------------------------------------
+    // Returns number of vertices of the geometry
+    // ----------------------------------------------------------------------
+    long GetNumOfVertices();
+
+private:
+
+    // ----------------------------------------------------------------------
+    // Uploads vertices in buffer or display list and releases them
+    // ----------------------------------------------------------------------
+    void Upload();
+
+    GLenum m_mode;                          // Type of primitives
+    long m_numOfVertices;                   // Number of built vertices
+    bool m_hasNormals;                      // Normal was set for the vertices
+    bool m_hasTexcoords;                    // Texture coordinates were set for the vertices
+    bool m_isBuilt;                         // End was called (geometry can be uploaded)
+    float m_color[3];                       // Color of drawing
+    xPoint3 m_normal;                       // Current normal
+    xPoint2 m_texcoord;                     // Current texture coordinates
+
+    xValueArray<xPoint3> m_positions;       // Vertices before uploading
+    xValueArray<xPoint3> m_normals;         // Normals of vertices before uploading
+    xValueArray<xPoint2> m_texcoords;       // Texture coordinates of vertices before uploading
+
+    GLuint m_buffer;                        // Vertex buffer: positions, normals, texture coordinates
+    GLuint m_list;                          // Display list (if buffers are not supported)
+
+};
+
+
+#endif //OXYGEN_XSTATICGEOMETRY_H
@@ -8,7 +8,38 @@
 class xTexture : public xResource
 {
 public:
-    xTexture(char * name, char * path) : xResource(name, path)
+    // ----------------------------------------------------------------------
+    // Loads texture from file (if deferred is true, only saves name and
+    // path: data is loaded by Decode and Upload of async loader)
+    // ----------------------------------------------------------------------
+    xTexture(char * name, char * path, bool deferred = false) : xResource(name, path)
+    {
+        m_bitmap = NULL;
+        m_textureID = 0;
+        m_textureSize = 0;
+
+        if (!deferred) {
+            if (!Decode() || !Upload()) {
+                exit(1);
+            }
+        }
+    }
+
+    ~xTexture()
+    {
+        if (m_bitmap) {
+            FreeImage_Unload(m_bitmap);
+        }
+
+        if (m_textureID != 0) {
+            glDeleteTextures(1, &m_textureID);
+        }
+    }
+
+    // ----------------------------------------------------------------------
+    // Loads image from file in the RAM (can be done by worker thread)
+    // ----------------------------------------------------------------------
+    bool Decode()
     {
         char * imagepath = GetFilename();
         FIBITMAP * bitmap = NULL;
@@ -23,38 +54,68 @@ public:
             bitmap = FreeImage_Load(fif, imagepath);
         } else {
             printf("ERROR: Unknown formant for file %s \n", imagepath);
-            exit(1);
+            return false;
+        }
+        if (bitmap == NULL) {
+            printf("ERROR: Cannot load bitmap %s \n", imagepath);
+            return false;
         }
         if (FreeImage_GetBits(bitmap) == NULL) {
             printf("ERROR: Empty bitmap data container %s \n", imagepath);
-            exit(1);
+            FreeImage_Unload(bitmap);
+            return false;
         }
 
-        if (bitmap) {
-            int width = FreeImage_GetWidth(bitmap);
-            int height = FreeImage_GetHeight(bitmap);
-
-            glGenTextures(1, &m_textureID);
-            glBindTexture(GL_TEXTURE_2D, m_textureID);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, (void*)FreeImage_GetBits(bitmap));
-            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-            gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGB, width, height, GL_BGR, GL_UNSIGNED_BYTE, (void*)FreeImage_GetBits(bitmap));
-            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-            glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+        m_bitmap = bitmap;
+        return true;
+    }
 
-            FreeImage_Unload(bitmap);
-        } else {
-            printf("ERROR: Cannot load bitmap %s \n", imagepath);
-            exit(1);
+    // ----------------------------------------------------------------------
+    // Creates OpenGL texture from decoded image (only on main thread)
+    // ----------------------------------------------------------------------
+    bool Upload()
+    {
+        if (m_bitmap == NULL) {
+            return false;
         }
+
+        int width = FreeImage_GetWidth(m_bitmap);
+        int height = FreeImage_GetHeight(m_bitmap);
+
+        // RGB image and its mipmaps (about 1/3 of the image)
+        m_textureSize = (unsigned long)width * height * 3;
+        m_textureSize += m_textureSize / 3;
+
+        // Headless mode (there is no OpenGL context): image is only counted
+        if (Headless()) {
+            FreeImage_Unload(m_bitmap);
+            m_bitmap = NULL;
+            return true;
+        }
+
+        glGenTextures(1, &m_textureID);
+        glBindTexture(GL_TEXTURE_2D, m_textureID);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, (void*)FreeImage_GetBits(m_bitmap));
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGB, width, height, GL_BGR, GL_UNSIGNED_BYTE, (void*)FreeImage_GetBits(m_bitmap));
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+        glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+        FreeImage_Unload(m_bitmap);
+        m_bitmap = NULL;
+
+        return true;
     }
 
-    ~xTexture()
+    // ----------------------------------------------------------------------
+    // Returns size of texture data with mipmaps in video memory (in bytes)
+    // ----------------------------------------------------------------------
+    unsigned long GetByteSize()
     {
-        glDeleteTextures(1, &m_textureID);
+        return m_textureSize;
     }
 
     GLuint GetTextureID()
@@ -62,9 +123,30 @@ public:
         return m_textureID;
     }
 
+    // ----------------------------------------------------------------------
+    // Turns on (or off) headless mode of textures: Upload does not create
+    // OpenGL textures (there is no context), images are only counted.
+    // Render system sets it before loading of resources
+    // ----------------------------------------------------------------------
+    static void SetHeadless(bool headless)
+    {
+        Headless() = headless;
+    }
+
 private:
 
+    // ----------------------------------------------------------------------
+    // Returns headless mode flag of all the textures (off by default)
+    // ----------------------------------------------------------------------
+    static bool & Headless()
+    {
+        static bool headless = false;
+        return headless;
+    }
+
+    FIBITMAP * m_bitmap;            // Decoded image (before uploading)
     GLuint m_textureID;
+    unsigned long m_textureSize;    // Size of texture in video memory
 };
 
 #endif //OXYGEN_XTEXTURE_H
@@ -0,0 +1,361 @@
+/*
+ * Project: Oxygen Game Engine
+ * Created by Egor Orachyov on 18.02.2018.
+ * Copyright
+ *
+ * xValueArray releases interface of dynamic
+ * array, which stores elements by value in one
+ * contiguous memory block (unlike xDynamicArray,
+ * which stores pointers to the heap objects).
+ * It should be used for big amount of small
+ * elements (vertexes, faces, indices), which
+ * are walked linearly or passed to OpenGL
+ */
+
+#ifndef OXYGEN_XVALUEARRAY_H
+#define OXYGEN_XVALUEARRAY_H
+
+#include "xEngine.h"
+
+// ----------------------------------------------------------------------
+// Value Array Class
+// ----------------------------------------------------------------------
+
+template <class Type> class xValueArray
+{
+public:
+    // ----------------------------------------------------------------------
+    // Class constructor
+    // ----------------------------------------------------------------------
+    xValueArray()
+    {
+        m_size = 0;
+        m_numOfElements = 0;
+        m_array = NULL;
+        m_isAttached = false;
+    }
+
+    // ----------------------------------------------------------------------
+    // Creates array with reserved memory for size elements
+    // ----------------------------------------------------------------------
+    explicit xValueArray(long size)
+    {
+        m_size = 0;
+        m_numOfElements = 0;
+        m_array = NULL;
+        m_isAttached = false;
+        Reserve(size);
+    }
+
+    // ----------------------------------------------------------------------
+    // Move constructor (takes memory of the other array)
+    // ----------------------------------------------------------------------
+    xValueArray(xValueArray && other)
+    {
+        m_size = other.m_size;
+        m_numOfElements = other.m_numOfElements;
+        m_array = other.m_array;
+        m_isAttached = other.m_isAttached;
+
+        other.m_size = 0;
+        other.m_numOfElements = 0;
+        other.m_array = NULL;
+        other.m_isAttached = false;
+    }
+
+    // ----------------------------------------------------------------------
+    // Class destructor
+    // ----------------------------------------------------------------------
+    ~xValueArray()
+    {
+        EmptyMass();
+    }
+
+    // ----------------------------------------------------------------------
+    // Move assignment (deletes own data and takes memory of the other array)
+    // ----------------------------------------------------------------------
+    xValueArray & operator = (xValueArray && other)
+    {
+        if (this != &other) {
+            EmptyMass();
+            Swap(other);
+        }
+
+        return *this;
+    }
+
+    // ----------------------------------------------------------------------
+    // Allocates memory for size elements (if it is needed). Does not
+    // change the number of elements in the array
+    // ----------------------------------------------------------------------
+    void Reserve(long size)
+    {
+        if (size <= m_size) {
+            return;
+        }
+
+        Type * array = (Type *)malloc(sizeof(Type) * size);
+
+        if (array == NULL) {
+            printf("ERROR: cannot allocate memory for m_array \n");
+            exit(1);
+        }
+
+        // Move all the elements in new memory and destroy old ones
+        // (attached memory is not freed: array gets its own copy)
+        for(long i = 0; i < m_numOfElements; i += 1) {
+            new (&array[i]) Type(std::move(m_array[i]));
+            m_array[i].~Type();
+        }
+
+        if (!m_isAttached) {
+            free(m_array);
+        }
+
+        m_array = array;
+        m_size = size;
+        m_isAttached = false;
+    }
+
+    // ----------------------------------------------------------------------
+    // Uses external memory with numOfElements elements as the data of
+    // the array without copying (only for plain data types). Memory is
+    // not freed by the array and should exist while it is attached.
+    // Memory is copied first time when array grows
+    // ----------------------------------------------------------------------
+    void Attach(Type * data, long numOfElements)
+    {
+        EmptyMass();
+
+        m_array = data;
+        m_size = numOfElements;
+        m_numOfElements = numOfElements;
+        m_isAttached = (data != NULL);
+    }
+
+    // ----------------------------------------------------------------------
+    // Copies attached external memory in own memory of the array (after
+    // that external memory can be freed)
+    // ----------------------------------------------------------------------
+    void Detach()
+    {
+        if (m_isAttached) {
+            long size = m_size;
+            m_size = 0;
+            Reserve(size > 0 ? size : 1);
+        }
+    }
+
+    // ----------------------------------------------------------------------
+    // Returns true if array uses external memory
+    // ----------------------------------------------------------------------
+    bool IsAttached() const
+    {
+        return m_isAttached;
+    }
+
+    // ----------------------------------------------------------------------
+    // Adds copy of the element in the end of the array
+    // ----------------------------------------------------------------------
+    void Add(const Type & element)
+    {
+        // Element could be the part of this array, therefore it
+        // should be copied before possible reallocation
+        if (m_numOfElements == m_size) {
+            Type tmp(element);
+            Grow();
+            new (&m_array[m_numOfElements]) Type(std::move(tmp));
+        } else {
+            new (&m_array[m_numOfElements]) Type(element);
+        }
+
+        m_numOfElements += 1;
+    }
+
+    // ----------------------------------------------------------------------
+    // Moves the element in the end of the array
+    // ----------------------------------------------------------------------
+    void Add(Type && element)
+    {
+        if (m_numOfElements == m_size) {
+            Type tmp(std::move(element));
+            Grow();
+            new (&m_array[m_numOfElements]) Type(std::move(tmp));
+        } else {
+            new (&m_array[m_numOfElements]) Type(std::move(element));
+        }
+
+        m_numOfElements += 1;
+    }
+
+    // ----------------------------------------------------------------------
+    // Constructs the element in the end of the array from params and
+    // returns pointer to it
+    // ----------------------------------------------------------------------
+    template <class ... Args> Type * EmplaceBack(Args && ... args)
+    {
+        if (m_numOfElements == m_size) {
+            Grow();
+        }
+
+        Type * element = new (&m_array[m_numOfElements]) Type(std::forward<Args>(args)...);
+        m_numOfElements += 1;
+
+        return element;
+    }
+
+    // ----------------------------------------------------------------------
+    // Changes number of elements: new elements are value-initialized
+    // (zero for plain data types), extra elements are destroyed
+    // ----------------------------------------------------------------------
+    void Resize(long numOfElements)
+    {
+        Reserve(numOfElements);
+
+        for(long i = m_numOfElements; i < numOfElements; i += 1) {
+            new (&m_array[i]) Type();
+        }
+
+        for(long i = numOfElements; i < m_numOfElements; i += 1) {
+            m_array[i].~Type();
+        }
+
+        m_numOfElements = numOfElements;
+    }
+
+    // ----------------------------------------------------------------------
+    // Deletes the last element of the array (if it exists)
+    // ----------------------------------------------------------------------
+    void RemoveLast()
+    {
+        if (m_numOfElements > 0) {
+            m_numOfElements -= 1;
+            m_array[m_numOfElements].~Type();
+        }
+    }
+
+    // ----------------------------------------------------------------------
+    // Deletes all the elements, but keeps allocated memory for reusing
+    // ----------------------------------------------------------------------
+    void Clear()
+    {
+        for(long i = 0; i < m_numOfElements; i += 1) {
+            m_array[i].~Type();
+        }
+
+        m_numOfElements = 0;
+    }
+
+    // ----------------------------------------------------------------------
+    // Deletes all the elements and frees memory allocated for the array
+    // ----------------------------------------------------------------------
+    void EmptyMass()
+    {
+        Clear();
+
+        if (!m_isAttached) {
+            free(m_array);
+        }
+
+        m_size = 0;
+        m_array = NULL;
+        m_isAttached = false;
+    }
+
+    // ----------------------------------------------------------------------
+    // Exchanges the data of two arrays (without copying of elements)
+    // ----------------------------------------------------------------------
+    void Swap(xValueArray & other)
+    {
+        Type * array = m_array;
+        long size = m_size;
+        long numOfElements = m_numOfElements;
+        bool isAttached = m_isAttached;
+
+        m_array = other.m_array;
+        m_size = other.m_size;
+        m_numOfElements = other.m_numOfElements;
+        m_isAttached = other.m_isAttached;
+
+        other.m_array = array;
+        other.m_size = size;
+        other.m_numOfElements = numOfElements;
+        other.m_isAttached = isAttached;
+    }
+
+    // ----------------------------------------------------------------------
+    // Returns the element by its index (if it exists) or NULL
+    // ----------------------------------------------------------------------
+    Type * GetElement(long index)
+    {
+        if (index >= m_numOfElements || index < 0) {
+            return NULL;
+        } else {
+            return &m_array[index];
+        }
+    }
+
+    // ----------------------------------------------------------------------
+    // Returns the element by its index (without check of bounds)
+    // ----------------------------------------------------------------------
+    Type & operator [] (long index)
+    {
+        return m_array[index];
+    }
+
+    const Type & operator [] (long index) const
+    {
+        return m_array[index];
+    }
+
+    // ----------------------------------------------------------------------
+    // Returns the number of elements, for which memory is allocated
+    // ----------------------------------------------------------------------
+    long GetSize() const
+    {
+        return m_size;
+    }
+
+    // ----------------------------------------------------------------------
+    // Returns number of elements in the array (real size)
+    // ----------------------------------------------------------------------
+    long GetNumOfElements() const
+    {
+        return m_numOfElements;
+    }
+
+    // ----------------------------------------------------------------------
+    // Returns the pointer to the contiguous memory with elements
+    // ----------------------------------------------------------------------
+    Type * Data()
+    {
+        return m_array;
+    }
+
+    const Type * Data() const
+    {
+        return m_array;
+    }
+
+private:
+
+    // ----------------------------------------------------------------------
+    // Expands memory of the array in 2 times (or allocates it first time)
+    // ----------------------------------------------------------------------
+    void Grow()
+    {
+        Reserve(m_size > 0 ? m_size * 2 : 16);
+    }
+
+    // Array cannot be copied (only moved), because elements can be move-only
+    xValueArray(const xValueArray & other);
+    xValueArray & operator = (const xValueArray & other);
+
+    Type * m_array;             // Contiguous memory with elements
+    long m_size;                // Number of elements, for which memory is allocated
+    long m_numOfElements;       // Number of elements in the array
+    bool m_isAttached;          // Memory is external and is not freed by the array
+
+};
+
+#endif //OXYGEN_XVALUEARRAY_H
@@ -46,6 +46,14 @@ public:
         m_elapsed = 0.0;
         m_position = new xVector3;
         m_direction = new xVector3;
+
+        // Textures are loaded by Init
+        m_StreaksTexture = NULL;
+        m_GlowTexture = NULL;
+        m_BigGlowTexture = NULL;
+        m_HaloTexture = NULL;
+
+        UpdateMatrices(m_width, m_height);
     }
 
     // ----------------------------------------------------------------------
@@ -86,46 +94,76 @@ public:
     }
 
     // ----------------------------------------------------------------------
-    // Only for Rendering System
+    // Only for Rendering System: sets viewport and loads matrices of
+    // the camera (they are counted on CPU, GL state is not read)
     // ----------------------------------------------------------------------
     virtual void SetPerspective(GLint * width, GLint * height)
     {
-        m_width = *width;
-        m_height = *height;
+        UpdateMatrices(*width, *height);
 
-        // Set viewport properties
-        glViewport(0, 0, *width, *height);
-        m_aspect = (GLdouble)(*width) / (*height);
+        glViewport(0, 0, m_width, m_height);
 
-        // Set projection matrix
         glMatrixMode(GL_PROJECTION);
-        glLoadIdentity();
-        gluPerspective(m_angle, m_aspect, m_front, m_back);
+        glLoadMatrixd(m_projection);
         glMatrixMode(GL_MODELVIEW);
-        glLoadIdentity();
-
-        // Count direction vector by yaw and pitch rotations
-        GLfloat Matrix[16];
-
-        glRotatef(m_yaw, 0.0, 1.0, 0.0);
-        glRotatef(m_pitch, 1.0, 0.0, 0.0);
-
-        glGetFloatv(GL_MODELVIEW_MATRIX, Matrix);
-
-        m_direction->x = Matrix[8];
-        m_direction->z = -Matrix[10];
-
-        glLoadIdentity();
-
-        glRotatef(m_pitch, 1.0, 0.0, 0.0);
+        glLoadMatrixd(m_model);
+    }
 
-        glGetFloatv(GL_MODELVIEW_MATRIX, Matrix);
-        m_direction->y = Matrix[9];
+    // ----------------------------------------------------------------------
+    // Counts viewport, projection (as gluPerspective) and view matrices,
+    // direction and frustum planes by the size of viewport, angles,
+    // position, angle of view, front and back planes. Does not use GL
+    // (can be called by any thread)
+    // ----------------------------------------------------------------------
+    virtual void UpdateMatrices(int width, int height)
+    {
+        m_width = width;
+        m_height = (height > 0 ? height : 1);
+        m_aspect = (GLdouble)m_width / m_height;
+
+        m_viewport[0] = 0;
+        m_viewport[1] = 0;
+        m_viewport[2] = m_width;
+        m_viewport[3] = m_height;
+
+        // Column-major matrices as in GL
+        GLdouble f = 1.0 / tan(m_angle * 3.14159265358979 / 360.0);
+        for(int i = 0; i < 16; i++) {
+            m_projection[i] = 0.0;
+        }
+        m_projection[0] = f / m_aspect;
+        m_projection[5] = f;
+        m_projection[10] = (m_back + m_front) / (m_front - m_back);
+        m_projection[11] = -1.0;
+        m_projection[14] = 2.0 * m_back * m_front / (m_front - m_back);
+
+        // View is pitch rotation, yaw rotation and inverse translation
+        GLdouble yaw = m_yaw * 3.14159265358979 / 180.0;
+        GLdouble pitch = m_pitch * 3.14159265358979 / 180.0;
+        GLdouble cy = cos(yaw), sy = sin(yaw);
+        GLdouble cp = cos(pitch), sp = sin(pitch);
+        GLdouble rotation[3][3] = {
+            {cy, 0.0, sy},
+            {sp * sy, cp, -sp * cy},
+            {-cp * sy, sp, cp * cy}
+        };
+
+        for(int row = 0; row < 3; row++) {
+            for(int column = 0; column < 3; column++) {
+                m_model[column * 4 + row] = rotation[row][column];
+            }
+            m_model[12 + row] = -(rotation[row][0] * m_position->x + rotation[row][1] * m_position->y +
+                                  rotation[row][2] * m_position->z);
+            m_model[row * 4 + 3] = 0.0;
+        }
+        m_model[15] = 1.0;
 
-        glRotatef(m_yaw, 0.0, 1.0, 0.0);
+        // Camera looks along -z of the view
+        m_direction->x = (float)(-rotation[2][0]);
+        m_direction->y = (float)(-rotation[2][1]);
+        m_direction->z = (float)(-rotation[2][2]);
 
-        // Translate our camera to new position (remember to do it inverse)
-        glTranslatef(-m_position->x, -m_position->y, -m_position->z);
+        UpdateFrustumPyramid();
     }
 
     // ----------------------------------------------------------------------
@@ -250,103 +288,77 @@ public:
     }
 
     // ----------------------------------------------------------------------
-    // Calculates current frustum pyramid (6 planes) and
-    // updates view port, model view and projection matrices
+    // Returns distance to the point divided by distance to the back
+    // plane (0 - camera, 1 - back plane and further)
+    // ----------------------------------------------------------------------
+    virtual float GetDepth(xVector3 * point)
+    {
+        float dx = point->x - m_position->x;
+        float dy = point->y - m_position->y;
+        float dz = point->z - m_position->z;
+        float depth = sqrtf(dx * dx + dy * dy + dz * dz) / (float)m_back;
+
+        return (depth < 1.0f ? depth : 1.0f);
+    }
+
+    // ----------------------------------------------------------------------
+    // Calculates current frustum pyramid (6 planes) by the projection
+    // and view matrices of the camera (called by UpdateMatrices)
     // ----------------------------------------------------------------------
     virtual void UpdateFrustumPyramid()
     {
         GLdouble clip[16];
-        GLfloat t;
-
-        glGetIntegerv(GL_VIEWPORT, m_viewport);
-        glGetDoublev(GL_PROJECTION_MATRIX, m_projection);
-        glGetDoublev(GL_MODELVIEW_MATRIX, m_model);
-
-        clip[ 0] = m_model[ 0] * m_projection[ 0] + m_model[ 1] * m_projection[ 4] + m_model[ 2] * m_projection[ 8] + m_model[ 3] * m_projection[12];
-        clip[ 1] = m_model[ 0] * m_projection[ 1] + m_model[ 1] * m_projection[ 5] + m_model[ 2] * m_projection[ 9] + m_model[ 3] * m_projection[13];
-        clip[ 2] = m_model[ 0] * m_projection[ 2] + m_model[ 1] * m_projection[ 6] + m_model[ 2] * m_projection[10] + m_model[ 3] * m_projection[14];
-        clip[ 3] = m_model[ 0] * m_projection[ 3] + m_model[ 1] * m_projection[ 7] + m_model[ 2] * m_projection[11] + m_model[ 3] * m_projection[15];
-
-        clip[ 4] = m_model[ 4] * m_projection[ 0] + m_model[ 5] * m_projection[ 4] + m_model[ 6] * m_projection[ 8] + m_model[ 7] * m_projection[12];
-        clip[ 5] = m_model[ 4] * m_projection[ 1] + m_model[ 5] * m_projection[ 5] + m_model[ 6] * m_projection[ 9] + m_model[ 7] * m_projection[13];
-        clip[ 6] = m_model[ 4] * m_projection[ 2] + m_model[ 5] * m_projection[ 6] + m_model[ 6] * m_projection[10] + m_model[ 7] * m_projection[14];
-        clip[ 7] = m_model[ 4] * m_projection[ 3] + m_model[ 5] * m_projection[ 7] + m_model[ 6] * m_projection[11] + m_model[ 7] * m_projection[15];
-
-        clip[ 8] = m_model[ 8] * m_projection[ 0] + m_model[ 9] * m_projection[ 4] + m_model[10] * m_projection[ 8] + m_model[11] * m_projection[12];
-        clip[ 9] = m_model[ 8] * m_projection[ 1] + m_model[ 9] * m_projection[ 5] + m_model[10] * m_projection[ 9] + m_model[11] * m_projection[13];
-        clip[10] = m_model[ 8] * m_projection[ 2] + m_model[ 9] * m_projection[ 6] + m_model[10] * m_projection[10] + m_model[11] * m_projection[14];
-        clip[11] = m_model[ 8] * m_projection[ 3] + m_model[ 9] * m_projection[ 7] + m_model[10] * m_projection[11] + m_model[11] * m_projection[15];
-
-        clip[12] = m_model[12] * m_projection[ 0] + m_model[13] * m_projection[ 4] + m_model[14] * m_projection[ 8] + m_model[15] * m_projection[12];
-        clip[13] = m_model[12] * m_projection[ 1] + m_model[13] * m_projection[ 5] + m_model[14] * m_projection[ 9] + m_model[15] * m_projection[13];
-        clip[14] = m_model[12] * m_projection[ 2] + m_model[13] * m_projection[ 6] + m_model[14] * m_projection[10] + m_model[15] * m_projection[14];
-        clip[15] = m_model[12] * m_projection[ 3] + m_model[13] * m_projection[ 7] + m_model[14] * m_projection[11] + m_model[15] * m_projection[15];
-
-        m_Frustum[0][0] = clip[ 3] - clip[ 0];
-        m_Frustum[0][1] = clip[ 7] - clip[ 4];
-        m_Frustum[0][2] = clip[11] - clip[ 8];
-        m_Frustum[0][3] = clip[15] - clip[12];
-
-        t = GLfloat(sqrt( m_Frustum[0][0] * m_Frustum[0][0] + m_Frustum[0][1] * m_Frustum[0][1] + m_Frustum[0][2] * m_Frustum[0][2] ));
-        m_Frustum[0][0] /= t;
-        m_Frustum[0][1] /= t;
-        m_Frustum[0][2] /= t;
-        m_Frustum[0][3] /= t;
-
-        m_Frustum[1][0] = clip[ 3] + clip[ 0];
-        m_Frustum[1][1] = clip[ 7] + clip[ 4];
-        m_Frustum[1][2] = clip[11] + clip[ 8];
-        m_Frustum[1][3] = clip[15] + clip[12];
-
-        t = GLfloat(sqrt( m_Frustum[1][0] * m_Frustum[1][0] + m_Frustum[1][1] * m_Frustum[1][1] + m_Frustum[1][2] * m_Frustum[1][2] ));
-        m_Frustum[1][0] /= t;
-        m_Frustum[1][1] /= t;
-        m_Frustum[1][2] /= t;
-        m_Frustum[1][3] /= t;
-
-        m_Frustum[2][0] = clip[ 3] + clip[ 1];
-        m_Frustum[2][1] = clip[ 7] + clip[ 5];
-        m_Frustum[2][2] = clip[11] + clip[ 9];
-        m_Frustum[2][3] = clip[15] + clip[13];
-
-        t = GLfloat(sqrt( m_Frustum[2][0] * m_Frustum[2][0] + m_Frustum[2][1] * m_Frustum[2][1] + m_Frustum[2][2] * m_Frustum[2][2] ));
-        m_Frustum[2][0] /= t;
-        m_Frustum[2][1] /= t;
-        m_Frustum[2][2] /= t;
-        m_Frustum[2][3] /= t;
-
-        m_Frustum[3][0] = clip[ 3] - clip[ 1];
-        m_Frustum[3][1] = clip[ 7] - clip[ 5];
-        m_Frustum[3][2] = clip[11] - clip[ 9];
-        m_Frustum[3][3] = clip[15] - clip[13];
-
-        t = GLfloat(sqrt( m_Frustum[3][0] * m_Frustum[3][0] + m_Frustum[3][1] * m_Frustum[3][1] + m_Frustum[3][2] * m_Frustum[3][2] ));
-        m_Frustum[3][0] /= t;
-        m_Frustum[3][1] /= t;
-        m_Frustum[3][2] /= t;
-        m_Frustum[3][3] /= t;
-
-        m_Frustum[4][0] = clip[ 3] - clip[ 2];
-        m_Frustum[4][1] = clip[ 7] - clip[ 6];
-        m_Frustum[4][2] = clip[11] - clip[10];
-        m_Frustum[4][3] = clip[15] - clip[14];
-
-        t = GLfloat(sqrt( m_Frustum[4][0] * m_Frustum[4][0] + m_Frustum[4][1] * m_Frustum[4][1] + m_Frustum[4][2] * m_Frustum[4][2] ));
-        m_Frustum[4][0] /= t;
-        m_Frustum[4][1] /= t;
-        m_Frustum[4][2] /= t;
-        m_Frustum[4][3] /= t;
-
-        m_Frustum[5][0] = clip[ 3] + clip[ 2];
-        m_Frustum[5][1] = clip[ 7] + clip[ 6];
-        m_Frustum[5][2] = clip[11] + clip[10];
-        m_Frustum[5][3] = clip[15] + clip[14];
-
-        t = GLfloat(sqrt( m_Frustum[5][0] * m_Frustum[5][0] + m_Frustum[5][1] * m_Frustum[5][1] + m_Frustum[5][2] * m_Frustum[5][2] ));
-        m_Frustum[5][0] /= t;
-        m_Frustum[5][1] /= t;
-        m_Frustum[5][2] /= t;
-        m_Frustum[5][3] /= t;
+
+        // Clip matrix is projection * view
+        for(int column = 0; column < 4; column++) {
+            for(int row = 0; row < 4; row++) {
+                clip[column * 4 + row] = m_model[column * 4 + 0] * m_projection[row] +
+                                         m_model[column * 4 + 1] * m_projection[4 + row] +
+                                         m_model[column * 4 + 2] * m_projection[8 + row] +
+                                         m_model[column * 4 + 3] * m_projection[12 + row];
+            }
+        }
+
+        // Right, left, bottom, top, back and front planes are the sum
+        // (or difference) of the last row and the row of the axis
+        static const int rows[6] = {0, 0, 1, 1, 2, 2};
+        static const GLdouble signs[6] = {-1.0, 1.0, 1.0, -1.0, -1.0, 1.0};
+
+        for(int i = 0; i < 6; i++) {
+            for(int j = 0; j < 4; j++) {
+                m_Frustum[i][j] = clip[j * 4 + 3] + signs[i] * clip[j * 4 + rows[i]];
+            }
+
+            GLdouble length = sqrt(m_Frustum[i][0] * m_Frustum[i][0] + m_Frustum[i][1] * m_Frustum[i][1] +
+                                   m_Frustum[i][2] * m_Frustum[i][2]);
+            for(int j = 0; j < 4; j++) {
+                m_Frustum[i][j] /= length;
+            }
+        }
+    }
+
+    // ----------------------------------------------------------------------
+    // Copies current frustum planes (a, b, c, d with normals to the
+    // inside) for batch culling
+    // ----------------------------------------------------------------------
+    virtual void GetFrustumPlanes(float planes[6][4])
+    {
+        for(int i = 0; i < 6; i++) {
+            for(int j = 0; j < 4; j++) {
+                planes[i][j] = (float)m_Frustum[i][j];
+            }
+        }
+    }
+
+    // ----------------------------------------------------------------------
+    // Copies view matrix of the camera (column-major, as for glLoadMatrixf)
+    // counted by the last UpdateMatrices
+    // ----------------------------------------------------------------------
+    virtual void GetViewMatrix(float view[16])
+    {
+        for(int i = 0; i < 16; i++) {
+            view[i] = (float)m_model[i];
+        }
     }
 
     // ----------------------------------------------------------------------
@@ -442,6 +454,26 @@ public:
         return true;
     }
 
+    // ----------------------------------------------------------------------
+    // Returns size (in pixels of viewport height) of the segment with
+    // length size, which is placed at the point and faces the camera
+    // ----------------------------------------------------------------------
+    virtual float GetProjectedSize(xVector3 * point, float size)
+    {
+        float dx = point->x - m_position->x;
+        float dy = point->y - m_position->y;
+        float dz = point->z - m_position->z;
+        float distance = sqrtf(dx * dx + dy * dy + dz * dz);
+
+        // Segment is as big as the whole viewport near front plane
+        if (distance <= m_front) {
+            distance = (float)m_front;
+        }
+
+        float halfHeight = distance * (float)tan(m_angle * 3.14159265358979 / 360.0);
+        return size / halfHeight * m_height * 0.5f;
+    }
+
     // ----------------------------------------------------------------------
     // Renders glare effect for light (with check of occlusion and frustum)
     // ----------------------------------------------------------------------